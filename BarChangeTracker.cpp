@@ -0,0 +1,34 @@
+#include "BarChangeTracker.h"
+
+#include <bit>
+
+
+uint8_t BarChangeTracker::changesAt(SCStudyInterfaceRef sc, const int barIndex, StudyArrayBindings& upstream) const {
+    if (barIndex != settledBar || upstream.getCount() != upstreamCount) {return BAR_ALL;}
+    uint8_t changes = BAR_UNCHANGED;
+    if (sc.Volume[barIndex] != settledVolume) {
+        changes |= BAR_TRADED;
+    }
+    // Compared bit for bit so a NaN that stays a NaN is not a change
+    for (int slot = 0; slot < upstreamCount; ++slot) {
+        if (std::bit_cast<uint32_t>(upstream[slot][barIndex]) != upstreamBits[slot]) {
+            changes |= BAR_UPSTREAM;
+            break;
+        }
+    }
+    return changes;
+}
+
+void BarChangeTracker::settle(SCStudyInterfaceRef sc, const int barIndex, StudyArrayBindings& upstream) {
+    settledBar = barIndex;
+    settledVolume = sc.Volume[barIndex];
+    upstreamCount = upstream.getCount();
+    for (int slot = 0; slot < upstreamCount; ++slot) {
+        upstreamBits[slot] = std::bit_cast<uint32_t>(upstream[slot][barIndex]);
+    }
+}
+
+void BarChangeTracker::reset() {
+    settledBar = -1;
+    upstreamCount = 0;
+}
@@ -0,0 +1,41 @@
+#ifndef BARCHANGETRACKER_H
+#define BARCHANGETRACKER_H
+
+#include "StudyArrayBindings.h"
+#include "sierrachart.h"
+
+#include <array>
+#include <cstdint>
+
+enum BarChange : uint8_t {
+    BAR_UNCHANGED = 0,
+    BAR_NEW = 1,       // First update of the bar since the last settled one
+    BAR_TRADED = 2,    // The bar's volume moved, and with it its OHLC and VAP ladder
+    BAR_UPSTREAM = 4,  // A bound upstream study array holds another value at the bar
+    BAR_ALL = BAR_NEW | BAR_TRADED | BAR_UPSTREAM,
+};
+
+/*
+ * What changed on the bar a study keeps updating, the last bar while it fills. The study settles the bar once its
+ * outputs are written, the next update of that bar compares its volume and upstream values with what was settled and
+ * can leave the outputs those did not feed as they are. Any other bar is reported as entirely changed.
+ */
+class BarChangeTracker {
+
+public:
+    // Changes at barIndex since it was settled, BAR_ALL for a bar that is not the settled one
+    [[nodiscard]] uint8_t changesAt(SCStudyInterfaceRef sc, int barIndex, StudyArrayBindings& upstream) const;
+
+    // Records barIndex as the study leaves it
+    void settle(SCStudyInterfaceRef sc, int barIndex, StudyArrayBindings& upstream);
+
+    void reset();
+
+private:
+    int settledBar = -1;
+    float settledVolume = 0.0f;
+    int upstreamCount = 0;
+    std::array<uint32_t, StudyArrayBindings::MAX_BINDINGS> upstreamBits{};
+};
+
+#endif //BARCHANGETRACKER_H
@@ -0,0 +1,61 @@
+#include "CleanRangeTracker.h"
+
+
+CleanRangeTracker::CleanRangeTracker(const int minVolume) : minVolume(minVolume) {}
+
+bool CleanRangeTracker::isClean(const s_VolumeAtPriceV2& level) const {
+    const auto threshold = static_cast<unsigned int>(minVolume);
+    return level.BidVolume > threshold && level.AskVolume > threshold;
+}
+
+void CleanRangeTracker::refresh(SCStudyInterfaceRef sc, const int barIndex) {
+    if (barIndex < 0 || barIndex >= sc.ArraySize) {return;}
+    if (static_cast<int>(bars.size()) <= barIndex) {
+        bars.resize(barIndex + 1);
+    }
+    BarRange& range = bars[barIndex];
+    if (range.finalized) {return;}
+
+    if (const float volume = sc.Volume[barIndex]; volume != range.seenVolume) {
+        const int vapCount = static_cast<int>(sc.VolumeAtPriceForBars->GetSizeAtBarIndex(barIndex));
+        const s_VolumeAtPriceV2* pVAP = nullptr;
+
+        // Ladder is sorted by price: walk up to the clean low, then down to the clean high
+        int bottom = 0;
+        for (; bottom < vapCount; ++bottom) {
+            if (!sc.VolumeAtPriceForBars->GetVAPElementAtIndex(barIndex, bottom, &pVAP)) {continue;}
+            if (range.hasClean && pVAP->PriceInTicks >= range.lowTicks) {break;}
+            if (isClean(*pVAP)) {
+                range.lowTicks = pVAP->PriceInTicks;
+                if (!range.hasClean) {range.highTicks = pVAP->PriceInTicks;}
+                range.hasClean = true;
+                break;
+            }
+        }
+        // Nothing clean at all when the bottom walk ran off the top
+        for (int top = vapCount - 1; range.hasClean && top > bottom; --top) {
+            if (!sc.VolumeAtPriceForBars->GetVAPElementAtIndex(barIndex, top, &pVAP)) {continue;}
+            if (pVAP->PriceInTicks <= range.highTicks) {break;}
+            if (isClean(*pVAP)) {
+                range.highTicks = pVAP->PriceInTicks;
+                break;
+            }
+        }
+        range.seenVolume = volume;
+    }
+    // Only the last bar can still receive volume
+    range.finalized = barIndex < sc.ArraySize - 1;
+}
+
+void CleanRangeTracker::reset() {
+    bars.clear();
+}
+
+int CleanRangeTracker::getMinVolume() const {return minVolume;}
+
+bool CleanRangeTracker::getCleanRange(const int barIndex, int& lowTicks, int& highTicks) const {
+    if (barIndex < 0 || barIndex >= static_cast<int>(bars.size()) || !bars[barIndex].hasClean) {return false;}
+    lowTicks = bars[barIndex].lowTicks;
+    highTicks = bars[barIndex].highTicks;
+    return true;
+}
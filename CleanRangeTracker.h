@@ -0,0 +1,44 @@
+#ifndef CLEANRANGETRACKER_H
+#define CLEANRANGETRACKER_H
+
+#include "sierrachart.h"
+
+#include <vector>
+
+/*
+ * Lowest and highest clean price level (BidVolume and AskVolume both above minVolume) of each bar.
+ * A level never turns unclean again while the bar fills, so only the levels outside the current clean range can move
+ * it: a refresh walks the ladder inwards from both ends and stops at the first clean level or at the known range.
+ * Finished bars are frozen after their last refresh and never read from the VAP container again.
+ */
+class CleanRangeTracker {
+
+public:
+    explicit CleanRangeTracker(int minVolume = 0);
+
+    // Folds the levels of barIndex that can still move its clean range, a no-op when the bar's volume did not move
+    void refresh(SCStudyInterfaceRef sc, int barIndex);
+
+    void reset();
+
+    // Getters
+    [[nodiscard]] int getMinVolume() const;
+    // false when the bar has no clean level (yet)
+    [[nodiscard]] bool getCleanRange(int barIndex, int& lowTicks, int& highTicks) const;
+
+private:
+    struct BarRange {
+        int lowTicks = 0;
+        int highTicks = 0;
+        float seenVolume = -1;
+        bool hasClean = false;
+        bool finalized = false;
+    };
+
+    [[nodiscard]] bool isClean(const s_VolumeAtPriceV2& level) const;
+
+    const int minVolume;
+    std::vector<BarRange> bars;
+};
+
+#endif //CLEANRANGETRACKER_H
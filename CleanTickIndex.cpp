@@ -0,0 +1,87 @@
+#include "CleanTickIndex.h"
+
+#include <algorithm>
+
+
+CleanTickIndex::CleanTickIndex(const int minVolume) : minVolume(minVolume) {}
+
+void CleanTickIndex::refresh(SCStudyInterfaceRef sc, const int barIndex) {
+    // The bar in progress is answered from its ladder, a bar is indexed once it can no longer trade
+    if (barIndex < 0 || barIndex >= sc.ArraySize - 1) {return;}
+    if (static_cast<int>(bars.size()) <= barIndex) {
+        bars.resize(barIndex + 1);
+    }
+    BarBits& bits = bars[barIndex];
+    if (bits.finalized) {return;}
+
+    const auto threshold = static_cast<unsigned int>(minVolume);
+    const int vapCount = static_cast<int>(sc.VolumeAtPriceForBars->GetSizeAtBarIndex(barIndex));
+    const s_VolumeAtPriceV2* pVAP = nullptr;
+    for (int i = 0; i < vapCount; ++i) {
+        if (sc.VolumeAtPriceForBars->GetVAPElementAtIndex(barIndex, i, &pVAP)
+            && pVAP->BidVolume > threshold && pVAP->AskVolume > threshold) {
+            setBit(bits, pVAP->PriceInTicks);
+        }
+    }
+    bits.finalized = true;
+}
+
+void CleanTickIndex::reset() {
+    bars.clear();
+    pool.clear();
+}
+
+void CleanTickIndex::growTo(BarBits& bits, const int baseTicks, const uint32_t wordCount) {
+    const int shift = bits.wordCount == 0 ? 0 : bits.baseTicks - baseTicks;  // In ticks, multiple of 64
+    const bool atEnd = bits.firstWord + bits.wordCount == pool.size();
+    if (atEnd && shift == 0) {
+        pool.resize(bits.firstWord + wordCount, 0);
+    } else {
+        const auto first = static_cast<uint32_t>(pool.size());
+        pool.resize(first + wordCount, 0);
+        for (uint32_t w = 0; w < bits.wordCount; ++w) {
+            pool[first + w + shift / 64] = pool[bits.firstWord + w];
+        }
+        if (atEnd) {
+            // Slide back over the old slot so the live bar does not leak pool space on every rebase
+            std::copy(pool.begin() + first, pool.end(), pool.begin() + bits.firstWord);
+            pool.resize(bits.firstWord + wordCount);
+        } else {
+            bits.firstWord = first;
+        }
+    }
+    bits.baseTicks = baseTicks;
+    bits.wordCount = wordCount;
+}
+
+void CleanTickIndex::setBit(BarBits& bits, const int priceInTicks) {
+    if (bits.wordCount == 0) {
+        bits.firstWord = static_cast<uint32_t>(pool.size());
+        growTo(bits, priceInTicks - 32, 1);  // Headroom for the bar extending either way
+    } else if (priceInTicks < bits.baseTicks) {
+        // Keep the base word aligned to the previous one so words move, bits do not
+        const int words = (bits.baseTicks - priceInTicks + 63) / 64;
+        growTo(bits, bits.baseTicks - 64 * words, bits.wordCount + words);
+    }
+    const int offset = priceInTicks - bits.baseTicks;
+    if (const auto word = static_cast<uint32_t>(offset >> 6); word >= bits.wordCount) {
+        growTo(bits, bits.baseTicks, word + 1);
+    }
+    pool[bits.firstWord + (offset >> 6)] |= uint64_t{1} << (offset & 63);
+}
+
+int CleanTickIndex::getMinVolume() const {return minVolume;}
+
+bool CleanTickIndex::isClean(SCStudyInterfaceRef sc, const int barIndex, const int priceInTicks) const {
+    if (barIndex < 0 || barIndex >= sc.ArraySize) {return false;}
+    if (barIndex >= static_cast<int>(bars.size()) || !bars[barIndex].finalized) {
+        // One lookup in the ladder of a bar that is still filling
+        const s_VolumeAtPriceV2& level = sc.VolumeAtPriceForBars->GetVAPElementAtPrice(barIndex, priceInTicks);
+        const auto threshold = static_cast<unsigned int>(minVolume);
+        return level.BidVolume > threshold && level.AskVolume > threshold;
+    }
+    const BarBits& bits = bars[barIndex];
+    const int offset = priceInTicks - bits.baseTicks;
+    if (offset < 0 || (offset >> 6) >= static_cast<int>(bits.wordCount)) {return false;}
+    return (pool[bits.firstWord + (offset >> 6)] >> (offset & 63) & 1) != 0;
+}
@@ -0,0 +1,46 @@
+#ifndef CLEANTICKINDEX_H
+#define CLEANTICKINDEX_H
+
+#include "sierrachart.h"
+
+#include <cstdint>
+#include <vector>
+
+/*
+ * Per bar bitset of the clean price levels (BidVolume and AskVolume both above minVolume), one bit per tick from
+ * the lowest level of the bar.
+ * A bar is indexed with one pass over its ladder once it closed and never read from the VAP container again. The bar
+ * still filling is not indexed: each question about it is one lookup in its ladder, not a walk over every level.
+ */
+class CleanTickIndex {
+
+public:
+    explicit CleanTickIndex(int minVolume = 0);
+
+    // Indexes barIndex if it closed and is not indexed yet, a no-op for the bar in progress
+    void refresh(SCStudyInterfaceRef sc, int barIndex);
+
+    void reset();
+
+    // Getters
+    [[nodiscard]] int getMinVolume() const;
+    [[nodiscard]] bool isClean(SCStudyInterfaceRef sc, int barIndex, int priceInTicks) const;
+
+private:
+    // Words of every bar live back to back in one pool, a bar that needs to grow is moved to the end
+    struct BarBits {
+        int baseTicks = 0;
+        uint32_t firstWord = 0;
+        uint32_t wordCount = 0;
+        bool finalized = false;
+    };
+
+    void setBit(BarBits& bits, int priceInTicks);
+    void growTo(BarBits& bits, int baseTicks, uint32_t wordCount);
+
+    const int minVolume;
+    std::vector<BarBits> bars;
+    std::vector<uint64_t> pool;
+};
+
+#endif //CLEANTICKINDEX_H
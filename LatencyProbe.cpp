@@ -0,0 +1,135 @@
+#include "LatencyProbe.h"
+
+#ifdef DIVERGENCE_ENABLE_PROFILING
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+constexpr auto DUMP_INTERVAL = std::chrono::seconds(10);
+constexpr uint64_t EXITS_BETWEEN_CLOCK_CHECKS = 4096;
+
+struct LatencyRegistry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<LatencySite>> sites;
+    std::string outputPath = "divergence_latency.txt";
+    uint64_t scopeExits = 0;
+    // Ticks are converted to nanoseconds against steady_clock over the dump interval
+    uint64_t intervalStartTicks = latencyNow();
+    std::chrono::steady_clock::time_point intervalStart = std::chrono::steady_clock::now();
+
+    ~LatencyRegistry() {flush();}
+
+    void flush();
+};
+
+LatencyRegistry& registry() {
+    static LatencyRegistry instance;
+    return instance;
+}
+
+void LatencyRegistry::flush() {
+    const std::lock_guard lock(mutex);
+    const uint64_t ticks = latencyNow();
+    const auto now = std::chrono::steady_clock::now();
+    const double elapsedNs = std::chrono::duration<double, std::nano>(now - intervalStart).count();
+    const double nsPerTick = ticks > intervalStartTicks ? elapsedNs / static_cast<double>(ticks - intervalStartTicks) : 1.0;
+
+    bool anySamples = false;
+    for (const auto& site : sites) {
+        anySamples = anySamples || site->ticks.getCount() > 0;
+    }
+    if (std::FILE* file = anySamples ? std::fopen(outputPath.c_str(), "a") : nullptr; file != nullptr) {
+        const std::time_t wall = std::time(nullptr);
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", std::localtime(&wall));
+        std::fprintf(file, "# %s interval_s=%.1f ns_per_tick=%.4f\n", stamp, elapsedNs / 1e9, nsPerTick);
+        std::fprintf(file, "%-60s %10s %10s %10s %10s %10s\n", "site", "count", "p50_ns", "p99_ns", "p99.9_ns", "max_ns");
+        for (const auto& site : sites) {
+            const LatencyHistogram& h = site->ticks;
+            if (h.getCount() == 0) {continue;}
+            const auto ns = [nsPerTick](const uint64_t value) {return static_cast<double>(value) * nsPerTick;};
+            std::fprintf(file, "%-60s %10llu %10.0f %10.0f %10.0f %10.0f\n", site->name.c_str(),
+                         static_cast<unsigned long long>(h.getCount()), ns(h.valueAtQuantile(0.50)),
+                         ns(h.valueAtQuantile(0.99)), ns(h.valueAtQuantile(0.999)), ns(h.getMax()));
+        }
+        std::fclose(file);
+    }
+    for (const auto& site : sites) {
+        site->ticks.reset();
+    }
+    intervalStartTicks = ticks;
+    intervalStart = now;
+}
+
+}
+
+LatencyHistogram::LatencyHistogram() : counts(BUCKET_COUNT, 0) {}
+
+uint64_t LatencyHistogram::highestValueAt(const int index) {
+    if (index < (2 << SUB_BUCKET_BITS)) {return static_cast<uint64_t>(index);}
+    const int shift = (index >> SUB_BUCKET_BITS) - 1;
+    const uint64_t subBucket = static_cast<uint64_t>(index) - (static_cast<uint64_t>(shift) << SUB_BUCKET_BITS);
+    return ((subBucket + 1) << shift) - 1;
+}
+
+uint64_t LatencyHistogram::valueAtQuantile(const double quantile) const {
+    if (count == 0) {return 0;}
+    const auto target = static_cast<uint64_t>(std::ceil(quantile * static_cast<double>(count)));
+    uint64_t seen = 0;
+    for (int index = 0; index < BUCKET_COUNT; ++index) {
+        seen += counts[index];
+        if (seen >= target && seen > 0) {
+            return std::min(highestValueAt(index), maxValue);
+        }
+    }
+    return maxValue;
+}
+
+void LatencyHistogram::reset() {
+    std::fill(counts.begin(), counts.end(), 0);
+    count = 0;
+    maxValue = 0;
+}
+
+uint64_t LatencyHistogram::getCount() const {return count;}
+
+uint64_t LatencyHistogram::getMax() const {return maxValue;}
+
+LatencySite* latencySite(const char* name) {
+    LatencyRegistry& r = registry();
+    const std::lock_guard lock(r.mutex);
+    for (const auto& site : r.sites) {
+        if (site->name == name) {return site.get();}
+    }
+    r.sites.push_back(std::make_unique<LatencySite>());
+    r.sites.back()->name = name;
+    return r.sites.back().get();
+}
+
+void setLatencyOutputFolder(const char* folder) {
+    LatencyRegistry& r = registry();
+    const std::lock_guard lock(r.mutex);
+    r.outputPath = (std::filesystem::path(folder) / "divergence_latency.txt").string();
+}
+
+void flushLatencyProbes() {
+    registry().flush();
+}
+
+void latencyScopeExited() {
+    LatencyRegistry& r = registry();
+    if (++r.scopeExits % EXITS_BETWEEN_CLOCK_CHECKS != 0) {return;}
+    if (std::chrono::steady_clock::now() - r.intervalStart >= DUMP_INTERVAL) {
+        r.flush();
+    }
+}
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef LATENCYPROBE_H
+#define LATENCYPROBE_H
+
+/*
+ * Opt-in latency instrumentation. Built with DIVERGENCE_ENABLE_PROFILING, every probe times its scope into the
+ * histogram of its site. The summaries (count, p50, p99, p99.9, max) of the samples since the previous dump are appended
+ * to divergence_latency.txt in the data files folder every 10 s of activity, when a study is removed and at exit.
+ * Without it the macros expand to nothing.
+ *
+ *   LATENCY_PROBE_STUDY(sc)  times the rest of an exported study, full recalculations under their own site
+ *   LATENCY_PROBE("name")    times the rest of the enclosing scope
+ *   LATENCY_PROBE_FLUSH()    writes the summaries now
+ *
+ * Recording is meant for the chart thread, the probes take no locks.
+ */
+
+#ifdef DIVERGENCE_ENABLE_PROFILING
+
+#include <bit>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#include <chrono>
+#endif
+
+// Log-linear histogram: exact below 128, then 64 sub-buckets per power of two (about 1.6% resolution)
+class LatencyHistogram {
+
+public:
+    static constexpr int SUB_BUCKET_BITS = 6;
+    static constexpr int BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS;
+
+    LatencyHistogram();
+
+    void record(uint64_t value) {
+        ++counts[indexOf(value)];
+        ++count;
+        if (value > maxValue) {maxValue = value;}
+    }
+
+    // Smallest recorded value v with at least quantile of the samples at or below it, within the bucket resolution
+    [[nodiscard]] uint64_t valueAtQuantile(double quantile) const;
+
+    void reset();
+
+    // Getters
+    [[nodiscard]] uint64_t getCount() const;
+    [[nodiscard]] uint64_t getMax() const;
+
+private:
+    static int indexOf(const uint64_t value) {
+        if (value < (2ull << SUB_BUCKET_BITS)) {return static_cast<int>(value);}
+        const int exponent = std::bit_width(value) - 1;
+        const int shift = exponent - SUB_BUCKET_BITS;
+        return (shift << SUB_BUCKET_BITS) + static_cast<int>(value >> shift);
+    }
+    static uint64_t highestValueAt(int index);
+
+    std::vector<uint64_t> counts;
+    uint64_t count = 0;
+    uint64_t maxValue = 0;
+};
+
+struct LatencySite {
+    std::string name;
+    LatencyHistogram ticks;
+};
+
+// Site of that name, created on first use; the pointer stays valid for the life of the process
+LatencySite* latencySite(const char* name);
+
+void setLatencyOutputFolder(const char* folder);
+void flushLatencyProbes();
+
+inline uint64_t latencyNow() {
+#if defined(__x86_64__) || defined(_M_X64)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// Counts finished outermost scopes, every so often checks whether a periodic dump is due
+void latencyScopeExited();
+
+class LatencyScope {
+
+public:
+    explicit LatencyScope(LatencySite* site) : site(site), start(latencyNow()) {++depth;}
+    ~LatencyScope() {
+        site->ticks.record(latencyNow() - start);
+        if (--depth == 0) {latencyScopeExited();}
+    }
+
+    LatencyScope(const LatencyScope&) = delete;
+    LatencyScope& operator=(const LatencyScope&) = delete;
+
+private:
+    static inline thread_local int depth = 0;
+    LatencySite* const site;
+    const uint64_t start;
+};
+
+#define LATENCY_PROBE_CONCAT_(a, b) a##b
+#define LATENCY_PROBE_CONCAT(a, b) LATENCY_PROBE_CONCAT_(a, b)
+
+#define LATENCY_PROBE(name) \
+    static LatencySite* const LATENCY_PROBE_CONCAT(latencySite_, __LINE__) = latencySite(name); \
+    const LatencyScope LATENCY_PROBE_CONCAT(latencyScope_, __LINE__)(LATENCY_PROBE_CONCAT(latencySite_, __LINE__))
+
+#define LATENCY_PROBE_STUDY(sc) \
+    static LatencySite* const latencyStudySite = (setLatencyOutputFolder((sc).DataFilesFolder().GetChars()), \
+                                                  latencySite(__func__)); \
+    static LatencySite* const latencyStudyFullSite = latencySite((std::string(__func__) + " [full recalculation]").c_str()); \
+    const LatencyScope latencyStudyScope((sc).IsFullRecalculation ? latencyStudyFullSite : latencyStudySite)
+
+#define LATENCY_PROBE_FLUSH() flushLatencyProbes()
+
+#else
+
+#define LATENCY_PROBE(name) static_cast<void>(0)
+#define LATENCY_PROBE_STUDY(sc) static_cast<void>(0)
+#define LATENCY_PROBE_FLUSH() static_cast<void>(0)
+
+#endif
+
+#endif //LATENCYPROBE_H
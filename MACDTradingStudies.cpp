@@ -1,7 +1,65 @@
 #include "sierrachart.h"
+#include "LatencyProbe.h"
+#include "MacdKernel.h"
+#include "TradeManager.h"
 #include "TradeWrapper.h"
+#include "OrderModifyQueue.h"
+#include "OrderStateCache.h"
+#include "StateSnapshot.h"
+#include "StudyArrayBindings.h"
+#include "TradeEventLog.h"
+#include "TradeJournal.h"
 #include "helpers.h"
 
+namespace {
+
+// EMWA/MACD/ATR of the MACD strategies' bars: from the study's own kernel, configured by the length inputs, when
+// useBuiltIn is set, from the upstream price EMWA, MACD and ATR studies otherwise
+class MacdIndicators {
+
+public:
+    MacdIndicators(SCStudyInterfaceRef sc, SCInputRef useBuiltIn, SCInputRef priceEmaStudy, SCInputRef macdStudy,
+                   SCInputRef atrStudy, SCInputRef priceEmaLength, SCInputRef fastLength, SCInputRef slowLength,
+                   SCInputRef signalLength, SCInputRef atrLength)
+        : sc(sc),
+          builtIn(useBuiltIn.GetYesNo() == 1),
+          kernel(getMacdKernel(sc)),
+          bindings(getStudyArrayBindings(sc)) {
+        if (builtIn) {
+            kernel.configure(priceEmaLength.GetInt(), fastLength.GetInt(), slowLength.GetInt(), signalLength.GetInt(),
+                             atrLength.GetInt());
+            kernel.update(sc);
+        } else {
+            bindings.bind(sc, {{priceEmaStudy.GetStudyID(), 0}, {macdStudy.GetStudyID(), 0}, {macdStudy.GetStudyID(), 1},
+                               {macdStudy.GetStudyID(), 2}, {atrStudy.GetStudyID(), 0}});
+        }
+    }
+
+    [[nodiscard]] MacdBarState at(const int i) const {
+        if (builtIn) {return kernel.at(i);}
+        MacdBarState bar;
+        bar.priceEma = bindings[0][i];
+        bar.macd = bindings[1][i];
+        bar.signal = bindings[2][i];
+        bar.histogram = bindings[3][i];
+        bar.atr = bindings[4][i];
+        bar.crossOver = static_cast<int8_t>(sc.CrossOver(bindings[1], bindings[2], i));
+        return bar;
+    }
+
+    [[nodiscard]] float priceEmaAt(const int i) const {
+        return builtIn ? kernel.at(i).priceEma : bindings[0][i];
+    }
+
+private:
+    SCStudyInterfaceRef sc;
+    const bool builtIn;
+    MacdKernel& kernel;
+    StudyArrayBindings& bindings;
+};
+
+}
+
 SCSFExport scsf_StrategyMACDShort(SCStudyInterfaceRef sc) {
     /*
      Shorting Red MACD when:
@@ -29,6 +87,14 @@ SCSFExport scsf_StrategyMACDShort(SCStudyInterfaceRef sc) {
     SCInputRef GiveBackTicks = sc.Input[8];
     SCInputRef MaxTicksEntryFromCrossOVer = sc.Input[9];
     SCInputRef AllowTradingAlways = sc.Input[10];
+    SCInputRef TradingSessions = sc.Input[11];
+    SCInputRef SessionExceptions = sc.Input[12];
+    SCInputRef UseBuiltInIndicators = sc.Input[13];
+    SCInputRef PriceEMWALength = sc.Input[14];
+    SCInputRef MACDFastLength = sc.Input[15];
+    SCInputRef MACDSlowLength = sc.Input[16];
+    SCInputRef MACDSignalLength = sc.Input[17];
+    SCInputRef ATRLength = sc.Input[18];
 
     SCSubgraphRef TradeId = sc.Subgraph[0];
     SCSubgraphRef CumMaxOpenPnL = sc.Subgraph[1];
@@ -87,6 +153,35 @@ SCSFExport scsf_StrategyMACDShort(SCStudyInterfaceRef sc) {
         AllowTradingAlways.Name = "Allow trading always";
         AllowTradingAlways.SetYesNo(0);
 
+        TradingSessions.Name = "Trading sessions (HH:MM-HH:MM, comma separated)";
+        TradingSessions.SetString("09:30-15:30");
+
+        SessionExceptions.Name = "Holidays and early closes (YYYY-MM-DD [HH:MM], comma separated)";
+        SessionExceptions.SetString("");
+
+        UseBuiltInIndicators.Name = "Compute EMWA/MACD/ATR in the study (the study inputs are then unused)";
+        UseBuiltInIndicators.SetYesNo(0);
+
+        PriceEMWALength.Name = "Price EMWA length";
+        PriceEMWALength.SetIntLimits(1, 500);
+        PriceEMWALength.SetInt(20);
+
+        MACDFastLength.Name = "MACD fast length";
+        MACDFastLength.SetIntLimits(1, 500);
+        MACDFastLength.SetInt(12);
+
+        MACDSlowLength.Name = "MACD slow length";
+        MACDSlowLength.SetIntLimits(1, 500);
+        MACDSlowLength.SetInt(26);
+
+        MACDSignalLength.Name = "MACD signal length";
+        MACDSignalLength.SetIntLimits(1, 500);
+        MACDSignalLength.SetInt(9);
+
+        ATRLength.Name = "ATR length";
+        ATRLength.SetIntLimits(1, 500);
+        ATRLength.SetInt(14);
+
         TradeId.Name = "Trade ID";
         CumMaxOpenPnL.Name = "Cumulative maximum open PnL";
         CurrentOpenPnL.Name = "Current open PnL";
@@ -108,7 +203,15 @@ SCSFExport scsf_StrategyMACDShort(SCStudyInterfaceRef sc) {
 
         // sc.MaximumPositionAllowed = 1;
 
+        return;
     }
+    if (sc.LastCallToFunction) {
+        releaseHelperState(sc);
+        return;
+    }
+    LATENCY_PROBE_STUDY(sc);
+    beginHelperUpdate(sc, true);
+
     const int i = sc.Index;
 
     // Common study specs
@@ -128,35 +231,27 @@ SCSFExport scsf_StrategyMACDShort(SCStudyInterfaceRef sc) {
     }
 
     // Trading allowed bool
+    configureSessionCalendar(sc, TradingSessions.GetString(), SessionExceptions.GetString());
     bool TradingAllowed = AllowTradingAlways.GetInt() == 1 ? true : tradingAllowedCash(sc);
 
-    // Retrieving Studies
-    SCFloatArray PriceEMWA;
-    SCFloatArray MACD;
-    SCFloatArray MACDMA;
-    SCFloatArray MACDDiff;
-    SCFloatArray ATR;
-
-    sc.GetStudyArrayUsingID(PriceEMWAStudy.GetStudyID(), 0, PriceEMWA);
-    sc.GetStudyArrayUsingID(MACDXStudy.GetStudyID(), 0, MACD);
-    sc.GetStudyArrayUsingID(MACDXStudy.GetStudyID(), 1, MACDMA);
-    sc.GetStudyArrayUsingID(MACDXStudy.GetStudyID(), 2, MACDDiff);
-    sc.GetStudyArrayUsingID(ATRStudy.GetStudyID(), 0, ATR);
-
-    const int Xover = sc.CrossOver(MACD, MACDMA, i);
-    if (Xover==CROSS_FROM_TOP) {
+    // EMWA/MACD/ATR of the bar, from the study's own kernel or from the upstream studies
+    const MacdIndicators indicators(sc, UseBuiltInIndicators, PriceEMWAStudy, MACDXStudy, ATRStudy, PriceEMWALength,
+                                    MACDFastLength, MACDSlowLength, MACDSignalLength, ATRLength);
+    const MacdBarState Current = indicators.at(i);
+
+    if (Current.crossOver == CROSS_FROM_TOP) {
         LastCrossOverSellIndex = i;
     }
 
     const bool EWACond = UseEWAThresh.GetYesNo() == 1
-    ? sc.Close[i] < PriceEMWA[i] && sc.Close[LastCrossOverSellIndex] < PriceEMWA[LastCrossOverSellIndex]
+    ? sc.Close[i] < Current.priceEma && sc.Close[LastCrossOverSellIndex] < indicators.priceEmaAt(LastCrossOverSellIndex)
     : true;
 
     const bool sellCondition = EWACond
             && TradingAllowed
             && LastSellTradeIndex < LastCrossOverSellIndex
-            && MACD[i] <= 0
-            && MACDDiff[i] <= MaxMACDDiff.GetFloat() // && MACDDiff[i-1] <= MaxMACDDiff.GetFloat() // To avoid entry periods of 1 bar only...
+            && Current.macd <= 0
+            && Current.histogram <= MaxMACDDiff.GetFloat() // && MACDDiff[i-1] <= MaxMACDDiff.GetFloat() // To avoid entry periods of 1 bar only...
             && i - LastCrossOverSellIndex <= MaxTicksEntryFromCrossOVer.GetInt();
 
     s_SCPositionData PositionData;
@@ -164,26 +259,70 @@ SCSFExport scsf_StrategyMACDShort(SCStudyInterfaceRef sc) {
 
     if (sellCondition && PositionData.PositionQuantity == 0) {
         int orderSubmitted = 0;
-        NewOrder.Target1Offset = 2 * ATR[i];
-        NewOrder.Stop1Offset = 2 * ATR[i];
+        NewOrder.Target1Offset = 2 * Current.atr;
+        NewOrder.Stop1Offset = 2 * Current.atr;
         // NewOrder.Stop1Price = sc.High[LastCrossOverSellIndex] + sc.TickSize * 3;
 
-        orderSubmitted = static_cast<int>(sc.SellOrder(NewOrder));
+        {
+            LATENCY_PROBE("sc.SellOrder");
+            orderSubmitted = static_cast<int>(sc.SellOrder(NewOrder));
+        }
         LastSellTradeIndex = LastCrossOverSellIndex;
         if (orderSubmitted > 0) {
             FillPrice = NewOrder.Price1;
             InternalOrderID = NewOrder.InternalOrderID;
             // TradeId[i] = static_cast<float>(InternalOrderID);
-            SCString Buffer;
-            Buffer.Format("ADDED ORDER WITH ID %d", InternalOrderID);
-            sc.AddMessageToLog(Buffer, 1);
+            logTradeEvent(sc, TradeEventType::OrderSubmitted, i, InternalOrderID, sc.Close[i]);
+        } else {
+            logTradeEvent(sc, TradeEventType::OrderRejected, i, 0, sc.Close[i], 0, static_cast<uint16_t>(-orderSubmitted));
         }
     }
 
     int& MaxPnLForTradeInTicks = sc.GetPersistentInt(1);
+
+    // The position goes to the trade journal as it shows up and once it is flat again, with its excursions
+    int& MaxAdverseTicks = sc.GetPersistentInt(4);
+    int& PositionJournaled = sc.GetPersistentInt(5);
+    int& PositionEntryTicks = sc.GetPersistentInt(6);
+    int64_t& PositionTradeId = sc.GetPersistentInt64(2);
+    const auto journalPosition = [&](const JournalEvent event, const PriceTicks price) {
+        JournalRow row;
+        row.tradeId = PositionTradeId;
+        row.barIndex = i;
+        row.price = price;
+        row.fillPrice = PositionEntryTicks;
+        row.maxFavorable = MaxPnLForTradeInTicks;
+        row.maxAdverse = MaxAdverseTicks;
+        row.event = event;
+        row.direction = -1;
+        journalTradeRow(sc, row);
+    };
+
+    // A full recalculation sees today's position on every historical bar. A position open then was journaled as it
+    // showed up, or in a session whose trade id is gone (0), and then its exit is left out too
+    if (isFullRecalculationStart(sc)) {
+        PositionJournaled = PositionData.PositionQuantity != 0 ? 1 : 0;
+    }
+    if (!sc.IsFullRecalculation && i == sc.ArraySize - 1) {
+        if (PositionData.PositionQuantity != 0 && PositionJournaled == 0) {
+            PositionJournaled = 1;
+            PositionTradeId = InternalOrderID;
+            PositionEntryTicks = toTicks(sc, PositionData.AveragePrice);
+            MaxAdverseTicks = 0;
+            journalPosition(JournalEvent::Entry, PositionEntryTicks);
+        } else if (PositionData.PositionQuantity == 0 && PositionJournaled != 0) {
+            PositionJournaled = 0;
+            if (PositionTradeId != 0) {
+                journalPosition(JournalEvent::Exit, toTicks(sc, sc.Close[i]));
+            }
+        }
+    }
+
     if (int CurrentPnLTicks; PositionData.PositionQuantity != 0) {
         CurrentPnLTicks = static_cast<int>(PositionData.OpenProfitLoss  / sc.CurrencyValuePerTick);
         CurrentOpenPnL[i] = static_cast<float>(CurrentPnLTicks);
+        // Short only: the adverse side is the high of the position
+        MaxAdverseTicks = std::max(MaxAdverseTicks, toTicks(sc, PositionData.PriceHighDuringPosition) - PositionEntryTicks);
         if (CurrentPnLTicks > MaxPnLForTradeInTicks) {
             MaxPnLForTradeInTicks = CurrentPnLTicks;
             // const double NewStop = PositionData.PriceLowDuringPosition + (GiveBackTicks.GetFloat() * sc.TickSize);
@@ -227,6 +366,19 @@ SCSFExport scsf_StrategyMACDShort(SCStudyInterfaceRef sc) {
     flattenAllAfterCash(sc);
 }
 
+namespace {
+
+// What StrategyMACDShortFromManager carries from bar to bar besides its subgraphs, as saved in its state snapshot
+struct MacdManagerState {
+    int64_t internalOrderId;
+    double fillPrice;
+    int32_t lastCrossOverSellIndex;
+    int32_t tradeCount;
+    TradeWrapperState trades[TRADE_MANAGER_CAPACITY];
+};
+
+}
+
 SCSFExport scsf_StrategyMACDShortFromManager(SCStudyInterfaceRef sc) {
     /*
      Shorting Red MACD when:
@@ -254,6 +406,17 @@ SCSFExport scsf_StrategyMACDShortFromManager(SCStudyInterfaceRef sc) {
     SCInputRef GiveBackTicks = sc.Input[8];
     SCInputRef MaxTicksEntryFromCrossOVer = sc.Input[9];
     SCInputRef AllowTradingAlways = sc.Input[10];
+    SCInputRef MinModifyIntervalMs = sc.Input[11];
+    SCInputRef MaxConcurrentTrades = sc.Input[12];
+    SCInputRef TradingSessions = sc.Input[13];
+    SCInputRef SessionExceptions = sc.Input[14];
+    SCInputRef UseBuiltInIndicators = sc.Input[15];
+    SCInputRef PriceEMWALength = sc.Input[16];
+    SCInputRef MACDFastLength = sc.Input[17];
+    SCInputRef MACDSlowLength = sc.Input[18];
+    SCInputRef MACDSignalLength = sc.Input[19];
+    SCInputRef ATRLength = sc.Input[20];
+    SCInputRef UseStateSnapshot = sc.Input[21];
 
     SCSubgraphRef TradeId = sc.Subgraph[0];
     SCSubgraphRef CumMaxOpenPnL = sc.Subgraph[1];
@@ -310,6 +473,46 @@ SCSFExport scsf_StrategyMACDShortFromManager(SCStudyInterfaceRef sc) {
         AllowTradingAlways.Name = "Allow trading always";
         AllowTradingAlways.SetYesNo(0);
 
+        TradingSessions.Name = "Trading sessions (HH:MM-HH:MM, comma separated)";
+        TradingSessions.SetString("09:30-15:30");
+
+        SessionExceptions.Name = "Holidays and early closes (YYYY-MM-DD [HH:MM], comma separated)";
+        SessionExceptions.SetString("");
+
+        UseBuiltInIndicators.Name = "Compute EMWA/MACD/ATR in the study (the study inputs are then unused)";
+        UseBuiltInIndicators.SetYesNo(0);
+
+        PriceEMWALength.Name = "Price EMWA length";
+        PriceEMWALength.SetIntLimits(1, 500);
+        PriceEMWALength.SetInt(20);
+
+        MACDFastLength.Name = "MACD fast length";
+        MACDFastLength.SetIntLimits(1, 500);
+        MACDFastLength.SetInt(12);
+
+        MACDSlowLength.Name = "MACD slow length";
+        MACDSlowLength.SetIntLimits(1, 500);
+        MACDSlowLength.SetInt(26);
+
+        MACDSignalLength.Name = "MACD signal length";
+        MACDSignalLength.SetIntLimits(1, 500);
+        MACDSignalLength.SetInt(9);
+
+        ATRLength.Name = "ATR length";
+        ATRLength.SetIntLimits(1, 500);
+        ATRLength.SetInt(14);
+
+        MinModifyIntervalMs.Name = "Minimum milliseconds between modifications of an order";
+        MinModifyIntervalMs.SetIntLimits(0, 10000);
+        MinModifyIntervalMs.SetInt(250);
+
+        MaxConcurrentTrades.Name = "Maximum concurrent trades";
+        MaxConcurrentTrades.SetIntLimits(1, TRADE_MANAGER_CAPACITY);
+        MaxConcurrentTrades.SetInt(1);
+
+        UseStateSnapshot.Name = "Resume from the state saved when the chart closed";
+        UseStateSnapshot.SetYesNo(0);
+
         TradeId.Name = "Trade ID";
         TradeId.DrawStyle = DRAWSTYLE_IGNORE;
 
@@ -329,20 +532,60 @@ SCSFExport scsf_StrategyMACDShortFromManager(SCStudyInterfaceRef sc) {
         tradeFilledPrice.Name = "Trade filled price";
         tradeFilledPrice.DrawStyle = DRAWSTYLE_LINE;
 
+        return;
     }
-    const int i = sc.Index;
+    // Retrieving ID
+    int64_t &InternalOrderID = sc.GetPersistentInt64(1);
+    int &LastCrossOverSellIndex = sc.GetPersistentInt(2);
+    int &LastSellTradeIndex = sc.GetPersistentInt(3);
+    double &FillPrice = sc.GetPersistentDouble(1);
+    // Bars [0, ResumeFromBar) of the running full recalculation were restored from the state snapshot
+    int &ResumeFromBar = sc.GetPersistentInt(4);
+
+    // Every input but UseStateSnapshot shapes the state. LastSellTradeIndex starts over on a full recalculation anyway
+    const auto snapshotKey = [&] {return stateSnapshotKey(sc, "StrategyMACDShortFromManager", 21);};
+    const auto snapshotArrays = {&TradeId.Data, &CumMaxOpenPnL.Data, &CurrentOpenPnL.Data, &lastTradeIndex.Data,
+                                 &lastXOverIndex.Data, &tradeFilledPrice.Data};
+
+    if (sc.LastCallToFunction) {
+        if (UseStateSnapshot.GetYesNo()) {
+            MacdManagerState state{};
+            state.internalOrderId = InternalOrderID;
+            state.fillPrice = FillPrice;
+            state.lastCrossOverSellIndex = LastCrossOverSellIndex;
+            getTradeManager(sc).forEachActive([&](const TradeWrapper& trade) {
+                state.trades[state.tradeCount++] = trade.getState();
+            });
+            saveStateSnapshot(sc, snapshotKey(), snapshotArrays, state);
+        }
+        releaseHelperState(sc);
+        return;
+    }
+    LATENCY_PROBE_STUDY(sc);
+    beginHelperUpdate(sc, true);
 
-    // Get the trade wrapper from persistent storage
-    auto* trade = static_cast<TradeWrapper*>(sc.GetPersistentPointer(1));
+    const int i = sc.Index;
 
-    if (sc.IsFullRecalculation) {
-        // Clean up existing trade if any
-        if (trade != nullptr) {
-            delete trade;
-            trade = nullptr;
+    // Open trades, emptied by beginHelperUpdate on a full recalculation and freed on the last call
+    TradeManager& trades = getTradeManager(sc);
+
+    if (isFullRecalculationStart(sc)) {
+        ResumeFromBar = 0;
+        MacdManagerState state{};
+        if (UseStateSnapshot.GetYesNo()
+            && (ResumeFromBar = loadStateSnapshot(sc, snapshotKey(), snapshotArrays, state)) > 0) {
+            InternalOrderID = state.internalOrderId;
+            FillPrice = state.fillPrice;
+            LastCrossOverSellIndex = state.lastCrossOverSellIndex;
+            // Trades whose orders the trade service no longer knows (another day, another account) stay behind
+            for (int k = 0; k < state.tradeCount; ++k) {
+                if (s_SCTradeOrder order; sc.GetOrderByOrderID(state.trades[k].parentOrderId, order) == 1) {
+                    trades.restore(state.trades[k]);
+                }
+            }
         }
-        sc.SetPersistentPointer(1, nullptr);
     }
+    if (i < ResumeFromBar) {return;}
 
     // Common study specs
     s_SCNewOrder NewOrder;
@@ -350,68 +593,58 @@ SCSFExport scsf_StrategyMACDShortFromManager(SCStudyInterfaceRef sc) {
     NewOrder.OrderType = SCT_ORDERTYPE_MARKET;
     NewOrder.TimeInForce = SCT_TIF_DAY;
 
-    // Retrieving ID
-    int64_t &InternalOrderID = sc.GetPersistentInt64(1);
-    int &LastCrossOverSellIndex = sc.GetPersistentInt(2);
-    int &LastSellTradeIndex = sc.GetPersistentInt(3);
-    double &FillPrice = sc.GetPersistentDouble(1);
-
     if (sc.IsFullRecalculation) {
         LastSellTradeIndex = 0;
     }
 
     // Trading allowed bool
+    configureSessionCalendar(sc, TradingSessions.GetString(), SessionExceptions.GetString());
     bool TradingAllowed = AllowTradingAlways.GetInt() == 1 ? true : tradingAllowedCash(sc);
 
-    // Retrieving Studies
-    SCFloatArray PriceEMWA;
-    SCFloatArray MACD;
-    SCFloatArray MACDMA;
-    SCFloatArray MACDDiff;
-    SCFloatArray ATR;
-
-    sc.GetStudyArrayUsingID(PriceEMWAStudy.GetStudyID(), 0, PriceEMWA);
-    sc.GetStudyArrayUsingID(MACDXStudy.GetStudyID(), 0, MACD);
-    sc.GetStudyArrayUsingID(MACDXStudy.GetStudyID(), 1, MACDMA);
-    sc.GetStudyArrayUsingID(MACDXStudy.GetStudyID(), 2, MACDDiff);
-    sc.GetStudyArrayUsingID(ATRStudy.GetStudyID(), 0, ATR);
-
-    const int Xover = sc.CrossOver(MACD, MACDMA, i);
-    if (Xover == CROSS_FROM_TOP) {
+    // EMWA/MACD/ATR of the bar, from the study's own kernel or from the upstream studies
+    const MacdIndicators indicators(sc, UseBuiltInIndicators, PriceEMWAStudy, MACDXStudy, ATRStudy, PriceEMWALength,
+                                    MACDFastLength, MACDSlowLength, MACDSignalLength, ATRLength);
+    const MacdBarState Current = indicators.at(i);
+
+    if (Current.crossOver == CROSS_FROM_TOP) {
         LastCrossOverSellIndex = i;
     }
 
     const bool EWACond = UseEWAThresh.GetYesNo() == 1
-        ? sc.Close[i] < PriceEMWA[i] && sc.Close[LastCrossOverSellIndex] < PriceEMWA[LastCrossOverSellIndex]
+        ? sc.Close[i] < Current.priceEma && sc.Close[LastCrossOverSellIndex] < indicators.priceEmaAt(LastCrossOverSellIndex)
         : true;
 
     const bool sellCondition = EWACond
         && TradingAllowed
         && LastSellTradeIndex < LastCrossOverSellIndex
-        && MACD[i] <= 0
-        && MACDDiff[i] <= MaxMACDDiff.GetFloat()
+        && Current.macd <= 0
+        && Current.histogram <= MaxMACDDiff.GetFloat()
         && i - LastCrossOverSellIndex <= MaxTicksEntryFromCrossOVer.GetInt();
 
     s_SCPositionData PositionData;
     sc.GetTradePosition(PositionData);
 
-    // Update existing trade
-    if (trade != nullptr) {
+    OrderModifyQueue& modifications = getOrderModifyQueue(sc);
+    modifications.setMinIntervalMs(MinModifyIntervalMs.GetInt());
+
+    // Update existing trades
+    trades.forEachActive([&](TradeWrapper& trade) {
+        const int64_t parentId = trade.getParentOrderId();
         try {
-            switch (trade->getRealStatus(i)) {
+            switch (trade.getRealStatus(i)) {
                 case TradeStatus::Terminated:
-                    delete trade;
-                    trade = nullptr;
-                    sc.SetPersistentPointer(1, nullptr);
+                    trade.journalExit(sc, i);
+                    getOrderStateCache(sc).forget(parentId);
+                    modifications.forget(trade.getStopOrderId());
+                    modifications.forget(trade.getTargetOrderId());
+                    logTradeEvent(sc, TradeEventType::TradeClosed, i, parentId, toPrice(sc, trade.getFilledPrice()));
+                    trades.close(parentId);
                     break;
                 default:
-                    trade->updateAll(sc, i);
-                    if (const int success = trade->modifyStopTargetOrders(sc, i); success == 2) {
-                        SCString Buffer;
-                        sc.AddMessageToLog(Buffer.Format("Successfully changed the order"), 1);
-                    }
+                    trade.updateAll(sc, i);
+                    trade.modifyStopTargetOrders(sc, i);
 
-                    tradeFilledPrice[i] = static_cast<float>(trade->getMaxFavorablePriceDifference());
+                    tradeFilledPrice[i] = static_cast<float>(toPrice(sc, trade.getMaxFavorablePriceDifference()));
                     break;
             }
         } catch (const std::exception& e) {
@@ -420,39 +653,38 @@ SCSFExport scsf_StrategyMACDShortFromManager(SCStudyInterfaceRef sc) {
             sc.AddMessageToLog(Buffer, 1);
 
             // Clean up on error
-            delete trade;
-            trade = nullptr;
-            sc.SetPersistentPointer(1, nullptr);
+            trades.close(parentId);
         }
-    }
+    });
+
+    // Unchanged prices are dropped here, rate limited ones wait for a later call
+    modifications.flush(sc);
 
-    if (sellCondition && trade == nullptr) {
+    if (sellCondition && trades.getActiveCount() < MaxConcurrentTrades.GetInt()) {
         int orderSubmitted = 0;
         NewOrder.Target1Offset = 3 * sc.TickSize;
         NewOrder.Stop1Offset = 3 * sc.TickSize;
 
-        orderSubmitted = static_cast<int>(sc.SellOrder(NewOrder));
+        {
+            LATENCY_PROBE("sc.SellOrder");
+            orderSubmitted = static_cast<int>(sc.SellOrder(NewOrder));
+        }
 
         if (orderSubmitted > 0) {
             LastSellTradeIndex = LastCrossOverSellIndex;
             FillPrice = NewOrder.Price1;
             InternalOrderID = NewOrder.InternalOrderID;
 
-            // Create new trade wrapper with proper error handling
-            try {
-                trade = new TradeWrapper(InternalOrderID, i, TargetMode::Evolving,  BSE_SELL, 2*sc.TickSize);
-                sc.SetPersistentPointer(1, trade);
+            if (trades.open(InternalOrderID, i, TargetMode::Evolving, BSE_SELL, 2) != nullptr) {
                 TradeId[i] = static_cast<float>(InternalOrderID);
-
-                SCString Buffer;
-                Buffer.Format("ADDED ORDER WITH ID %d (Evolving mode)", InternalOrderID);
-                sc.AddMessageToLog(Buffer, 1);
-            } catch (const std::exception& e) {
+                logTradeEvent(sc, TradeEventType::OrderSubmitted, i, InternalOrderID, sc.Close[i]);
+            } else {
                 SCString Buffer;
-                Buffer.Format("ERROR: Failed to create TradeWrapper: %s", e.what());
+                Buffer.Format("ERROR: No free trade slot for order %d", InternalOrderID);
                 sc.AddMessageToLog(Buffer, 1);
-                trade = nullptr;
             }
+        } else {
+            logTradeEvent(sc, TradeEventType::OrderRejected, i, 0, sc.Close[i], 0, static_cast<uint16_t>(-orderSubmitted));
         }
     }
 
@@ -0,0 +1,89 @@
+#include "MacdKernel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Sierra's exponential moving average step, seeded with the first input
+float emaStep(const float previous, const float value, const int length) {
+    const float alpha = 2.0f / (static_cast<float>(length) + 1.0f);
+    return previous + alpha * (value - previous);
+}
+
+}
+
+void MacdKernel::configure(const int newPriceEmaLength, const int newFastLength, const int newSlowLength,
+                           const int newSignalLength, const int newAtrLength) {
+    if (newPriceEmaLength == priceEmaLength && newFastLength == fastLength && newSlowLength == slowLength
+        && newSignalLength == signalLength && newAtrLength == atrLength) {
+        return;
+    }
+    priceEmaLength = newPriceEmaLength;
+    fastLength = newFastLength;
+    slowLength = newSlowLength;
+    signalLength = newSignalLength;
+    atrLength = newAtrLength;
+    reset();
+}
+
+void MacdKernel::update(SCStudyInterfaceRef sc) {
+    const int count = sc.ArraySize;
+    if (count < static_cast<int>(bars.size())) {reset();}
+    const int from = std::max(0, static_cast<int>(bars.size()) - 1);
+    bars.resize(count);
+    for (int i = from; i < count; ++i) {
+        step(sc, i);
+    }
+}
+
+void MacdKernel::reset() {
+    bars.clear();
+}
+
+void MacdKernel::step(SCStudyInterfaceRef sc, const int barIndex) {
+    MacdBarState& bar = bars[barIndex];
+    const float close = sc.Close[barIndex];
+    const float range = sc.High[barIndex] - sc.Low[barIndex];
+    if (barIndex == 0) {
+        bar.priceEma = close;
+        bar.fastEma = close;
+        bar.slowEma = close;
+        bar.macd = bar.fastEma - bar.slowEma;
+        bar.signal = bar.macd;
+        bar.histogram = bar.macd - bar.signal;
+        bar.atr = range;
+        bar.lastHistogram = bar.histogram;
+        bar.crossOver = NO_CROSS;
+        return;
+    }
+
+    const MacdBarState& previous = bars[barIndex - 1];
+    bar.priceEma = emaStep(previous.priceEma, close, priceEmaLength);
+    bar.fastEma = emaStep(previous.fastEma, close, fastLength);
+    bar.slowEma = emaStep(previous.slowEma, close, slowLength);
+    bar.macd = bar.fastEma - bar.slowEma;
+    bar.signal = emaStep(previous.signal, bar.macd, signalLength);
+    bar.histogram = bar.macd - bar.signal;
+
+    const float previousClose = sc.Close[barIndex - 1];
+    const float trueRange = std::max({range, std::abs(sc.High[barIndex] - previousClose),
+                                      std::abs(sc.Low[barIndex] - previousClose)});
+    bar.atr = previous.atr + (trueRange - previous.atr) / static_cast<float>(atrLength);
+
+    bar.lastHistogram = bar.histogram != 0 ? bar.histogram : previous.lastHistogram;
+    if (bar.histogram < 0 && previous.lastHistogram > 0) {
+        bar.crossOver = CROSS_FROM_TOP;
+    } else if (bar.histogram > 0 && previous.lastHistogram < 0) {
+        bar.crossOver = CROSS_FROM_BOTTOM;
+    } else {
+        bar.crossOver = NO_CROSS;
+    }
+}
+
+const MacdBarState& MacdKernel::at(const int barIndex) const {
+    static const MacdBarState empty{};
+    return barIndex >= 0 && barIndex < static_cast<int>(bars.size()) ? bars[barIndex] : empty;
+}
+
+int MacdKernel::getComputedCount() const {return static_cast<int>(bars.size());}
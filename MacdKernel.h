@@ -0,0 +1,55 @@
+#ifndef MACDKERNEL_H
+#define MACDKERNEL_H
+
+#include "sierrachart.h"
+
+#include <cstdint>
+#include <vector>
+
+// Everything the MACD strategies read about one bar
+struct MacdBarState {
+    float priceEma = 0;
+    float fastEma = 0;
+    float slowEma = 0;
+    float macd = 0;       // fastEma - slowEma
+    float signal = 0;     // EMA of macd
+    float histogram = 0;  // macd - signal
+    float atr = 0;
+    float lastHistogram = 0;  // Most recent non zero histogram up to this bar, what a crossover is measured against
+    int8_t crossOver = NO_CROSS;
+};
+
+/*
+ * Price EMA, MACD (line, signal, histogram), ATR and MACD/signal crossover of every bar in one pass over the chart,
+ * in place of three upstream studies and sc.CrossOver. Each bar is a fixed size state computed from the previous one,
+ * so a full recalculation is one batch loop and a live update recomputes only the bars from the last one computed.
+ * The arithmetic follows Sierra's studies: float EMAs seeded with the first value, Wilder smoothed ATR, and a
+ * crossover looking back past bars where the two lines are equal.
+ */
+class MacdKernel {
+
+public:
+    // Lengths of the price EMA, the MACD fast/slow/signal EMAs and the ATR. A change drops the computed bars.
+    void configure(int priceEmaLength, int fastLength, int slowLength, int signalLength, int atrLength);
+
+    // Computes the bars added since the last call and recomputes the last one computed, which may have traded since
+    void update(SCStudyInterfaceRef sc);
+
+    void reset();
+
+    // Getters
+    [[nodiscard]] const MacdBarState& at(int barIndex) const;
+    [[nodiscard]] int getComputedCount() const;
+
+private:
+    void step(SCStudyInterfaceRef sc, int barIndex);
+
+    int priceEmaLength = 20;
+    int fastLength = 12;
+    int slowLength = 26;
+    int signalLength = 9;
+    int atrLength = 14;
+    std::vector<MacdBarState> bars;
+};
+
+#endif //MACDKERNEL_H
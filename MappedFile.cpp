@@ -0,0 +1,158 @@
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+MappedFile::~MappedFile() {close();}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {*this = std::move(other);}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        std::swap(data, other.data);
+        std::swap(size, other.size);
+#ifdef _WIN32
+        std::swap(fileHandle, other.fileHandle);
+        std::swap(mappingHandle, other.mappingHandle);
+#else
+        std::swap(fd, other.fd);
+#endif
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path, const MapMode mode, const size_t minSize) {
+    close();
+    const bool writable = mode == MapMode::ReadWrite;
+    HANDLE file = CreateFileA(path.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, writable ? OPEN_ALWAYS : OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {return false;}
+
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    size_t mappedSize = static_cast<size_t>(fileSize.QuadPart);
+    if (writable && mappedSize < minSize) {mappedSize = minSize;}
+    if (mappedSize == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                        static_cast<DWORD>(static_cast<uint64_t>(mappedSize) >> 32),
+                                        static_cast<DWORD>(mappedSize & 0xFFFFFFFFu), nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, writable ? FILE_MAP_READ | FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, mappedSize);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    data = static_cast<uint8_t*>(view);
+    size = mappedSize;
+    return true;
+}
+
+void MappedFile::close() {
+    if (data != nullptr) {UnmapViewOfFile(data);}
+    if (mappingHandle != nullptr) {CloseHandle(mappingHandle);}
+    if (fileHandle != nullptr) {CloseHandle(fileHandle);}
+    data = nullptr;
+    size = 0;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+}
+
+void MappedFile::adviseSequential() const {}
+
+void MappedFile::release(size_t, size_t) const {}
+
+bool MappedFile::flush() const {return data != nullptr && FlushViewOfFile(data, size) != 0;}
+
+#else
+
+bool MappedFile::open(const std::string& path, const MapMode mode, const size_t minSize) {
+    close();
+    const bool writable = mode == MapMode::ReadWrite;
+    const int handle = ::open(path.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    if (handle < 0) {return false;}
+
+    struct stat info {};
+    if (fstat(handle, &info) != 0) {
+        ::close(handle);
+        return false;
+    }
+    size_t mappedSize = static_cast<size_t>(info.st_size);
+    if (writable && mappedSize < minSize) {
+        if (ftruncate(handle, static_cast<off_t>(minSize)) != 0) {
+            ::close(handle);
+            return false;
+        }
+        mappedSize = minSize;
+    }
+    if (mappedSize == 0) {
+        ::close(handle);
+        return false;
+    }
+
+    void* view = mmap(nullptr, mappedSize, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, handle, 0);
+    if (view == MAP_FAILED) {
+        ::close(handle);
+        return false;
+    }
+    fd = handle;
+    data = static_cast<uint8_t*>(view);
+    size = mappedSize;
+    return true;
+}
+
+void MappedFile::close() {
+    if (data != nullptr) {munmap(data, size);}
+    if (fd >= 0) {::close(fd);}
+    data = nullptr;
+    size = 0;
+    fd = -1;
+}
+
+void MappedFile::adviseSequential() const {
+    if (data != nullptr) {madvise(data, size, MADV_SEQUENTIAL);}
+}
+
+void MappedFile::release(const size_t offset, const size_t length) const {
+    // Only whole pages inside the range can be dropped
+    const auto page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t begin = (offset + page - 1) / page * page;
+    const size_t end = std::min(offset + length, size) / page * page;
+    if (data != nullptr && end > begin) {madvise(data + begin, end - begin, MADV_DONTNEED);}
+}
+
+bool MappedFile::flush() const {return data != nullptr && msync(data, size, MS_SYNC) == 0;}
+
+#endif
+
+bool MappedFile::isOpen() const {return data != nullptr;}
+
+size_t MappedFile::getSize() const {return size;}
+
+uint8_t* MappedFile::getData() const {return data;}
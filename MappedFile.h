@@ -0,0 +1,49 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+enum class MapMode { ReadOnly, ReadWrite };
+
+/*
+ * Read-only or read-write memory mapping of a whole file (POSIX mmap / Win32 file mapping).
+ * ReadWrite mappings create the file and grow it to the requested size.
+ */
+class MappedFile {
+
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool open(const std::string& path, MapMode mode = MapMode::ReadOnly, size_t minSize = 0);
+    void close();
+
+    // Hints the kernel that [offset, offset + length) is read front to back / will not be read again
+    void adviseSequential() const;
+    void release(size_t offset, size_t length) const;
+    bool flush() const;
+
+    // Getters
+    [[nodiscard]] bool isOpen() const;
+    [[nodiscard]] size_t getSize() const;
+    [[nodiscard]] uint8_t* getData() const;
+
+private:
+    uint8_t* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+#endif //MAPPEDFILE_H
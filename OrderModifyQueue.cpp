@@ -0,0 +1,92 @@
+#include "OrderModifyQueue.h"
+#include "LatencyProbe.h"
+#include "TradeEventLog.h"
+#include "helpers.h"
+
+constexpr double MILLISECONDS_PER_DAY = 86400000.0;
+
+OrderModifyQueue::OrderModifyQueue(const int minIntervalMs) : minIntervalDays(minIntervalMs / MILLISECONDS_PER_DAY) {}
+
+void OrderModifyQueue::request(const OrderSnapshot& order, const int64_t parentOrderId, const PriceTicks desiredPrice) {
+    if (order.internalOrderId == 0) {return;}
+    Entry& entry = orders[order.internalOrderId];
+    // Pending open/modify states still carry the price before our last modification
+    if (order.status == SCT_OSC_OPEN) {
+        entry.acknowledgedPrice = order.price1Ticks;
+    }
+    if (entry.pending) {
+        ++suppressedCount;  // Superseded before it went out
+    } else {
+        entry.pending = true;
+        pendingIds.push_back(order.internalOrderId);
+    }
+    entry.parentOrderId = parentOrderId;
+    entry.desiredPrice = desiredPrice;
+}
+
+int OrderModifyQueue::flush(SCStudyInterfaceRef sc) {
+    const double now = sc.CurrentSystemDateTime.GetAsDouble();
+    int accepted = 0;
+    size_t kept = 0;
+    for (const int64_t internalOrderId : pendingIds) {
+        const auto it = orders.find(internalOrderId);
+        if (it == orders.end() || !it->second.pending) {continue;}
+        Entry& entry = it->second;
+
+        if (entry.desiredPrice == entry.acknowledgedPrice) {
+            ++suppressedCount;
+            entry.pending = false;
+            continue;
+        }
+        if (entry.sent && now - entry.lastSentTime < minIntervalDays) {
+            pendingIds[kept++] = internalOrderId;  // Rate limited, goes out with a later flush
+            continue;
+        }
+
+        const double desiredPrice = toPrice(sc, entry.desiredPrice);
+        s_SCNewOrder modifyOrder;
+        modifyOrder.InternalOrderID = internalOrderId;
+        modifyOrder.Price1 = desiredPrice;
+        int result;
+        {
+            LATENCY_PROBE("sc.ModifyOrder");
+            result = sc.ModifyOrder(modifyOrder);
+        }
+        if (result > 0) {
+            ++sentCount;
+            ++accepted;
+            entry.acknowledgedPrice = entry.desiredPrice;
+            entry.lastSentTime = now;
+            entry.sent = true;
+            logTradeEvent(sc, TradeEventType::ModifySent, sc.Index, internalOrderId, desiredPrice, entry.parentOrderId);
+        } else {
+            ++rejectedCount;
+            logTradeEvent(sc, TradeEventType::ModifyRejected, sc.Index, internalOrderId, desiredPrice, entry.parentOrderId);
+        }
+        entry.pending = false;
+        getOrderStateCache(sc).markDirty(entry.parentOrderId);
+    }
+    pendingIds.resize(kept);
+    return accepted;
+}
+
+void OrderModifyQueue::forget(const int64_t internalOrderId) {
+    orders.erase(internalOrderId);
+}
+
+void OrderModifyQueue::clear() {
+    orders.clear();
+    pendingIds.clear();
+}
+
+void OrderModifyQueue::setMinIntervalMs(const int milliseconds) {
+    minIntervalDays = milliseconds / MILLISECONDS_PER_DAY;
+}
+
+int64_t OrderModifyQueue::getSentCount() const {return sentCount;}
+
+int64_t OrderModifyQueue::getSuppressedCount() const {return suppressedCount;}
+
+int64_t OrderModifyQueue::getRejectedCount() const {return rejectedCount;}
+
+bool OrderModifyQueue::hasPending() const {return !pendingIds.empty();}
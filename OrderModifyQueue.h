@@ -0,0 +1,60 @@
+#ifndef ORDERMODIFYQUEUE_H
+#define ORDERMODIFYQUEUE_H
+
+#include "OrderStateCache.h"
+#include "PriceTicks.h"
+#include "sierrachart.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Price modifications of working orders, sent once per update cycle with flush().
+ *   - Requests for the same order before a flush coalesce, only the last desired price is sent.
+ *   - A desired price equal to the last acknowledged one is suppressed.
+ *   - An order is modified at most once per minimum interval, a request arriving earlier waits for a later flush.
+ * The acknowledged price is the working price of the order while it is settled, or the last price the trade service
+ * accepted while a modification is still in flight.
+ */
+class OrderModifyQueue {
+
+public:
+    explicit OrderModifyQueue(int minIntervalMs = 0);
+
+    // Desired Price1 for the order, parentOrderId is the bracket whose cached snapshot goes stale once it is sent
+    void request(const OrderSnapshot& order, int64_t parentOrderId, PriceTicks desiredPrice);
+
+    // Sends the pending modifications that are due, returns the number the trade service accepted
+    int flush(SCStudyInterfaceRef sc);
+
+    void forget(int64_t internalOrderId);
+    void clear();
+
+    void setMinIntervalMs(int milliseconds);
+
+    // Getters
+    [[nodiscard]] int64_t getSentCount() const;
+    [[nodiscard]] int64_t getSuppressedCount() const;
+    [[nodiscard]] int64_t getRejectedCount() const;
+    [[nodiscard]] bool hasPending() const;
+
+private:
+    struct Entry {
+        int64_t parentOrderId = 0;
+        PriceTicks desiredPrice = 0;
+        PriceTicks acknowledgedPrice = 0;
+        double lastSentTime = 0.0;  // SCDateTime days of the last accepted modification
+        bool pending = false;
+        bool sent = false;
+    };
+
+    std::unordered_map<int64_t, Entry> orders;
+    std::vector<int64_t> pendingIds;
+    double minIntervalDays;
+    int64_t sentCount = 0;
+    int64_t suppressedCount = 0;
+    int64_t rejectedCount = 0;
+};
+
+#endif //ORDERMODIFYQUEUE_H
@@ -0,0 +1,81 @@
+#include "OrderStateCache.h"
+#include "LatencyProbe.h"
+
+
+bool OrderStateCache::isSettled(const OrderSnapshot& order) {
+    switch (order.status) {
+        case SCT_OSC_OPEN:
+        case SCT_OSC_FILLED:
+        case SCT_OSC_CANCELED:
+        case SCT_OSC_ERROR:
+        case SCT_OSC_PENDINGCHILD:  // Waits for the parent fill, which grows the fill array
+            return true;
+        default:
+            return false;
+    }
+}
+
+OrderSnapshot OrderStateCache::toSnapshot(SCStudyInterfaceRef sc, const s_SCTradeOrder& order) {
+    OrderSnapshot snapshot;
+    snapshot.internalOrderId = order.InternalOrderID;
+    snapshot.price1 = order.Price1;
+    snapshot.price1Ticks = toTicks(sc, order.Price1);
+    snapshot.status = order.OrderStatusCode;
+    snapshot.buySell = order.BuySell;
+    return snapshot;
+}
+
+void OrderStateCache::advanceEpoch(SCStudyInterfaceRef sc) {
+    const int fillCount = sc.GetOrderFillArraySize();
+    if (fillCount != lastFillCount || sc.ArraySize != lastArraySize) {
+        lastFillCount = fillCount;
+        lastArraySize = sc.ArraySize;
+        ++epoch;
+    }
+}
+
+bool OrderStateCache::getBracket(SCStudyInterfaceRef sc, const int64_t parentOrderId, BracketSnapshot& bracket) {
+    advanceEpoch(sc);
+    Entry& entry = brackets[parentOrderId];
+    const bool settled = entry.found && isSettled(entry.bracket.parent) && isSettled(entry.bracket.stop)
+                         && isSettled(entry.bracket.target);
+    if (!entry.dirty && entry.epoch == epoch && settled) {
+        ++hitCount;
+        bracket = entry.bracket;
+        return true;
+    }
+
+    ++refreshCount;
+    LATENCY_PROBE("sc.GetOrderByOrderID (bracket)");
+    s_SCTradeOrder parent, stop, target;
+    entry.found = sc.GetOrderByOrderID(parentOrderId, parent) == 1;
+    sc.GetOrderByOrderID(parent.StopChildInternalOrderID, stop);
+    sc.GetOrderByOrderID(parent.TargetChildInternalOrderID, target);
+    entry.bracket.parent = toSnapshot(sc, parent);
+    entry.bracket.stop = toSnapshot(sc, stop);
+    entry.bracket.target = toSnapshot(sc, target);
+    entry.epoch = epoch;
+    entry.dirty = false;
+    bracket = entry.bracket;
+    return entry.found;
+}
+
+void OrderStateCache::markDirty(const int64_t parentOrderId) {
+    if (const auto it = brackets.find(parentOrderId); it != brackets.end()) {
+        it->second.dirty = true;
+    }
+}
+
+void OrderStateCache::forget(const int64_t parentOrderId) {
+    brackets.erase(parentOrderId);
+}
+
+void OrderStateCache::clear() {
+    brackets.clear();
+    lastFillCount = -1;
+    lastArraySize = -1;
+}
+
+int64_t OrderStateCache::getRefreshCount() const {return refreshCount;}
+
+int64_t OrderStateCache::getHitCount() const {return hitCount;}
@@ -0,0 +1,70 @@
+#ifndef ORDERSTATECACHE_H
+#define ORDERSTATECACHE_H
+
+#include "PriceTicks.h"
+#include "sierrachart.h"
+
+#include <cstdint>
+#include <unordered_map>
+
+// The fields of an s_SCTradeOrder the trade logic reads
+struct OrderSnapshot {
+    int64_t internalOrderId = 0;
+    double price1 = 0.0;
+    PriceTicks price1Ticks = 0;  // price1 in the tick domain, 0 while the order has no price yet
+    SCOrderStatusCodeEnum status = SCT_OSC_UNSPECIFIED;
+    BuySellEnum buySell = BSE_UNDEFINED;
+};
+
+struct BracketSnapshot {
+    OrderSnapshot parent;
+    OrderSnapshot stop;
+    OrderSnapshot target;
+};
+
+/*
+ * Bracket (parent, stop and target) snapshots per parent InternalOrderID, re-read with GetOrderByOrderID only when
+ * they may have changed:
+ *   - the order fill array grew (fills are what move a bracket from pending to open to done),
+ *   - a new bar started (catches changes made outside the study, e.g. from the DOM),
+ *   - the study sent something for the bracket itself (markDirty),
+ *   - one of its orders is still in a transitional state (sent, pending open/modify/cancel).
+ * Everything else is answered from the snapshot.
+ */
+class OrderStateCache {
+
+public:
+    // Current bracket of parentOrderId, false when the parent order is unknown to the trade service
+    bool getBracket(SCStudyInterfaceRef sc, int64_t parentOrderId, BracketSnapshot& bracket);
+
+    // To be called after submitting, modifying or cancelling any order of the bracket
+    void markDirty(int64_t parentOrderId);
+
+    void forget(int64_t parentOrderId);
+    void clear();
+
+    // Getters
+    [[nodiscard]] int64_t getRefreshCount() const;
+    [[nodiscard]] int64_t getHitCount() const;
+
+private:
+    struct Entry {
+        BracketSnapshot bracket;
+        uint64_t epoch = 0;
+        bool found = false;
+        bool dirty = true;
+    };
+
+    [[nodiscard]] static bool isSettled(const OrderSnapshot& order);
+    static OrderSnapshot toSnapshot(SCStudyInterfaceRef sc, const s_SCTradeOrder& order);
+    void advanceEpoch(SCStudyInterfaceRef sc);
+
+    std::unordered_map<int64_t, Entry> brackets;
+    uint64_t epoch = 1;
+    int lastFillCount = -1;
+    int lastArraySize = -1;
+    int64_t refreshCount = 0;
+    int64_t hitCount = 0;
+};
+
+#endif //ORDERSTATECACHE_H
@@ -0,0 +1,108 @@
+#include "PeakValleyIndex.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+bool priceBelow(const PeakValleyLine& line, const PriceTicks price) {return line.price < price;}
+
+bool priceAbove(const PriceTicks price, const PeakValleyLine& line) {return price < line.price;}
+
+const std::vector<PeakValleyLine> NO_LINES;
+
+}
+
+PeakValleyIndex::PeakValleyIndex(const int studyId, const int profileIndex)
+    : studyId(studyId),
+      profileIndex(profileIndex) {}
+
+void PeakValleyIndex::refresh(SCStudyInterfaceRef sc) {
+    const int arraySize = sc.ArraySize;
+    const float lastVolume = arraySize > 0 ? sc.Volume[arraySize - 1] : 0.0f;
+    if (arraySize == readArraySize && lastVolume == readVolume) {return;}
+    readArraySize = arraySize;
+    readVolume = lastVolume;
+    ++readCount;
+
+    peaks.clear();
+    valleys.clear();
+    float price = 0;
+    int type = PEAKVALLEYTYPE_NONE;
+    int startIndex = 0;
+    int extensionEndIndex = 0;
+    for (int k = 0; sc.GetStudyPeakValleyLine(sc.ChartNumber, studyId, price, type, startIndex, extensionEndIndex,
+                                              profileIndex, k) != 0; ++k) {
+        const PeakValleyLine line{toTicks(sc, price), startIndex, extensionEndIndex};
+        if (type == PEAKVALLEYTYPE_PEAK) {
+            peaks.push_back(line);
+        } else if (type == PEAKVALLEYTYPE_VALLEY) {
+            valleys.push_back(line);
+        }
+    }
+    const auto byPrice = [](const PeakValleyLine& a, const PeakValleyLine& b) {return a.price < b.price;};
+    std::sort(peaks.begin(), peaks.end(), byPrice);
+    std::sort(valleys.begin(), valleys.end(), byPrice);
+}
+
+void PeakValleyIndex::reset() {
+    peaks.clear();
+    valleys.clear();
+    readArraySize = -1;
+    readVolume = -1.0f;
+}
+
+const std::vector<PeakValleyLine>& PeakValleyIndex::linesOf(const PeakValleyTypeEnum type) const {
+    switch (type) {
+        case PEAKVALLEYTYPE_PEAK: return peaks;
+        case PEAKVALLEYTYPE_VALLEY: return valleys;
+        default: return NO_LINES;
+    }
+}
+
+std::span<const PeakValleyLine> PeakValleyIndex::lines(const PeakValleyTypeEnum type) const {return linesOf(type);}
+
+std::span<const PeakValleyLine> PeakValleyIndex::inBand(const PeakValleyTypeEnum type, const PriceTicks low,
+                                                        const PriceTicks high) const {
+    const std::vector<PeakValleyLine>& sorted = linesOf(type);
+    if (high < low) {return {};}
+    const auto first = std::lower_bound(sorted.begin(), sorted.end(), low, priceBelow);
+    const auto last = std::upper_bound(first, sorted.end(), high, priceAbove);
+    return {first, last};
+}
+
+bool PeakValleyIndex::nearestBelow(const PeakValleyTypeEnum type, const PriceTicks price, PeakValleyLine& line) const {
+    const std::vector<PeakValleyLine>& sorted = linesOf(type);
+    const auto it = std::lower_bound(sorted.begin(), sorted.end(), price, priceBelow);
+    if (it == sorted.begin()) {return false;}
+    line = *std::prev(it);
+    return true;
+}
+
+bool PeakValleyIndex::nearestAbove(const PeakValleyTypeEnum type, const PriceTicks price, PeakValleyLine& line) const {
+    const std::vector<PeakValleyLine>& sorted = linesOf(type);
+    const auto it = std::upper_bound(sorted.begin(), sorted.end(), price, priceAbove);
+    if (it == sorted.end()) {return false;}
+    line = *it;
+    return true;
+}
+
+bool PeakValleyIndex::lowest(const PeakValleyTypeEnum type, PeakValleyLine& line) const {
+    const std::vector<PeakValleyLine>& sorted = linesOf(type);
+    if (sorted.empty()) {return false;}
+    line = sorted.front();
+    return true;
+}
+
+bool PeakValleyIndex::highest(const PeakValleyTypeEnum type, PeakValleyLine& line) const {
+    const std::vector<PeakValleyLine>& sorted = linesOf(type);
+    if (sorted.empty()) {return false;}
+    line = sorted.back();
+    return true;
+}
+
+int PeakValleyIndex::getStudyId() const {return studyId;}
+
+int PeakValleyIndex::getProfileIndex() const {return profileIndex;}
+
+int64_t PeakValleyIndex::getReadCount() const {return readCount;}
@@ -0,0 +1,59 @@
+#ifndef PEAKVALLEYINDEX_H
+#define PEAKVALLEYINDEX_H
+
+#include "PriceTicks.h"
+#include "sierrachart.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+struct PeakValleyLine {
+    PriceTicks price;
+    int startIndex;
+    int extensionEndIndex;
+};
+
+/*
+ * Peak and valley lines of one volume by price profile, each kind sorted by price.
+ * The lines are re-read with GetStudyPeakValleyLine only when the chart traded since the last read (a new bar or more
+ * volume on the last one), a profile does not move otherwise. Queries are binary searches over the sorted lines.
+ */
+class PeakValleyIndex {
+
+public:
+    // profileIndex as GetStudyPeakValleyLine takes it, 0 is the most recent profile
+    PeakValleyIndex(int studyId, int profileIndex);
+
+    // Re-reads the lines when the profile may have changed, a no-op otherwise
+    void refresh(SCStudyInterfaceRef sc);
+
+    void reset();
+
+    // Getters
+    [[nodiscard]] int getStudyId() const;
+    [[nodiscard]] int getProfileIndex() const;
+    [[nodiscard]] int64_t getReadCount() const;
+    // All lines of the type, lowest price first
+    [[nodiscard]] std::span<const PeakValleyLine> lines(PeakValleyTypeEnum type) const;
+    // Lines of the type with low <= price <= high, lowest price first
+    [[nodiscard]] std::span<const PeakValleyLine> inBand(PeakValleyTypeEnum type, PriceTicks low, PriceTicks high) const;
+    // Highest line of the type strictly below price (lowest strictly above), false when there is none
+    [[nodiscard]] bool nearestBelow(PeakValleyTypeEnum type, PriceTicks price, PeakValleyLine& line) const;
+    [[nodiscard]] bool nearestAbove(PeakValleyTypeEnum type, PriceTicks price, PeakValleyLine& line) const;
+    [[nodiscard]] bool lowest(PeakValleyTypeEnum type, PeakValleyLine& line) const;
+    [[nodiscard]] bool highest(PeakValleyTypeEnum type, PeakValleyLine& line) const;
+
+private:
+    [[nodiscard]] const std::vector<PeakValleyLine>& linesOf(PeakValleyTypeEnum type) const;
+
+    const int studyId;
+    const int profileIndex;
+    std::vector<PeakValleyLine> peaks;
+    std::vector<PeakValleyLine> valleys;
+    int readArraySize = -1;
+    float readVolume = -1.0f;
+    int64_t readCount = 0;
+};
+
+#endif //PEAKVALLEYINDEX_H
@@ -0,0 +1,23 @@
+#ifndef PRICETICKS_H
+#define PRICETICKS_H
+
+#include "sierrachart.h"
+
+#include <cstdint>
+
+/*
+ * A price as a whole number of ticks of the chart's tick size. Bar and order prices are converted once where they enter
+ * the study, offsets and comparisons are then exact integer arithmetic, and ticks go back to a price only where one
+ * leaves it (an order price, a subgraph value, a log record).
+ */
+using PriceTicks = int32_t;
+
+inline PriceTicks toTicks(SCStudyInterfaceRef sc, const double price) {
+    return sc.PriceValueToTicks(static_cast<float>(price));
+}
+
+inline double toPrice(SCStudyInterfaceRef sc, const PriceTicks ticks) {
+    return sc.TicksToPriceValue(ticks);
+}
+
+#endif //PRICETICKS_H
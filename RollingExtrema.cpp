@@ -0,0 +1,40 @@
+#include "RollingExtrema.h"
+
+#include <algorithm>
+
+
+void BarExtremaRuns::update(SCStudyInterfaceRef sc, int barIndex) {
+    barIndex = std::min(barIndex, sc.ArraySize - 1);
+    // The last linked bar may have been the bar in progress, its low and high can have moved since
+    const int first = std::max(0, std::min(static_cast<int>(previousLower.size()), sc.ArraySize) - 1);
+    if (barIndex < first) {return;}
+    previousLower.resize(barIndex + 1);
+    previousHigher.resize(barIndex + 1);
+
+    for (int i = first; i <= barIndex; ++i) {
+        const float low = sc.Low[i];
+        int j = i - 1;
+        while (j >= 0 && sc.Low[j] >= low) {j = previousLower[j];}
+        previousLower[i] = j;
+
+        const float high = sc.High[i];
+        j = i - 1;
+        while (j >= 0 && sc.High[j] <= high) {j = previousHigher[j];}
+        previousHigher[i] = j;
+    }
+}
+
+void BarExtremaRuns::reset() {
+    previousLower.clear();
+    previousHigher.clear();
+}
+
+bool BarExtremaRuns::isLowestOf(const int barIndex, const int nBars) const {
+    if (barIndex < 0 || barIndex >= static_cast<int>(previousLower.size())) {return false;}
+    return barIndex - previousLower[barIndex] >= nBars || previousLower[barIndex] < 0;
+}
+
+bool BarExtremaRuns::isHighestOf(const int barIndex, const int nBars) const {
+    if (barIndex < 0 || barIndex >= static_cast<int>(previousHigher.size())) {return false;}
+    return barIndex - previousHigher[barIndex] >= nBars || previousHigher[barIndex] < 0;
+}
@@ -0,0 +1,30 @@
+#ifndef ROLLINGEXTREMA_H
+#define ROLLINGEXTREMA_H
+
+#include "sierrachart.h"
+
+#include <vector>
+
+/*
+ * BarExtremaRuns answers "is this bar the lowest/highest of the last N bars" for any N at once: for each bar it keeps
+ * the nearest previous bar that beats it (strictly lower low, strictly higher high). Those links are built by jumping
+ * along the links of the earlier bars, O(1) amortised per bar, and only the last bar's own link is redone while it fills.
+ */
+class BarExtremaRuns {
+
+public:
+    // Brings the links up to date through barIndex, the bars before the last one are only ever linked once
+    void update(SCStudyInterfaceRef sc, int barIndex);
+
+    void reset();
+
+    // Windows reaching before the first bar are clipped to the bars that exist
+    [[nodiscard]] bool isLowestOf(int barIndex, int nBars) const;
+    [[nodiscard]] bool isHighestOf(int barIndex, int nBars) const;
+
+private:
+    std::vector<int> previousLower;
+    std::vector<int> previousHigher;
+};
+
+#endif //ROLLINGEXTREMA_H
@@ -0,0 +1,93 @@
+#include "SegmentedScan.h"
+#include "CleanTickIndex.h"
+#include "helpers.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+constexpr int SCAN_BLOCK_BARS = 1 << 16;
+
+// values[i] += values[i - 1] lane by lane over [first, last)
+void continueSums(float* values, const unsigned char* resets, const int first, const int last) {
+    for (int i = first; i < last; ++i) {
+        if (resets[i]) {continue;}
+        float* bar = values + static_cast<size_t>(i) * SEGMENTED_SCAN_LANES;
+        const float* previous = bar - SEGMENTED_SCAN_LANES;
+        for (int l = 0; l < SEGMENTED_SCAN_LANES; ++l) {bar[l] = bar[l] + previous[l];}
+    }
+}
+
+// Scans the block from its first reset on and returns that bar, the head before it is left for the carry fix-up
+int scanBlock(float* values, const unsigned char* resets, const int first, const int last) {
+    const int firstReset = static_cast<int>(std::find(resets + first, resets + last, 1) - resets);
+    if (firstReset < last) {
+        continueSums(values, resets, firstReset + 1, last);
+    }
+    return firstReset;
+}
+
+}
+
+void segmentedScan(float* values, const unsigned char* resets, const int count, int threads) {
+    if (count <= 0) {return;}
+    const int blocks = (count + SCAN_BLOCK_BARS - 1) / SCAN_BLOCK_BARS;
+    if (threads <= 0) {threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));}
+    threads = std::min(threads, blocks);
+
+    std::vector<int> firstResets(blocks);
+    const auto scanBlocks = [&](const int worker) {
+        for (int b = worker; b < blocks; b += threads) {
+            const int first = b * SCAN_BLOCK_BARS;
+            firstResets[b] = scanBlock(values, resets, first, std::min(count, first + SCAN_BLOCK_BARS));
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; ++t) {workers.emplace_back(scanBlocks, t);}
+    scanBlocks(0);
+    for (std::thread& worker : workers) {worker.join();}
+
+    // Carry fix-up in bar order: each block's head continues the segment the previous block ended in
+    continueSums(values, resets, 1, firstResets[0]);
+    for (int b = 1; b < blocks; ++b) {
+        continueSums(values, resets, b * SCAN_BLOCK_BARS, firstResets[b]);
+    }
+}
+
+void cleanTickRunningSums(SCStudyInterfaceRef sc, const int cleanTicks, const std::initializer_list<RunningSum> sums) {
+    const int count = sc.ArraySize;
+    if (count <= 0) {return;}
+
+    // Same breakout price and clean test as IsCleanTick on the bar by bar path. The bars are indexed in one pass here,
+    // which the order checks of the bar by bar path then read from
+    std::vector<unsigned char> resets(count);
+    resets[0] = 1;
+    CleanTickIndex& index = getCleanTickIndex(sc);
+    for (int i = 1; i < count; ++i) {
+        const bool isDown = sc.Open[i] <= sc.Low[i - 1];
+        const PriceTicks priceOfInterest = isDown ? toTicks(sc, sc.Low[i - 1]) - cleanTicks
+                                                  : toTicks(sc, sc.High[i - 1]) + cleanTicks;
+        index.refresh(sc, i);
+        resets[i] = index.isClean(sc, i, priceOfInterest) ? 1 : 0;
+    }
+
+    // SEGMENTED_SCAN_LANES sums per scan, unused lanes stay zero
+    std::vector<float> values(static_cast<size_t>(count) * SEGMENTED_SCAN_LANES);
+    for (auto first = sums.begin(); first != sums.end();) {
+        const int lanes = static_cast<int>(std::min<size_t>(sums.end() - first, SEGMENTED_SCAN_LANES));
+        std::fill(values.begin(), values.end(), 0.0f);
+        for (int l = 0; l < lanes; ++l) {
+            const SCFloatArray& series = *first[l].in;
+            for (int i = 0; i < count; ++i) {values[static_cast<size_t>(i) * SEGMENTED_SCAN_LANES + l] = series[i];}
+        }
+        segmentedScan(values.data(), resets.data(), count);
+        for (int l = 0; l < lanes; ++l) {
+            SCFloatArray& series = *first[l].out;
+            for (int i = 0; i < count; ++i) {series[i] = values[static_cast<size_t>(i) * SEGMENTED_SCAN_LANES + l];}
+        }
+        first += lanes;
+    }
+}
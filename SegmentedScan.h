@@ -0,0 +1,31 @@
+#ifndef SEGMENTEDSCAN_H
+#define SEGMENTEDSCAN_H
+
+#include "sierrachart.h"
+
+#include <initializer_list>
+
+/*
+ * Running sums that restart on flagged bars, over the whole history at once.
+ *
+ * values holds count bars of SEGMENTED_SCAN_LANES interleaved series sharing the same reset flags, so each bar is one
+ * 4-wide vector step. Blocks are scanned on separate threads as if their first segment started from zero; the bars of
+ * each block up to its first reset are then redone in order from the previous block's last value. Every output is the
+ * same chain of float additions as the bar by bar recurrence, so the result is bit-identical to it.
+ */
+constexpr int SEGMENTED_SCAN_LANES = 4;
+
+// values[i][l] = resets[i] ? values[i][l] : values[i][l] + values[i - 1][l], bar 0 always starts a segment
+void segmentedScan(float* values, const unsigned char* resets, int count, int threads = 0);
+
+// One running sum of the flag studies, in and out may be the same array
+struct RunningSum {
+    const SCFloatArray* in;
+    SCFloatArray* out;
+};
+
+// Batch form of the clean tick running sums of the flag studies over bars [0, sc.ArraySize): a bar restarts the sums
+// when the tick cleanTicks beyond the previous bar's low (open at or below it) or high is clean
+void cleanTickRunningSums(SCStudyInterfaceRef sc, int cleanTicks, std::initializer_list<RunningSum> sums);
+
+#endif //SEGMENTEDSCAN_H
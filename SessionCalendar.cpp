@@ -0,0 +1,145 @@
+#include "SessionCalendar.h"
+
+#include <chrono>
+#include <cstdio>
+
+namespace {
+
+// SCDateTime day number of a calendar date, days since 1899-12-30
+int scDateOf(const int year, const int month, const int day) {
+    using namespace std::chrono;
+    const year_month_day date{std::chrono::year(year), std::chrono::month(static_cast<unsigned>(month)),
+                              std::chrono::day(static_cast<unsigned>(day))};
+    if (!date.ok()) {return -1;}
+    constexpr sys_days scEpoch = std::chrono::year(1899) / December / 30;
+    return static_cast<int>((sys_days(date) - scEpoch).count());
+}
+
+bool isTimeOfDay(const int hours, const int minutes) {
+    return hours >= 0 && hours <= 24 && minutes >= 0 && minutes < 60 && hours * 60 + minutes <= 24 * 60;
+}
+
+// Calls parseEntry(entry) for each comma separated entry with its surrounding blanks trimmed, returns the failures
+template <typename ParseEntry>
+int forEachEntry(const std::string& text, ParseEntry&& parseEntry) {
+    int failures = 0;
+    size_t begin = 0;
+    while (begin <= text.size()) {
+        size_t end = text.find(',', begin);
+        if (end == std::string::npos) {end = text.size();}
+        const size_t first = text.find_first_not_of(" \t", begin);
+        if (first != std::string::npos && first < end) {
+            const size_t last = text.find_last_not_of(" \t", end - 1);
+            if (!parseEntry(text.substr(first, last - first + 1))) {++failures;}
+        }
+        begin = end + 1;
+    }
+    return failures;
+}
+
+}
+
+SessionCalendar::SessionCalendar() {
+    configure("09:30-15:30", "");
+}
+
+int SessionCalendar::configure(const char* newSessions, const char* newExceptions) {
+    if (sessions == newSessions && exceptions == newExceptions) {return 0;}
+    sessions = newSessions;
+    exceptions = newExceptions;
+    windows.clear();
+    closeTimes.clear();
+    reset();
+
+    int failures = forEachEntry(sessions, [&](const std::string& entry) {
+        int startHours, startMinutes, endHours, endMinutes, consumed = 0;
+        if (std::sscanf(entry.c_str(), "%d:%d - %d:%d%n", &startHours, &startMinutes, &endHours, &endMinutes, &consumed) != 4
+            || consumed != static_cast<int>(entry.size())
+            || !isTimeOfDay(startHours, startMinutes) || !isTimeOfDay(endHours, endMinutes)) {
+            return false;
+        }
+        windows.push_back({HMS_TIME(startHours, startMinutes, 0), HMS_TIME(endHours, endMinutes, 0)});
+        return true;
+    });
+    failures += forEachEntry(exceptions, [&](const std::string& entry) {
+        int year, month, day, hours, minutes, consumed = 0;
+        const int fields = std::sscanf(entry.c_str(), "%d-%d-%d %d:%d%n", &year, &month, &day, &hours, &minutes, &consumed);
+        if (fields == 3) {
+            std::sscanf(entry.c_str(), "%d-%d-%d%n", &year, &month, &day, &consumed);
+        }
+        if ((fields != 3 && fields != 5) || consumed != static_cast<int>(entry.size())
+            || (fields == 5 && !isTimeOfDay(hours, minutes))) {
+            return false;
+        }
+        const int date = scDateOf(year, month, day);
+        if (date < 0) {return false;}
+        closeTimes[date] = fields == 5 ? HMS_TIME(hours, minutes, 0) : HOLIDAY;
+        return true;
+    });
+    return failures;
+}
+
+void SessionCalendar::extend(SCStudyInterfaceRef sc) {
+    const int count = sc.ArraySize;
+    if (count < static_cast<int>(states.size())) {reset();}
+    states.reserve(count);
+    for (int i = static_cast<int>(states.size()); i < count; ++i) {
+        const SCDateTime barStart = sc.BaseDateTimeIn[i];
+        const int64_t key = sessionKey(barStart.GetDate(), barStart.GetTime());
+        uint8_t state = key != OUT_OF_SESSION ? IN_SESSION : 0;
+        if (lastKey != OUT_OF_SESSION && key != lastKey) {
+            state |= SESSION_CLOSE;
+        }
+        lastKey = key;
+        states.push_back(state);
+    }
+}
+
+void SessionCalendar::reset() {
+    states.clear();
+    lastKey = OUT_OF_SESSION;
+    cachedDate = -1;
+    cachedCloseTime = NO_EXCEPTION;
+    claimedClose = -1;
+}
+
+bool SessionCalendar::claimClose(const int barIndex) {
+    if ((getState(barIndex) & SESSION_CLOSE) == 0 || barIndex <= claimedClose) {return false;}
+    claimedClose = barIndex;
+    return true;
+}
+
+int64_t SessionCalendar::sessionKey(const int date, const int time) {
+    const int64_t windowCount = static_cast<int64_t>(windows.size());
+    for (int64_t k = 0; k < windowCount; ++k) {
+        const Window& window = windows[k];
+        int tradingDate;
+        if (window.start < window.end) {
+            if (time < window.start || time >= window.end) {continue;}
+            tradingDate = date;
+        } else if (time >= window.start) {
+            tradingDate = date + 1;
+        } else if (time < window.end) {
+            tradingDate = date;
+        } else {
+            continue;
+        }
+        const int closeTime = closeTimeOf(tradingDate);
+        if (closeTime == HOLIDAY || (closeTime != NO_EXCEPTION && tradingDate == date && time >= closeTime)) {continue;}
+        return tradingDate * windowCount + k;
+    }
+    return OUT_OF_SESSION;
+}
+
+int SessionCalendar::closeTimeOf(const int tradingDate) {
+    if (tradingDate != cachedDate) {
+        const auto it = closeTimes.find(tradingDate);
+        cachedDate = tradingDate;
+        cachedCloseTime = it != closeTimes.end() ? it->second : NO_EXCEPTION;
+    }
+    return cachedCloseTime;
+}
+
+const std::string& SessionCalendar::getSessions() const {return sessions;}
+
+const std::string& SessionCalendar::getExceptions() const {return exceptions;}
@@ -0,0 +1,71 @@
+#ifndef SESSIONCALENDAR_H
+#define SESSIONCALENDAR_H
+
+#include "sierrachart.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Trading session state of every bar, computed once per bar from its start time and extended as bars are added.
+ *   sessions    "HH:MM-HH:MM" windows separated by commas, end exclusive. A window ending at or before its start runs
+ *               overnight and belongs to the date it ends on.
+ *   exceptions  "YYYY-MM-DD" holidays and "YYYY-MM-DD HH:MM" early closes of that trading date, separated by commas.
+ * A bar is in session when it starts inside a window of a trading date that is not a holiday, before its early close.
+ * The first bar after a session (out of session, or in the next one) is flagged as that session's close.
+ */
+class SessionCalendar {
+
+public:
+    static constexpr uint8_t IN_SESSION = 1;
+    static constexpr uint8_t SESSION_CLOSE = 2;
+
+    SessionCalendar();
+
+    // Parses a new configuration and drops the computed bars when it differs from the current one.
+    // Returns the number of entries that could not be parsed and were skipped.
+    int configure(const char* sessions, const char* exceptions);
+
+    // Computes the bars added since the last call, a no-op when there are none
+    void extend(SCStudyInterfaceRef sc);
+
+    void reset();
+
+    // True the first time it is asked for a given session close bar, so a flatten goes out once per boundary
+    bool claimClose(int barIndex);
+
+    // Getters
+    [[nodiscard]] uint8_t getState(int barIndex) const {
+        return barIndex >= 0 && barIndex < static_cast<int>(states.size()) ? states[barIndex] : 0;
+    }
+    [[nodiscard]] const std::string& getSessions() const;
+    [[nodiscard]] const std::string& getExceptions() const;
+
+private:
+    static constexpr int HOLIDAY = -1;
+    static constexpr int NO_EXCEPTION = -2;
+    static constexpr int64_t OUT_OF_SESSION = -1;
+
+    struct Window {
+        int start;  // Seconds from midnight
+        int end;
+    };
+
+    // Trading date * window count + window of the session a bar starts in, OUT_OF_SESSION outside of all of them
+    [[nodiscard]] int64_t sessionKey(int date, int time);
+    [[nodiscard]] int closeTimeOf(int tradingDate);
+
+    std::vector<Window> windows;
+    std::unordered_map<int, int> closeTimes;  // Trading date -> HOLIDAY or early close in seconds from midnight
+    std::string sessions;
+    std::string exceptions;
+    std::vector<uint8_t> states;
+    int64_t lastKey = OUT_OF_SESSION;
+    int cachedDate = -1;
+    int cachedCloseTime = NO_EXCEPTION;
+    int claimedClose = -1;
+};
+
+#endif //SESSIONCALENDAR_H
@@ -0,0 +1,61 @@
+#ifndef SIDE_H
+#define SIDE_H
+
+#include "PriceTicks.h"
+#include "sierrachart.h"
+
+#include <algorithm>
+
+/*
+ * Direction of a trade or a signal as a type. Logic written once against Side<S> compiles into a buy and a sell
+ * version with the comparisons and offset signs fixed, in place of a switch on BuySellEnum at each step. withSide()
+ * picks the version once, from the runtime direction.
+ */
+template <BuySellEnum S>
+struct Side {
+    static_assert(S == BSE_BUY || S == BSE_SELL, "Side is BSE_BUY or BSE_SELL");
+
+    static constexpr BuySellEnum direction = S;
+    static constexpr int sign = S == BSE_BUY ? 1 : -1;
+
+    // The value that belongs to this side, e.g. the high of a range for a buy
+    template <typename T>
+    static constexpr T pick(const T forBuy, const T forSell) {return S == BSE_BUY ? forBuy : forSell;}
+
+    // The further of two prices in this direction
+    template <typename T>
+    static constexpr T better(const T a, const T b) {return S == BSE_BUY ? std::max(a, b) : std::min(a, b);}
+
+    // `price` is at or past `level` in this direction
+    template <typename T>
+    static constexpr bool reached(const T price, const T level) {return S == BSE_BUY ? price >= level : price <= level;}
+
+    // Order flow at or past `threshold` against this direction, the divergence the signals trade
+    template <typename T>
+    static constexpr bool against(const T flow, const T threshold) {return reached(threshold, flow);}
+
+    static constexpr PriceTicks offset(const PriceTicks price, const PriceTicks ticks) {return price + sign * ticks;}
+
+    // Move from `from` to `to`, positive in this direction
+    static constexpr PriceTicks gain(const PriceTicks from, const PriceTicks to) {return sign * (to - from);}
+
+    // `ticks` past the edge of the high/low range in this direction
+    static constexpr PriceTicks breakout(const PriceTicks high, const PriceTicks low, const PriceTicks ticks) {
+        return offset(pick(high, low), ticks);
+    }
+};
+
+using BuySide = Side<BSE_BUY>;
+using SellSide = Side<BSE_SELL>;
+
+// Calls f(BuySide{}) or f(SellSide{}), nothing for BSE_UNDEFINED
+template <typename F>
+constexpr void withSide(const BuySellEnum direction, F&& f) {
+    switch (direction) {
+        case BSE_BUY: f(BuySide{}); break;
+        case BSE_SELL: f(SellSide{}); break;
+        case BSE_UNDEFINED: break;
+    }
+}
+
+#endif //SIDE_H
@@ -0,0 +1,191 @@
+#include "SignalBus.h"
+
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+
+using signal_bus::Header;
+using signal_bus::Slot;
+using signal_bus::RECORD_WORDS;
+
+namespace {
+
+constexpr size_t CHANNEL_BYTES = sizeof(Header) + SIGNAL_BUS_CAPACITY * sizeof(Slot);
+
+bool isCurrentLayout(const Header& header) {
+    return header.version.load(std::memory_order_acquire) == SIGNAL_BUS_VERSION
+           && std::memcmp(header.magic, SIGNAL_BUS_MAGIC, sizeof(header.magic)) == 0
+           && header.recordSize == sizeof(SignalRecord) && header.capacity == SIGNAL_BUS_CAPACITY;
+}
+
+// Bar start times to the millisecond, the same bar on two charts can differ in the last bits of its SCDateTime
+int64_t barKey(const double barDateTime) {
+    return std::llround(barDateTime * 86400000.0);
+}
+
+}
+
+std::string signalBusPath(const std::string& folder, const std::string& channel) {
+    return (std::filesystem::path(folder) / ("divergence_bus_" + channel + ".shm")).string();
+}
+
+bool SignalBusWriter::open(const std::string& channelPath) {
+    close();
+    path = channelPath;
+    if (!file.open(channelPath, MapMode::ReadWrite, CHANNEL_BYTES) || file.getSize() < CHANNEL_BYTES) {
+        file.close();
+        return false;
+    }
+    header = reinterpret_cast<Header*>(file.getData());
+    slots = reinterpret_cast<Slot*>(file.getData() + sizeof(Header));
+    if (!isCurrentLayout(*header)) {
+        // A new channel or one of another layout starts over, readers attach once the version is in place
+        header->version.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        header->published.store(0, std::memory_order_relaxed);
+        for (uint32_t k = 0; k < SIGNAL_BUS_CAPACITY; ++k) {
+            slots[k].sequence.store(0, std::memory_order_relaxed);
+        }
+        std::memcpy(header->magic, SIGNAL_BUS_MAGIC, sizeof(header->magic));
+        header->recordSize = sizeof(SignalRecord);
+        header->capacity = SIGNAL_BUS_CAPACITY;
+        header->version.store(SIGNAL_BUS_VERSION, std::memory_order_release);
+    }
+    return true;
+}
+
+void SignalBusWriter::close() {
+    file.close();
+    header = nullptr;
+    slots = nullptr;
+}
+
+void SignalBusWriter::publish(const SignalRecord& record) noexcept {
+    if (header == nullptr) {return;}
+    const uint64_t sequence = header->published.load(std::memory_order_relaxed);
+    Slot& slot = slots[sequence & (SIGNAL_BUS_CAPACITY - 1)];
+    uint64_t words[RECORD_WORDS];
+    std::memcpy(words, &record, sizeof(record));
+
+    // Odd while the words change, a reader that saw the sequence before or after this drops its copy
+    slot.sequence.store(2 * sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t k = 0; k < RECORD_WORDS; ++k) {
+        slot.words[k].store(words[k], std::memory_order_relaxed);
+    }
+    slot.sequence.store(2 * sequence + 2, std::memory_order_release);
+    header->published.store(sequence + 1, std::memory_order_release);
+}
+
+bool SignalBusWriter::isOpen() const {return header != nullptr;}
+
+const std::string& SignalBusWriter::getPath() const {return path;}
+
+uint64_t SignalBusWriter::getPublishedCount() const {
+    return header != nullptr ? header->published.load(std::memory_order_relaxed) : 0;
+}
+
+bool SignalBusReader::open(const std::string& channelPath, const bool fromNow) {
+    close();
+    path = channelPath;
+    startFromNow = fromNow;
+    cursor = 0;
+    lostCount = 0;
+    if (attach()) {return true;}
+    // Whatever the channel gets once it exists was published after this
+    startFromNow = false;
+    return false;
+}
+
+void SignalBusReader::close() {
+    file.close();
+    header = nullptr;
+    slots = nullptr;
+}
+
+bool SignalBusReader::attach() {
+    if (header != nullptr) {return true;}
+    if (path.empty() || !file.open(path, MapMode::ReadOnly)) {return false;}
+    const auto* mapped = reinterpret_cast<const Header*>(file.getData());
+    if (file.getSize() < CHANNEL_BYTES || !isCurrentLayout(*mapped)) {
+        file.close();
+        return false;
+    }
+    header = mapped;
+    slots = reinterpret_cast<const Slot*>(file.getData() + sizeof(Header));
+    const uint64_t published = header->published.load(std::memory_order_acquire);
+    if (startFromNow) {
+        cursor = published;
+    } else {
+        cursor = published > SIGNAL_BUS_CAPACITY ? published - SIGNAL_BUS_CAPACITY : 0;
+    }
+    return true;
+}
+
+bool SignalBusReader::read(const uint64_t sequence, SignalRecord& record) const {
+    const Slot& slot = slots[sequence & (SIGNAL_BUS_CAPACITY - 1)];
+    const uint64_t complete = 2 * sequence + 2;
+    if (slot.sequence.load(std::memory_order_acquire) != complete) {return false;}
+    uint64_t words[RECORD_WORDS];
+    for (size_t k = 0; k < RECORD_WORDS; ++k) {
+        words[k] = slot.words[k].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != complete) {return false;}
+    std::memcpy(&record, words, sizeof(record));
+    return true;
+}
+
+size_t SignalBusReader::poll(SignalRecord* out, const size_t maxRecords) {
+    if (!attach()) {return 0;}
+    const uint64_t published = header->published.load(std::memory_order_acquire);
+    // The channel was started over by a new writer
+    if (published < cursor) {cursor = 0;}
+    if (published - cursor > SIGNAL_BUS_CAPACITY) {
+        lostCount += published - SIGNAL_BUS_CAPACITY - cursor;
+        cursor = published - SIGNAL_BUS_CAPACITY;
+    }
+    size_t count = 0;
+    while (count < maxRecords && cursor < published) {
+        if (read(cursor, out[count])) {
+            ++count;
+        } else {
+            ++lostCount;
+        }
+        ++cursor;
+    }
+    return count;
+}
+
+bool SignalBusReader::isOpen() const {return header != nullptr;}
+
+const std::string& SignalBusReader::getPath() const {return path;}
+
+uint64_t SignalBusReader::getLostCount() const {return lostCount;}
+
+uint64_t SignalBusReader::getCursor() const {return cursor;}
+
+void SignalBusSubscriber::subscribe(const std::string& path) {
+    if (path == reader.getPath()) {return;}
+    reader.open(path);
+    latestByBar.clear();
+}
+
+void SignalBusSubscriber::update() {
+    SignalRecord batch[POLL_BATCH];
+    while (const size_t count = reader.poll(batch, POLL_BATCH)) {
+        for (size_t k = 0; k < count; ++k) {
+            latestByBar[barKey(batch[k].barDateTime)] = batch[k];
+        }
+    }
+    while (latestByBar.size() > KEEP_BARS) {
+        latestByBar.erase(latestByBar.begin());
+    }
+}
+
+const SignalRecord* SignalBusSubscriber::find(const double barDateTime) const {
+    const auto it = latestByBar.find(barKey(barDateTime));
+    return it != latestByBar.end() ? &it->second : nullptr;
+}
+
+const SignalBusReader& SignalBusSubscriber::getReader() const {return reader;}
@@ -0,0 +1,133 @@
+#ifndef SIGNALBUS_H
+#define SIGNALBUS_H
+
+#include "MappedFile.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+
+/*
+ * Per-bar signals shared between charts and processes through a memory mapped file per named channel. One writer
+ * publishes into a ring of seqlocked slots and never waits for readers. Readers poll from their own cursor, a reader
+ * that falls more than a ring behind skips ahead and counts what it lost, and a slot overwritten while being read is
+ * dropped the same way. One signal study per channel, any number of executors.
+ */
+
+// One update of a bar's signal, on the bus as is
+struct SignalRecord {
+    int64_t publishedNs;  // system_clock when published
+    double barDateTime;   // SCDateTime of the bar's start, what readers on other charts match their bars against
+    int32_t barIndex;     // On the publishing chart
+    int32_t signal;       // 1 buy, -1 sell, 0 none
+    float values[4];      // Study specific values behind the signal
+};
+static_assert(sizeof(SignalRecord) == 40, "SignalRecord is a shared memory format");
+
+constexpr char SIGNAL_BUS_MAGIC[8] = {'D', 'V', 'S', 'I', 'G', 'B', 'U', 'S'};
+constexpr uint32_t SIGNAL_BUS_VERSION = 1;
+constexpr uint32_t SIGNAL_BUS_CAPACITY = 4096;  // Records, a power of two
+
+// <folder>/divergence_bus_<channel>.shm
+std::string signalBusPath(const std::string& folder, const std::string& channel);
+
+namespace signal_bus {
+
+constexpr size_t RECORD_WORDS = sizeof(SignalRecord) / sizeof(uint64_t);
+
+struct Header {
+    char magic[8];
+    uint32_t recordSize;
+    uint32_t capacity;
+    std::atomic<uint32_t> version;  // Stored last by the writer that creates the channel
+    alignas(64) std::atomic<uint64_t> published;  // Records published since the channel was created
+};
+
+// Record n lives in slot n % capacity, its sequence is 2n + 1 while being written and 2n + 2 once complete
+struct alignas(64) Slot {
+    std::atomic<uint64_t> sequence;
+    std::atomic<uint64_t> words[RECORD_WORDS];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "The bus needs address free 64 bit atomics");
+
+}
+
+class SignalBusWriter {
+
+public:
+    // Creates the channel file or continues the channel it holds
+    bool open(const std::string& path);
+    void close();
+
+    void publish(const SignalRecord& record) noexcept;
+
+    // Getters
+    [[nodiscard]] bool isOpen() const;
+    [[nodiscard]] const std::string& getPath() const;
+    [[nodiscard]] uint64_t getPublishedCount() const;
+
+private:
+    MappedFile file;
+    std::string path;
+    signal_bus::Header* header = nullptr;
+    signal_bus::Slot* slots = nullptr;
+};
+
+class SignalBusReader {
+
+public:
+    // Attaches once the writer has created the channel, poll() retries until then. fromNow skips what is already there
+    bool open(const std::string& path, bool fromNow = false);
+    void close();
+
+    // Moves up to maxRecords of the records published since the last call into out, oldest first
+    size_t poll(SignalRecord* out, size_t maxRecords);
+
+    // Getters
+    [[nodiscard]] bool isOpen() const;
+    [[nodiscard]] const std::string& getPath() const;
+    [[nodiscard]] uint64_t getLostCount() const;
+    [[nodiscard]] uint64_t getCursor() const;
+
+private:
+    bool attach();
+    bool read(uint64_t sequence, SignalRecord& record) const;
+
+    MappedFile file;
+    std::string path;
+    bool startFromNow = false;
+    const signal_bus::Header* header = nullptr;
+    const signal_bus::Slot* slots = nullptr;
+    uint64_t cursor = 0;
+    uint64_t lostCount = 0;
+};
+
+/*
+ * Latest signal of each bar read from a channel, for an executor that looks its bars up by start time. Keeps the
+ * most recent bars only, a bar the ring no longer holds reads as no signal.
+ */
+class SignalBusSubscriber {
+
+public:
+    // Switches to another channel file, dropping what was read from the previous one
+    void subscribe(const std::string& path);
+    // Reads what was published since the last call
+    void update();
+    // nullptr when nothing was received for the bar starting at barDateTime
+    [[nodiscard]] const SignalRecord* find(double barDateTime) const;
+
+    // Getters
+    [[nodiscard]] const SignalBusReader& getReader() const;
+
+private:
+    static constexpr size_t KEEP_BARS = 2 * SIGNAL_BUS_CAPACITY;
+    static constexpr size_t POLL_BATCH = 256;
+
+    SignalBusReader reader;
+    std::map<int64_t, SignalRecord> latestByBar;  // By bar start in milliseconds
+};
+
+#endif //SIGNALBUS_H
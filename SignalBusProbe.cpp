@@ -0,0 +1,155 @@
+/*
+ * Reads or feeds a signal bus channel from outside Sierra Chart, to watch what a signal study publishes and how long
+ * records take to reach a reader in another process.
+ *
+ * Usage: divergence_bus_probe [--folder dir] [--follow] [--from-now] [--seconds S] [--csv | --quiet] channel
+ *        divergence_bus_probe [--folder dir] --publish N [--interval-us U] channel
+ *
+ * Reading prints every record received and ends with the record count, the records lost to the ring and the
+ * publish-to-receive latency percentiles. Without --follow it drains what the ring holds and exits. --publish writes
+ * N synthetic one-minute bars at U microsecond intervals, the other half of a two process test.
+ */
+
+#include "SignalBus.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct ProbeOptions {
+    std::string folder = std::filesystem::temp_directory_path().string();
+    std::string channel;
+    bool follow = false;
+    bool fromNow = false;
+    bool csv = false;
+    bool quiet = false;
+    double seconds = 0;  // 0 runs until interrupted when following
+    int64_t publishCount = 0;
+    int64_t intervalUs = 1000;
+};
+
+bool parseOptions(const int argc, char** argv, ProbeOptions& options) {
+    for (int a = 1; a < argc; ++a) {
+        const auto next = [&]() -> const char* {return a + 1 < argc ? argv[++a] : "";};
+        if (std::strcmp(argv[a], "--folder") == 0) {
+            options.folder = next();
+        } else if (std::strcmp(argv[a], "--follow") == 0) {
+            options.follow = true;
+        } else if (std::strcmp(argv[a], "--from-now") == 0) {
+            options.fromNow = true;
+        } else if (std::strcmp(argv[a], "--seconds") == 0) {
+            options.seconds = std::atof(next());
+        } else if (std::strcmp(argv[a], "--csv") == 0) {
+            options.csv = true;
+        } else if (std::strcmp(argv[a], "--quiet") == 0) {
+            options.quiet = true;
+        } else if (std::strcmp(argv[a], "--publish") == 0) {
+            options.publishCount = std::atoll(next());
+        } else if (std::strcmp(argv[a], "--interval-us") == 0) {
+            options.intervalUs = std::max<int64_t>(0, std::atoll(next()));
+        } else if (argv[a][0] == '-') {
+            std::fprintf(stderr, "Unknown option %s\n", argv[a]);
+            return false;
+        } else {
+            options.channel = argv[a];
+        }
+    }
+    if (options.channel.empty()) {
+        std::fprintf(stderr, "A channel name is required\n");
+        return false;
+    }
+    return true;
+}
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+int publish(const ProbeOptions& options, const std::string& path) {
+    SignalBusWriter bus;
+    if (!bus.open(path)) {
+        std::fprintf(stderr, "Cannot open %s\n", path.c_str());
+        return 1;
+    }
+    constexpr double MINUTE = 1.0 / 1440.0;
+    const double firstBar = 46000.0;  // 2025-12-09, any day will do
+    for (int64_t n = 0; n < options.publishCount; ++n) {
+        SignalRecord record{};
+        record.barDateTime = firstBar + static_cast<double>(n) * MINUTE;
+        record.barIndex = static_cast<int32_t>(n);
+        record.signal = static_cast<int32_t>(n % 3) - 1;
+        record.values[0] = static_cast<float>(n);
+        record.publishedNs = nowNs();
+        bus.publish(record);
+        if (options.intervalUs > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(options.intervalUs));
+        }
+    }
+    std::printf("published=%" PRIu64 " path=%s\n", bus.getPublishedCount(), path.c_str());
+    return 0;
+}
+
+int read(const ProbeOptions& options, const std::string& path) {
+    SignalBusReader bus;
+    bus.open(path, options.fromNow);
+    std::vector<int64_t> latencies;
+    SignalRecord batch[256];
+    const auto start = std::chrono::steady_clock::now();
+    const auto elapsed = [&]() {return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();};
+
+    if (options.csv && !options.quiet) {
+        std::printf("published_ns,latency_ns,bar_index,bar_time,signal,value0,value1,value2,value3\n");
+    }
+    while (true) {
+        const size_t count = bus.poll(batch, std::size(batch));
+        const int64_t received = nowNs();
+        for (size_t k = 0; k < count; ++k) {
+            const SignalRecord& r = batch[k];
+            latencies.push_back(received - r.publishedNs);
+            if (options.quiet) {continue;}
+            std::printf(options.csv ? "%" PRId64 ",%" PRId64 ",%d,%.8f,%d,%g,%g,%g,%g\n"
+                                    : "published_ns=%" PRId64 " latency_ns=%" PRId64 " bar=%d bar_time=%.8f signal=%d "
+                                      "values=%g %g %g %g\n",
+                        r.publishedNs, received - r.publishedNs, r.barIndex, r.barDateTime, r.signal, r.values[0],
+                        r.values[1], r.values[2], r.values[3]);
+        }
+        if (count > 0) {continue;}
+        if (!options.follow) {break;}
+        if (options.seconds > 0 && elapsed() >= options.seconds) {break;}
+        // Idle readers back off, a busy channel is drained without sleeping
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+
+    if (!bus.isOpen()) {
+        std::fprintf(stderr, "No channel at %s\n", path.c_str());
+        return 1;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile = [&](const double p) -> int64_t {
+        if (latencies.empty()) {return 0;}
+        return latencies[std::min(latencies.size() - 1, static_cast<size_t>(p * static_cast<double>(latencies.size())))];
+    };
+    std::fprintf(stderr, "records=%zu lost=%" PRIu64 " latency_p50_ns=%" PRId64 " latency_p99_ns=%" PRId64
+                 " latency_max_ns=%" PRId64 "\n", latencies.size(), bus.getLostCount(), percentile(0.5),
+                 percentile(0.99), latencies.empty() ? 0 : latencies.back());
+    return 0;
+}
+
+}
+
+int main(const int argc, char** argv) {
+    ProbeOptions options;
+    if (!parseOptions(argc, argv, options)) {return 2;}
+    const std::string path = signalBusPath(options.folder, options.channel);
+    return options.publishCount > 0 ? publish(options, path) : read(options, path);
+}
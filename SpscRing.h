@@ -0,0 +1,53 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/*
+ * Bounded lock-free ring for one producer thread and one consumer thread. Pushing never blocks or allocates, a full
+ * ring rejects the item. Capacity must be a power of two.
+ */
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert((Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    // Producer side
+    bool tryPush(const T& item) noexcept {
+        const size_t head = writeIndex.load(std::memory_order_relaxed);
+        if (head - cachedReadIndex == Capacity) {
+            cachedReadIndex = readIndex.load(std::memory_order_acquire);
+            if (head - cachedReadIndex == Capacity) {return false;}
+        }
+        items[head & (Capacity - 1)] = item;
+        writeIndex.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side, moves up to maxItems into out and returns how many
+    size_t popBulk(T* out, const size_t maxItems) noexcept {
+        const size_t tail = readIndex.load(std::memory_order_relaxed);
+        const size_t count = std::min(writeIndex.load(std::memory_order_acquire) - tail, maxItems);
+        for (size_t k = 0; k < count; ++k) {
+            out[k] = items[(tail + k) & (Capacity - 1)];
+        }
+        readIndex.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return readIndex.load(std::memory_order_acquire) == writeIndex.load(std::memory_order_acquire);
+    }
+
+private:
+    // Producer and consumer indices on their own cache lines
+    alignas(64) std::atomic<size_t> writeIndex{0};
+    size_t cachedReadIndex = 0;
+    alignas(64) std::atomic<size_t> readIndex{0};
+    alignas(64) std::array<T, Capacity> items{};
+};
+
+#endif //SPSCRING_H
@@ -0,0 +1,145 @@
+#include "StateSnapshot.h"
+#include "MappedFile.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+namespace {
+
+// FNV-1a, stable across runs and builds unlike std::hash
+struct KeyHash {
+    uint64_t value = 14695981039346656037ull;
+
+    void add(const void* data, const size_t size) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (size_t k = 0; k < size; ++k) {
+            value = (value ^ bytes[k]) * 1099511628211ull;
+        }
+    }
+    void add(const char* text) {add(text, std::strlen(text) + 1);}
+    template <typename T>
+    void add(const T value) {add(&value, sizeof(value));}
+};
+
+size_t snapshotBytes(const int barCount, const size_t arrayCount, const uint32_t stateSize) {
+    return sizeof(StateSnapshotHeader) + arrayCount * static_cast<size_t>(barCount) * sizeof(float) + stateSize;
+}
+
+}
+
+uint64_t stateSnapshotKey(SCStudyInterfaceRef sc, const char* studyName, const int inputCount) {
+    KeyHash hash;
+    hash.add(studyName);
+    hash.add(sc.Symbol.GetChars());
+    hash.add(sc.SecondsPerBar);
+    for (int k = 0; k < inputCount; ++k) {
+        hash.add(sc.Input[k].GetInt());
+        hash.add(sc.Input[k].GetFloat());
+        hash.add(sc.Input[k].GetString());
+    }
+    return hash.value;
+}
+
+std::string stateSnapshotPath(SCStudyInterfaceRef sc, const uint64_t key) {
+    // The symbol as a file name, e.g. ESZ6.CME or F.US.EPZ6
+    std::string symbol = sc.Symbol.GetChars();
+    for (char& c : symbol) {
+        if (c == '/' || c == '\\' || c == ':' || c == '*' || c == '?' || c == '"' || c == '<' || c == '>' || c == '|') {
+            c = '_';
+        }
+    }
+    char name[160];
+    std::snprintf(name, sizeof(name), "divergence_state_%s_%ds_%016" PRIx64 ".snap", symbol.c_str(), sc.SecondsPerBar,
+                  key);
+    return (std::filesystem::path(sc.DataFilesFolder().GetChars()) / name).string();
+}
+
+bool saveStateSnapshot(SCStudyInterfaceRef sc, const uint64_t key, const std::initializer_list<SCFloatArray*> arrays,
+                       const void* state, const uint32_t stateSize) {
+    const int barCount = sc.ArraySize - 1;
+    if (barCount <= 0) {return false;}
+    for (const SCFloatArray* array : arrays) {
+        if (array->GetArraySize() < barCount) {return false;}
+    }
+
+    // Written aside and renamed over the previous snapshot, a chart never maps a half written one
+    const std::string path = stateSnapshotPath(sc, key);
+    const std::string writing = path + ".tmp";
+    std::error_code error;
+    std::filesystem::remove(writing, error);
+    const size_t bytes = snapshotBytes(barCount, arrays.size(), stateSize);
+    {
+        MappedFile file;
+        if (!file.open(writing, MapMode::ReadWrite, bytes) || file.getSize() != bytes) {return false;}
+
+        StateSnapshotHeader header{};
+        std::memcpy(header.magic, STATE_SNAPSHOT_MAGIC, sizeof(header.magic));
+        header.version = STATE_SNAPSHOT_VERSION;
+        header.headerSize = sizeof(StateSnapshotHeader);
+        header.key = key;
+        header.barCount = barCount;
+        header.arrayCount = static_cast<int32_t>(arrays.size());
+        header.stateSize = stateSize;
+        header.lastBarClose = sc.Close[barCount - 1];
+        header.firstBarDateTime = sc.BaseDateTimeIn[0].GetAsDouble();
+        header.lastBarDateTime = sc.BaseDateTimeIn[barCount - 1].GetAsDouble();
+        std::memcpy(file.getData(), &header, sizeof(header));
+
+        auto* values = reinterpret_cast<float*>(file.getData() + sizeof(header));
+        for (SCFloatArray* array : arrays) {
+            for (int i = 0; i < barCount; ++i) {
+                values[i] = (*array)[i];
+            }
+            values += barCount;
+        }
+        if (stateSize > 0) {
+            std::memcpy(values, state, stateSize);
+        }
+        if (!file.flush()) {return false;}
+    }
+    std::filesystem::rename(writing, path, error);
+    return !error;
+}
+
+int loadStateSnapshot(SCStudyInterfaceRef sc, const uint64_t key, const std::initializer_list<SCFloatArray*> arrays,
+                      void* state, const uint32_t stateSize) {
+    MappedFile file;
+    if (!file.open(stateSnapshotPath(sc, key), MapMode::ReadOnly) || file.getSize() < sizeof(StateSnapshotHeader)) {
+        return 0;
+    }
+    StateSnapshotHeader header;
+    std::memcpy(&header, file.getData(), sizeof(header));
+    if (std::memcmp(header.magic, STATE_SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+        || header.version != STATE_SNAPSHOT_VERSION || header.headerSize != sizeof(StateSnapshotHeader)
+        || header.key != key || header.arrayCount != static_cast<int32_t>(arrays.size())
+        || header.stateSize != stateSize || header.barCount <= 0
+        || file.getSize() != snapshotBytes(header.barCount, arrays.size(), stateSize)) {
+        return 0;
+    }
+
+    // The chart must hold the snapshotted bars plus the one computed again
+    const int barCount = header.barCount;
+    if (sc.ArraySize <= barCount || sc.BaseDateTimeIn[0].GetAsDouble() != header.firstBarDateTime
+        || sc.BaseDateTimeIn[barCount - 1].GetAsDouble() != header.lastBarDateTime
+        || sc.Close[barCount - 1] != header.lastBarClose) {
+        return 0;
+    }
+    for (const SCFloatArray* array : arrays) {
+        if (array->GetArraySize() < barCount) {return 0;}
+    }
+
+    const auto* values = reinterpret_cast<const float*>(file.getData() + sizeof(header));
+    for (SCFloatArray* array : arrays) {
+        for (int i = 0; i < barCount; ++i) {
+            (*array)[i] = values[i];
+        }
+        values += barCount;
+    }
+    if (stateSize > 0) {
+        std::memcpy(state, values, stateSize);
+    }
+    return barCount;
+}
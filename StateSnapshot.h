@@ -0,0 +1,65 @@
+#ifndef STATESNAPSHOT_H
+#define STATESNAPSHOT_H
+
+#include "sierrachart.h"
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <type_traits>
+
+/*
+ * A study's state saved when the chart closes and mapped back on the next full recalculation, so a reopened chart
+ * only computes the bars added since. A snapshot holds the study's arrays up to its last finished bar and a block of
+ * study specific state, in divergence_state_<symbol>_<seconds per bar>s_<key>.snap of the data files folder. The key
+ * hashes the study, the symbol, the bar period and the inputs. A snapshot only applies while the chart still starts
+ * with the bars it was taken on (first and last snapshotted bar's time and close), and is ignored otherwise.
+ */
+
+constexpr char STATE_SNAPSHOT_MAGIC[8] = {'D', 'V', 'S', 'N', 'A', 'P', 'S', 'T'};
+constexpr uint32_t STATE_SNAPSHOT_VERSION = 1;
+
+// Followed by arrayCount arrays of barCount floats, then stateSize bytes of study state
+struct StateSnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t key;
+    int32_t barCount;
+    int32_t arrayCount;
+    uint32_t stateSize;
+    float lastBarClose;
+    double firstBarDateTime;
+    double lastBarDateTime;
+};
+static_assert(sizeof(StateSnapshotHeader) == 56, "StateSnapshotHeader is a file format");
+
+// Identity of the calling study's state: studyName, the chart's symbol and bar period, and inputs [0, inputCount)
+uint64_t stateSnapshotKey(SCStudyInterfaceRef sc, const char* studyName, int inputCount);
+
+std::string stateSnapshotPath(SCStudyInterfaceRef sc, uint64_t key);
+
+// Saves bars [0, sc.ArraySize - 1) of the arrays, the last bar can still trade and is computed again on load
+bool saveStateSnapshot(SCStudyInterfaceRef sc, uint64_t key, std::initializer_list<SCFloatArray*> arrays,
+                       const void* state, uint32_t stateSize);
+
+// Restores a snapshot that applies to the chart, returns the first bar left to compute (0 when none applies)
+int loadStateSnapshot(SCStudyInterfaceRef sc, uint64_t key, std::initializer_list<SCFloatArray*> arrays, void* state,
+                      uint32_t stateSize);
+
+template <typename State>
+bool saveStateSnapshot(SCStudyInterfaceRef sc, const uint64_t key, const std::initializer_list<SCFloatArray*> arrays,
+                       const State& state) {
+    static_assert(std::is_trivially_copyable_v<State>, "Snapshot state is saved as is");
+    return saveStateSnapshot(sc, key, arrays, &state, sizeof(State));
+}
+
+// state is left untouched when no snapshot applies
+template <typename State>
+int loadStateSnapshot(SCStudyInterfaceRef sc, const uint64_t key, const std::initializer_list<SCFloatArray*> arrays,
+                      State& state) {
+    static_assert(std::is_trivially_copyable_v<State>, "Snapshot state is saved as is");
+    return loadStateSnapshot(sc, key, arrays, &state, sizeof(State));
+}
+
+#endif //STATESNAPSHOT_H
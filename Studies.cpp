@@ -8,9 +8,18 @@
  * Anything that's related to execution, such as the price to target, the stops and limits etc. are defined in the
  * EXECUTION
  * The signal can hoewever pass information into the executor when needed
+ * An executor on another chart or in another process can read the signal from a signal bus channel (see SignalBus)
  */
 
+#include "BarChangeTracker.h"
+#include "LatencyProbe.h"
 #include "helpers.h"
+#include "SegmentedScan.h"
+#include "Side.h"
+#include "SignalBus.h"
+#include "StateSnapshot.h"
+#include "StudyArrayBindings.h"
+#include "TradeEventLog.h"
 #include "sierrachart.h"
 
 SCDLLName("DIVERGENCE TRADING MAIN")
@@ -25,11 +34,12 @@ SCSFExport scsf_StrategyBasicFlagDraft(SCStudyInterfaceRef sc) {
     SCInputRef MinCleanTicks = sc.Input[2];
     SCInputRef BuyThreshold = sc.Input[3];
     SCInputRef SellThreshold = sc.Input[4];
+    SCInputRef UseAutoLoop = sc.Input[5];
 
     SCSubgraphRef TradeSignal = sc.Subgraph[0];
 
     if (sc.SetDefaults) {
-        sc.AutoLoop = 1;
+        sc.AutoLoop = 0;
 
         sc.GraphName = "Divergence trading indicator";
 
@@ -52,42 +62,47 @@ SCSFExport scsf_StrategyBasicFlagDraft(SCStudyInterfaceRef sc) {
         SellThreshold.SetIntLimits(1, 5000);
         SellThreshold.SetInt(100);
 
+        UseAutoLoop.Name = "Use AutoLoop (one bar per call)";
+        UseAutoLoop.SetYesNo(0);
+
         TradeSignal.Name = "Enter signal";
+        return;
+    }
+    if (sc.LastCallToFunction) {
+        releaseHelperState(sc);
+        return;
     }
+    LATENCY_PROBE_STUDY(sc);
+    beginHelperUpdate(sc);
 
     // Retrieving Studies
-    SCFloatArray BidAskDiff;
-    SCFloatArray TopBarPredictor;
-    SCFloatArray LowBarPredictor;
-    sc.GetStudyArrayUsingID(BidAskDiffStudy.GetStudyID(), 0, BidAskDiff);
-    sc.GetStudyArrayUsingID(RangeBarPredictors.GetStudyID(), 0, TopBarPredictor);
-    sc.GetStudyArrayUsingID(RangeBarPredictors.GetStudyID(), 1, LowBarPredictor);
-
-    const float prevHigh = sc.High[sc.Index - 1];
-    const float prevLow = sc.Low[sc.Index - 1];
-    const float open = sc.Open[sc.Index];
-    const bool isDown = open <= prevLow;
-
-    float priceOfInterest;
-
-    if (
-        isDown
-        && BidAskDiff[sc.Index - 1] >= SellThreshold.GetFloat()
-        ) {
-        priceOfInterest = prevLow - MinCleanTicks.GetFloat() * sc.TickSize;
-        if (IsCleanTick(priceOfInterest, sc)) {
-            TradeSignal[sc.Index] = -1;
-        }
-    } else if (
-        !isDown
-        && BidAskDiff[sc.Index - 1] <= BuyThreshold.GetFloat()
-        ) {
-        priceOfInterest = prevHigh + MinCleanTicks.GetFloat() * sc.TickSize;
-        if (IsCleanTick(priceOfInterest, sc)) {
-            TradeSignal[sc.Index] = 1;
-        }
+    StudyArrayBindings& bindings = getStudyArrayBindings(sc);
+    bindings.bind(sc, {{BidAskDiffStudy.GetStudyID(), 0}});
+    SCFloatArrayRef BidAskDiff = bindings[0];
+
+    // Inputs are read once per call, not once per bar
+    const int minCleanTicks = MinCleanTicks.GetInt();
+    const float buyThreshold = BuyThreshold.GetFloat();
+    const float sellThreshold = SellThreshold.GetFloat();
+
+    forEachBarToUpdate(sc, [&](const int i) {
+        const float open = sc.Open[i];
+        const bool isDown = open <= sc.Low[i - 1];
+
+        // Bar prices enter the tick domain once, the breakout levels are exact offsets from there
+        const PriceTicks prevHigh = toTicks(sc, sc.High[i - 1]);
+        const PriceTicks prevLow = toTicks(sc, sc.Low[i - 1]);
+
+        withSide(isDown ? BSE_SELL : BSE_BUY, [&](auto side) {
+            using S = decltype(side);
+            if (S::against(BidAskDiff[i - 1], S::pick(buyThreshold, sellThreshold))
+                && IsCleanTickAtBar(sc, i, S::breakout(prevHigh, prevLow, minCleanTicks))) {
+                TradeSignal[i] = S::sign;
+            }
+        });
+    });
 
-    }
+    applyAutoLoopInput(sc, UseAutoLoop.GetYesNo());
 }
 
 SCSFExport scsf_StrategyBasicFlagTable(SCStudyInterfaceRef sc) {
@@ -99,6 +114,7 @@ SCSFExport scsf_StrategyBasicFlagTable(SCStudyInterfaceRef sc) {
     SCInputRef CumulativeThresholdSell = sc.Input[4];
     SCInputRef UseAskVBidV = sc.Input[5];
     SCInputRef VolumeEMEAWindow = sc.Input[6];
+    SCInputRef UseAutoLoop = sc.Input[7];
 
     SCSubgraphRef Grid = sc.Subgraph[0];
     SCSubgraphRef CumSumAskVBidV = sc.Subgraph[3];
@@ -116,7 +132,7 @@ SCSFExport scsf_StrategyBasicFlagTable(SCStudyInterfaceRef sc) {
     SCSubgraphRef EnterSignal = sc.Subgraph[1];
 
     if (sc.SetDefaults) {
-        sc.AutoLoop = 1;
+        sc.AutoLoop = 0;
 
         sc.GraphName = "Strategy basic flag debug";
         sc.GraphDrawType = GDT_NUMERIC_INFORMATION;
@@ -148,6 +164,9 @@ SCSFExport scsf_StrategyBasicFlagTable(SCStudyInterfaceRef sc) {
         UseAskVBidV.Name = "Use AskV - BidV";
         UseAskVBidV.SetYesNo(0);
 
+        UseAutoLoop.Name = "Use AutoLoop (one bar per call)";
+        UseAutoLoop.SetYesNo(0);
+
         Grid.Name = "Grid style";
         Grid.DrawStyle = DRAWSTYLE_LINE;
         Grid.PrimaryColor = COLOR_WHITE;
@@ -192,7 +211,14 @@ SCSFExport scsf_StrategyBasicFlagTable(SCStudyInterfaceRef sc) {
         EnterSignal.Name = "Enter signal";
         return;
     }
-    if (sc.Index == 0) {
+    if (sc.LastCallToFunction) {
+        releaseHelperState(sc);
+        return;
+    }
+    LATENCY_PROBE_STUDY(sc);
+    beginHelperUpdate(sc);
+
+    if ((sc.AutoLoop ? sc.Index : sc.UpdateStartIndex) == 0) {
         //sc.ValueFormat = sc.BaseGraphValueFormat;
 
         s_NumericInformationGraphDrawTypeConfig NumericInformationGraphDrawTypeConfig;
@@ -215,82 +241,115 @@ SCSFExport scsf_StrategyBasicFlagTable(SCStudyInterfaceRef sc) {
     }
 
 
-    // Index
-    const int i = sc.Index;
-
-    // Getting the direction of the current bar
-    const float O = sc.Open[i];
-    const float prevHigh = sc.High[i - 1];
-    const float prevLow = sc.Low[i - 1];
-    const bool isDown = (O <= prevLow);
-
-    const float priceOfInterestHigh = prevHigh + sc.TickSize * CleanTicksForCumCum.GetFloat();
-    const float priceOfInterestLow = prevLow - sc.TickSize * CleanTicksForCumCum.GetFloat();
-    const float priceOfInterestOrderHigh = prevHigh + sc.TickSize * CleanTicksForOrderSignal.GetFloat();
-    const float priceOfInterestOrderLow = prevLow - sc.TickSize * CleanTicksForOrderSignal.GetFloat();
-
     // Building the cumulative sum for difference indicators
-    SCFloatArray AskVBidV;
-    SCFloatArray TotalV;
-    SCFloatArray AskTBidT;
-    SCFloatArray UpDownT;
-    SCFloatArray MinAskVBidV;
-    SCFloatArray MaxAskVBidV;
-    int retrieveSuccess = sc.GetStudyArrayUsingID(InputStudy.GetStudyID(), 0, AskVBidV);
-    retrieveSuccess += sc.GetStudyArrayUsingID(InputStudy.GetStudyID(), 12, TotalV);
-    retrieveSuccess += sc.GetStudyArrayUsingID(InputStudy.GetStudyID(), 23, AskTBidT);
-    retrieveSuccess += sc.GetStudyArrayUsingID(InputStudy.GetStudyID(), 49, UpDownT);
-    retrieveSuccess += sc.GetStudyArrayUsingID(InputStudy.GetStudyID(), 8, MinAskVBidV);
-    retrieveSuccess += sc.GetStudyArrayUsingID(InputStudy.GetStudyID(), 7, MaxAskVBidV);
-
-    if (retrieveSuccess == 6) {
-
-        if (i == 0) {
-            // If it's the first bar, the spot and the cumulative are the same
-            CumSumAskVBidV[i] = AskVBidV[i];
-            CumSumTotalV[i] = TotalV[i];
-            CumSumAskTBidT[i] = AskTBidT[i];
-            CumSumUpDownT[i] = UpDownT[i];
-            CumMaxAskVBidV[i] = MaxAskVBidV[i];
-            CumMaxAskVBidV[i] = MaxAskVBidV[i];
-
-        } else {
-            // Otherwise we implement the cumulative logic
-            if (const float priceOfInterest = isDown ? priceOfInterestLow : priceOfInterestHigh; IsCleanTick(priceOfInterest, sc)) {
-                CumSumAskVBidV[i] = AskVBidV[i];
-                CumSumTotalV[i] = TotalV[i];
-                CumSumAskTBidT[i] = AskTBidT[i];
-                CumSumUpDownT[i] = UpDownT[i];
-            } else {
-                CumSumAskVBidV[i] = AskVBidV[i] + CumSumAskVBidV[i-1];
-                CumSumTotalV[i] = TotalV[i]; // Not cum summing this one for EMEA consistency
-                CumSumAskTBidT[i] = AskTBidT[i]+ CumSumAskTBidT[i-1];
-                CumSumUpDownT[i] = UpDownT[i] + CumSumUpDownT[i-1];
+    StudyArrayBindings& bindings = getStudyArrayBindings(sc);
+    const int inputStudyId = InputStudy.GetStudyID();
+    const bool inputsFound = bindings.bind(sc, {{inputStudyId, 0}, {inputStudyId, 12}, {inputStudyId, 23},
+                                                {inputStudyId, 49}, {inputStudyId, 8}, {inputStudyId, 7}});
+    SCFloatArrayRef AskVBidV = bindings[0];
+    SCFloatArrayRef TotalV = bindings[1];
+    SCFloatArrayRef AskTBidT = bindings[2];
+    SCFloatArrayRef UpDownT = bindings[3];
+    SCFloatArrayRef MinAskVBidV = bindings[4];
+    SCFloatArrayRef MaxAskVBidV = bindings[5];
+
+    // Inputs are read once per call, not once per bar
+    const int cleanTicksForCumCum = CleanTicksForCumCum.GetInt();
+    const int cleanTicksForOrderSignal = CleanTicksForOrderSignal.GetInt();
+    const float cumulativeThresholdBuy = CumulativeThresholdBuy.GetFloat();
+    const float cumulativeThresholdSell = CumulativeThresholdSell.GetFloat();
+    const bool useAskVBidV = UseAskVBidV.GetInt() == 1;
+    const int volumeEMEAWindow = VolumeEMEAWindow.GetInt();
+
+    // Bars [0, CumulativeBatchEnd) of the running full recalculation were summed in one pass at bar 0
+    int &CumulativeBatchEnd = sc.GetPersistentInt(1);
+
+    BarChangeTracker& barChanges = getBarChangeTracker(sc);
+
+    forEachBarToUpdate(sc, [&](const int i) {
+        // Updates of the filling bar only redo the outputs whose inputs moved
+        const uint8_t changes = barChanges.changesAt(sc, i, bindings);
+        if (changes == BAR_UNCHANGED) {return;}
+        const bool traded = (changes & BAR_TRADED) != 0;
+
+        // Getting the direction of the current bar, the rest of the bar is written once for both directions
+        const float O = sc.Open[i];
+        const BuySellEnum direction = O <= sc.Low[i - 1] ? BSE_SELL : BSE_BUY;
+
+        const PriceTicks prevHigh = toTicks(sc, sc.High[i - 1]);
+        const PriceTicks prevLow = toTicks(sc, sc.Low[i - 1]);
+
+        withSide(direction, [&](auto side) {
+            using S = decltype(side);
+            const PriceTicks priceOfInterest = S::breakout(prevHigh, prevLow, cleanTicksForCumCum);
+            const PriceTicks priceOfInterestOrder = S::breakout(prevHigh, prevLow, cleanTicksForOrderSignal);
+            const float cumulativeThreshold = S::pick(cumulativeThresholdBuy, cumulativeThresholdSell);
+
+            if (inputsFound) {
+
+                if (i == 0) {
+                    // If it's the first bar, the spot and the cumulative are the same
+                    CumSumAskVBidV[i] = AskVBidV[i];
+                    CumSumTotalV[i] = TotalV[i];
+                    CumSumAskTBidT[i] = AskTBidT[i];
+                    CumSumUpDownT[i] = UpDownT[i];
+                    CumMaxAskVBidV[i] = MaxAskVBidV[i];
+                    CumMaxAskVBidV[i] = MaxAskVBidV[i];
+
+                    CumulativeBatchEnd = 0;
+                    if (sc.IsFullRecalculation) {
+                        cleanTickRunningSums(sc, cleanTicksForCumCum, {{&AskVBidV, &CumSumAskVBidV.Data},
+                                                                       {&AskTBidT, &CumSumAskTBidT.Data},
+                                                                       {&UpDownT, &CumSumUpDownT.Data}});
+                        CumulativeBatchEnd = sc.ArraySize;
+                    }
+                } else if (sc.IsFullRecalculation && i < CumulativeBatchEnd) {
+                    CumSumTotalV[i] = TotalV[i];
+                } else {
+                    // Otherwise we implement the cumulative logic
+                    if (IsCleanTickAtBar(sc, i, priceOfInterest)) {
+                        CumSumAskVBidV[i] = AskVBidV[i];
+                        CumSumTotalV[i] = TotalV[i];
+                        CumSumAskTBidT[i] = AskTBidT[i];
+                        CumSumUpDownT[i] = UpDownT[i];
+                    } else {
+                        CumSumAskVBidV[i] = AskVBidV[i] + CumSumAskVBidV[i-1];
+                        CumSumTotalV[i] = TotalV[i]; // Not cum summing this one for EMEA consistency
+                        CumSumAskTBidT[i] = AskTBidT[i]+ CumSumAskTBidT[i-1];
+                        CumSumUpDownT[i] = UpDownT[i] + CumSumUpDownT[i-1];
+                    }
+                }
+                CumMaxAskVBidV[i] = MaxAskVBidV[i];
+                CumMinAskVBidV[i] = MinAskVBidV[i];
+                MinMaxDiff[i] = MaxAskVBidV[i] + MinAskVBidV[i];
+                FracSignedImbalance[i] = CumSumAskVBidV[i] / TotalV[i];
+                if (traded) {
+                    sc.ExponentialMovAvg(sc.Volume, VolEMEA, i, volumeEMEAWindow);
+                }
             }
-        }
-        CumMaxAskVBidV[i] = MaxAskVBidV[i];
-        CumMinAskVBidV[i] = MinAskVBidV[i];
-        MinMaxDiff[i] = MaxAskVBidV[i] + MinAskVBidV[i];
-        FracSignedImbalance[i] = CumSumAskVBidV[i] / TotalV[i];
-        sc.ExponentialMovAvg(sc.Volume, VolEMEA, VolumeEMEAWindow.GetInt());
-    }
 
-    colorAllSubGraphs(sc, i, CumSumAskVBidV, CumSumAskTBidT, CumSumUpDownT, MinMaxDiff);
+            colorAllSubGraphs(sc, i, CumSumAskVBidV, CumSumAskTBidT, CumSumUpDownT, MinMaxDiff);
 
 
-    //Building the Up / Down clean flag
-    const int isCleanOrder = isDown ? static_cast<int>(IsCleanTick(priceOfInterestOrderLow, sc)): static_cast<int>(IsCleanTick(priceOfInterestOrderHigh, sc));
-    UpOrDownCLean[i] = isCleanOrder;
+            // The clean flag and the entry flag only read the VAP ladder and finished bars
+            if (traded) {
+                //Building the Up / Down clean flag
+                const int isCleanOrder = static_cast<int>(IsCleanTickAtBar(sc, i, priceOfInterestOrder));
+                UpOrDownCLean[i] = isCleanOrder;
 
-    // Building the order entry flag
-    int orderEntryFlag = 0;
-    if (isDown && isCleanOrder == 1 && (UseAskVBidV.GetInt() == 1 ?CumSumAskVBidV[i-1]:CumSumUpDownT[i-1]) >= CumulativeThresholdSell.GetFloat()) {
-        orderEntryFlag = -1;
-    } else if (!isDown && isCleanOrder == 1 && (UseAskVBidV.GetInt() == 1 ?CumSumAskVBidV[i-1]:CumSumUpDownT[i-1]) <= CumulativeThresholdBuy.GetFloat()) {
-        orderEntryFlag = 1;
-    }
+                // Building the order entry flag
+                int orderEntryFlag = 0;
+                if (isCleanOrder == 1 && S::against(useAskVBidV ? CumSumAskVBidV[i-1] : CumSumUpDownT[i-1], cumulativeThreshold)) {
+                    orderEntryFlag = S::sign;
+                }
+
+                EnterSignal[i] = orderEntryFlag;
+            }
+        });
+        barChanges.settle(sc, i, bindings);
+    });
 
-    EnterSignal[i] = orderEntryFlag;
+    applyAutoLoopInput(sc, UseAutoLoop.GetYesNo());
 }
 
 SCSFExport scsf_StrategyBasicFlag(SCStudyInterfaceRef sc) {
@@ -304,6 +363,9 @@ SCSFExport scsf_StrategyBasicFlag(SCStudyInterfaceRef sc) {
     SCInputRef UseAskVBidVAndUpDownT = sc.Input[6];
 
     SCInputRef VolumeEMEAWindow = sc.Input[7];
+    SCInputRef UseAutoLoop = sc.Input[8];
+    SCInputRef SignalBusChannel = sc.Input[9];
+    SCInputRef UseStateSnapshot = sc.Input[10];
 
     SCSubgraphRef EnterSignal = sc.Subgraph[0];
     SCSubgraphRef CumSumAskVBidV = sc.Subgraph[1];
@@ -311,7 +373,7 @@ SCSFExport scsf_StrategyBasicFlag(SCStudyInterfaceRef sc) {
 
 
     if (sc.SetDefaults) {
-        sc.AutoLoop = 1;
+        sc.AutoLoop = 0;
 
         sc.GraphName = "Strategy basic flag";
 
@@ -345,76 +407,142 @@ SCSFExport scsf_StrategyBasicFlag(SCStudyInterfaceRef sc) {
         UseAskVBidVAndUpDownT.Name = "Use (AskV - BidV) or (UpT - DownT vol diff)";
         UseAskVBidVAndUpDownT.SetYesNo(1);
 
+        UseAutoLoop.Name = "Use AutoLoop (one bar per call)";
+        UseAutoLoop.SetYesNo(0);
+
+        SignalBusChannel.Name = "Publish to signal bus channel (empty: off)";
+        SignalBusChannel.SetString("");
+
+        UseStateSnapshot.Name = "Resume from the state saved when the chart closed";
+        UseStateSnapshot.SetYesNo(0);
+
         EnterSignal.Name = "Enter signal";
         CumSumAskVBidV.Name = "CumSumAskVBidV";
         CumSumUpDownTVolDiff.Name = "CumSumUpDownTVolDiff";
 
         return;
     }
-    // Result of the study (-1 or 1)
-    int orderEntryFlag = 0;
-
-    // Index
-    const int i = sc.Index;
-
-    // Getting the direction of the current bar
-    const float O = sc.Open[i];
-    const float prevHigh = sc.High[i - 1];
-    const float prevLow = sc.Low[i - 1];
-    const bool isDown = (O <= prevLow);
-
-    const float priceOfInterestHigh = prevHigh + sc.TickSize * CleanTicksForCumCum.GetFloat();
-    const float priceOfInterestLow = prevLow - sc.TickSize * CleanTicksForCumCum.GetFloat();
-    const float priceOfInterestOrderHigh = prevHigh + sc.TickSize * CleanTicksForOrderSignal.GetFloat();
-    const float priceOfInterestOrderLow = prevLow - sc.TickSize * CleanTicksForOrderSignal.GetFloat();
-
-    SCFloatArray MinAskVBidV;
-    SCFloatArray MaxAskVBidV;
-
-    int retrieveSuccess = sc.GetStudyArrayUsingID(InputStudy.GetStudyID(), 0, EnterSignal.Arrays[0]); // AskV - BidV
-    // retrieveSuccess += sc.GetStudyArrayUsingID(InputStudy.GetStudyID(), 12, EnterSignal.Arrays[1]); // Total V
-    // retrieveSuccess += sc.GetStudyArrayUsingID(InputStudy.GetStudyID(), 23, EnterSignal.Arrays[2]); // AskT - BidT
-    retrieveSuccess += sc.GetStudyArrayUsingID(InputStudy.GetStudyID(), 49, EnterSignal.Arrays[1]); // UpDownT
-    // retrieveSuccess += sc.GetStudyArrayUsingID(InputStudy.GetStudyID(), 8, MinAskVBidV);
-    // retrieveSuccess += sc.GetStudyArrayUsingID(InputStudy.GetStudyID(), 7, MaxAskVBidV);
-
-    if (retrieveSuccess == 2) {
-            if (const float priceOfInterest = isDown ? priceOfInterestLow : priceOfInterestHigh; !IsCleanTick(priceOfInterest, sc)) {
-                EnterSignal.Arrays[0][i] += EnterSignal.Arrays[0][i-1];
-                // EnterSignal.Arrays[1][i] += EnterSignal.Arrays[1][i-1]; // We don't sum total Volume as this would falsify EMEA
-                // EnterSignal.Arrays[2][i] += EnterSignal.Arrays[2][i-1];
-                EnterSignal.Arrays[1][i] += EnterSignal.Arrays[1][i-1];
-            }
-        // EnterSignal.Arrays[4][i] = MaxAskVBidV[i] + MinAskVBidV[i];
+    // Every input but UseStateSnapshot shapes the state
+    const auto snapshotKey = [&] {return stateSnapshotKey(sc, "StrategyBasicFlag", 10);};
+    if (sc.LastCallToFunction) {
+        if (UseStateSnapshot.GetYesNo()) {
+            saveStateSnapshot(sc, snapshotKey(),
+                              {&EnterSignal.Data, &CumSumAskVBidV.Data, &CumSumUpDownTVolDiff.Data}, nullptr, 0);
+        }
+        releaseHelperState(sc);
+        return;
     }
-
-    // sc.ExponentialMovAvg(sc.Volume, EnterSignal.Arrays[2], VolumeEMEAWindow.GetInt());
-
-    const int isCleanOrder = isDown ? static_cast<int>(IsCleanTick(priceOfInterestOrderLow, sc)): static_cast<int>(IsCleanTick(priceOfInterestOrderHigh, sc));
-    if (isDown && isCleanOrder) {
-        if (UseAskVBidVAndUpDownT.GetInt() == 1) {
-            orderEntryFlag = EnterSignal.Arrays[0][i-1] >= CumulativeThresholdSell.GetFloat() | EnterSignal.Arrays[3][i-1] >= CumulativeThresholdSell.GetFloat() ? -1: 0;
-        } else if (UseAskVBidV.GetInt() == 1 ) {
-            orderEntryFlag = EnterSignal.Arrays[0][i-1] >= CumulativeThresholdSell.GetFloat() ? -1: 0;
-        } else {
-            orderEntryFlag = EnterSignal.Arrays[3][i-1] >= CumulativeThresholdSell.GetFloat() ? -1: 0;
+    LATENCY_PROBE_STUDY(sc);
+    beginHelperUpdate(sc);
+
+    // The running sums are accumulated in this study's subgraphs, the input study's arrays are only read
+    StudyArrayBindings& bindings = getStudyArrayBindings(sc);
+    const bool inputsFound = bindings.bind(sc, {{InputStudy.GetStudyID(), 0},    // AskV - BidV
+                                                {InputStudy.GetStudyID(), 49}}); // UpDownT
+    SCFloatArrayRef AskVBidV = bindings[0];
+    SCFloatArrayRef UpDownT = bindings[1];
+
+    // Inputs are read once per call, not once per bar
+    const int cleanTicksForCumCum = CleanTicksForCumCum.GetInt();
+    const int cleanTicksForOrderSignal = CleanTicksForOrderSignal.GetInt();
+    const float cumulativeThresholdBuy = CumulativeThresholdBuy.GetFloat();
+    const float cumulativeThresholdSell = CumulativeThresholdSell.GetFloat();
+    const bool useAskVBidV = UseAskVBidV.GetInt() == 1;
+    const bool useAskVBidVAndUpDownT = UseAskVBidVAndUpDownT.GetInt() == 1;
+
+    // Bars [0, CumulativeBatchEnd) of the running full recalculation were summed in one pass at bar 0
+    int &CumulativeBatchEnd = sc.GetPersistentInt(1);
+    // Bars [0, ResumeFromBar) of the running full recalculation were restored from the state snapshot
+    int &ResumeFromBar = sc.GetPersistentInt(2);
+
+    // The snapshot holds the sums as of the previous session
+    if (isFullRecalculationStart(sc)) {
+        CumulativeBatchEnd = 0;
+        ResumeFromBar = 0;
+        if (inputsFound && UseStateSnapshot.GetYesNo()) {
+            ResumeFromBar = loadStateSnapshot(sc, snapshotKey(),
+                                              {&EnterSignal.Data, &CumSumAskVBidV.Data, &CumSumUpDownTVolDiff.Data},
+                                              nullptr, 0);
         }
     }
 
-    if (!isDown && isCleanOrder) {
-        if (UseAskVBidVAndUpDownT.GetInt() == 1) {
-            orderEntryFlag = EnterSignal.Arrays[0][i-1] <= CumulativeThresholdBuy.GetFloat() | EnterSignal.Arrays[3][i-1] <= CumulativeThresholdBuy.GetFloat() ? 1: 0;
-        } else if (UseAskVBidV.GetInt() == 1 ) {
-            orderEntryFlag = EnterSignal.Arrays[0][i-1] <= CumulativeThresholdBuy.GetFloat() ? 1: 0;
-        } else {
-            orderEntryFlag = EnterSignal.Arrays[3][i-1] <= CumulativeThresholdBuy.GetFloat() ? 1: 0;
+    BarChangeTracker& barChanges = getBarChangeTracker(sc);
+
+    // Executors on other charts or processes read the signal from the bus instead of this chart's arrays
+    const char* channel = SignalBusChannel.GetString();
+    SignalBusWriter* bus = channel[0] != '\0' ? &getSignalBusWriter(sc, channel) : nullptr;
+    // The bus holds the most recent bars only, a full recalculation publishes those, restored ones included
+    const int firstBusBar = sc.ArraySize - static_cast<int>(SIGNAL_BUS_CAPACITY);
+    if (bus != nullptr && isFullRecalculationStart(sc)) {
+        for (int i = std::max(0, firstBusBar); i < ResumeFromBar; ++i) {
+            publishSignal(sc, *bus, i, EnterSignal[i], {CumSumAskVBidV[i], CumSumUpDownTVolDiff[i]});
         }
     }
 
-    EnterSignal[i] = static_cast<float>(orderEntryFlag);
-    CumSumAskVBidV[i] = EnterSignal.Arrays[0][i];
-    CumSumUpDownTVolDiff[i] = EnterSignal.Arrays[1][i];
+    forEachBarToUpdate(sc, [&](const int i) {
+        // Nothing to redo while neither the bar's trades nor the input study moved, the sums are already in place
+        const uint8_t changes = barChanges.changesAt(sc, i, bindings);
+        if (changes == BAR_UNCHANGED) {return;}
 
+        // Result of the study (-1 or 1)
+        int orderEntryFlag = 0;
+
+        // Getting the direction of the current bar, the rest of the bar is written once for both directions
+        const float O = sc.Open[i];
+        const BuySellEnum direction = O <= sc.Low[i - 1] ? BSE_SELL : BSE_BUY;
+
+        const PriceTicks prevHigh = toTicks(sc, sc.High[i - 1]);
+        const PriceTicks prevLow = toTicks(sc, sc.Low[i - 1]);
+
+        withSide(direction, [&](auto side) {
+            using S = decltype(side);
+            const PriceTicks priceOfInterest = S::breakout(prevHigh, prevLow, cleanTicksForCumCum);
+            const PriceTicks priceOfInterestOrder = S::breakout(prevHigh, prevLow, cleanTicksForOrderSignal);
+            const float cumulativeThreshold = S::pick(cumulativeThresholdBuy, cumulativeThresholdSell);
+
+            if (i == 0) {
+                CumulativeBatchEnd = 0;
+            }
+
+            if (inputsFound && i == 0 && sc.IsFullRecalculation) {
+                cleanTickRunningSums(sc, cleanTicksForCumCum, {{&AskVBidV, &CumSumAskVBidV.Data},
+                                                               {&UpDownT, &CumSumUpDownTVolDiff.Data}});
+                CumulativeBatchEnd = sc.ArraySize;
+            } else if (inputsFound && !(sc.IsFullRecalculation && i < CumulativeBatchEnd)) {
+                    // Summed again from the raw inputs on every change of the bar
+                    CumSumAskVBidV[i] = AskVBidV[i];
+                    CumSumUpDownTVolDiff[i] = UpDownT[i];
+                    if (!IsCleanTickAtBar(sc, i, priceOfInterest)) {
+                        CumSumAskVBidV[i] += CumSumAskVBidV[i-1];
+                        // EnterSignal.Arrays[1][i] += EnterSignal.Arrays[1][i-1]; // We don't sum total Volume as this would falsify EMEA
+                        // EnterSignal.Arrays[2][i] += EnterSignal.Arrays[2][i-1];
+                        CumSumUpDownTVolDiff[i] += CumSumUpDownTVolDiff[i-1];
+                    }
+                // EnterSignal.Arrays[4][i] = MaxAskVBidV[i] + MinAskVBidV[i];
+            }
+
+            // sc.ExponentialMovAvg(sc.Volume, EnterSignal.Arrays[2], VolumeEMEAWindow.GetInt());
+
+            const int isCleanOrder = static_cast<int>(IsCleanTickAtBar(sc, i, priceOfInterestOrder));
+            if (isCleanOrder) {
+                if (useAskVBidVAndUpDownT) {
+                    orderEntryFlag = S::against(CumSumAskVBidV[i-1], cumulativeThreshold) | S::against(EnterSignal.Arrays[3][i-1], cumulativeThreshold) ? S::sign : 0;
+                } else if (useAskVBidV) {
+                    orderEntryFlag = S::against(CumSumAskVBidV[i-1], cumulativeThreshold) ? S::sign : 0;
+                } else {
+                    orderEntryFlag = S::against(EnterSignal.Arrays[3][i-1], cumulativeThreshold) ? S::sign : 0;
+                }
+            }
+
+            EnterSignal[i] = static_cast<float>(orderEntryFlag);
+        });
+        if (bus != nullptr && i >= firstBusBar) {
+            publishSignal(sc, *bus, i, EnterSignal[i], {CumSumAskVBidV[i], CumSumUpDownTVolDiff[i]});
+        }
+        barChanges.settle(sc, i, bindings);
+    }, ResumeFromBar);
+
+    applyAutoLoopInput(sc, UseAutoLoop.GetYesNo());
 }
 
 
@@ -427,6 +555,10 @@ SCSFExport scsf_StrategyBasicPeakTypeVolumeExec(SCStudyInterfaceRef sc) {
     SCInputRef RangeBarPredictors = sc.Input[1];
     SCInputRef VolumeEMEAWindow = sc.Input[2];
     SCInputRef AllowTradingAlways = sc.Input[3];
+    SCInputRef TradingSessions = sc.Input[4];
+    SCInputRef SessionExceptions = sc.Input[5];
+    SCInputRef SignalBusChannel = sc.Input[6];
+    SCInputRef UseStateSnapshot = sc.Input[7];
 
 
 
@@ -451,11 +583,47 @@ SCSFExport scsf_StrategyBasicPeakTypeVolumeExec(SCStudyInterfaceRef sc) {
         AllowTradingAlways.Name = "Allow trading always";
         AllowTradingAlways.SetYesNo(0);
 
+        TradingSessions.Name = "Trading sessions (HH:MM-HH:MM, comma separated)";
+        TradingSessions.SetString("09:30-15:30");
+
+        SessionExceptions.Name = "Holidays and early closes (YYYY-MM-DD [HH:MM], comma separated)";
+        SessionExceptions.SetString("");
+
+        SignalBusChannel.Name = "Signal bus channel (empty: read the Trading Signal study)";
+        SignalBusChannel.SetString("");
+
+        UseStateSnapshot.Name = "Resume from the state saved when the chart closed";
+        UseStateSnapshot.SetYesNo(0);
+
         TradeId.Name = "Trade ID";
 
         RangeBarPredictors.Name = "Range bar predictor study";
         RangeBarPredictors.SetStudyID(0);
+        return;
     }
+    // Retrieving ID
+    int64_t &InternalOrderID = sc.GetPersistentInt64(1);
+
+    // Every input but UseStateSnapshot shapes the state, the volume EMA is the only array carried from bar to bar
+    const auto snapshotKey = [&] {return stateSnapshotKey(sc, "StrategyBasicPeakTypeVolumeExec", 7);};
+    if (sc.LastCallToFunction) {
+        if (UseStateSnapshot.GetYesNo()) {
+            saveStateSnapshot(sc, snapshotKey(), {&TradeId.Data, &TradeId.Arrays[0]}, InternalOrderID);
+        }
+        releaseHelperState(sc);
+        return;
+    }
+    LATENCY_PROBE_STUDY(sc);
+    beginHelperUpdate(sc, true);
+
+    // Bars [0, ResumeFromBar) of the running full recalculation were restored from the state snapshot
+    int &ResumeFromBar = sc.GetPersistentInt(1);
+    if (isFullRecalculationStart(sc)) {
+        ResumeFromBar = UseStateSnapshot.GetYesNo()
+            ? loadStateSnapshot(sc, snapshotKey(), {&TradeId.Data, &TradeId.Arrays[0]}, InternalOrderID)
+            : 0;
+    }
+    if (sc.Index < ResumeFromBar) {return;}
 
     // Common study specs
     s_SCNewOrder NewOrder;
@@ -463,40 +631,59 @@ SCSFExport scsf_StrategyBasicPeakTypeVolumeExec(SCStudyInterfaceRef sc) {
     NewOrder.OrderType = SCT_ORDERTYPE_LIMIT;
     NewOrder.TimeInForce = SCT_TIF_DAY;
 
-    // Retrieving ID
-    int64_t &InternalOrderID = sc.GetPersistentInt64(1);
-
     // Trading allowed bool
+    configureSessionCalendar(sc, TradingSessions.GetString(), SessionExceptions.GetString());
     bool TradingAllowed = AllowTradingAlways.GetInt() == 1 ? true : tradingAllowedCash(sc);
 
 
     const int i = sc.Index;
-    double peakMin;
-    double peakMax;
-    highLowCleanPricesInBar(sc, peakMin, peakMax);
 
-    // Retrieving Studies
-    SCFloatArray SignalValue;
-    SCFloatArray ASkVBidV;
-    SCFloatArray UpDownTVolDiff;
-
-    SCFloatArray TopBarPredictor;
-    SCFloatArray LowBarPredictor;
-    sc.GetStudyArrayUsingID(Signal.GetStudyID(), 0, SignalValue);
-    sc.GetStudyArrayUsingID(Signal.GetStudyID(), 1, ASkVBidV);
-    sc.GetStudyArrayUsingID(Signal.GetStudyID(), 2, UpDownTVolDiff);
+    // Retrieving Studies, the signal comes from the bus when a channel is set (bars matched by start time)
+    const char* channel = SignalBusChannel.GetString();
+    const bool signalFromBus = channel[0] != '\0';
+    StudyArrayBindings& bindings = getStudyArrayBindings(sc);
+    if (signalFromBus) {
+        bindings.bind(sc, {{RangeBarPredictors.GetStudyID(), 0}, {RangeBarPredictors.GetStudyID(), 1}});
+    } else {
+        bindings.bind(sc, {{RangeBarPredictors.GetStudyID(), 0}, {RangeBarPredictors.GetStudyID(), 1},
+                           {Signal.GetStudyID(), 0}, {Signal.GetStudyID(), 1}, {Signal.GetStudyID(), 2}});
+    }
+    SCFloatArrayRef TopBarPredictor = bindings[0];
+    SCFloatArrayRef LowBarPredictor = bindings[1];
+
+    float SignalValue = 0;
+    float ASkVBidV = 0;
+    float UpDownTVolDiff = 0;
+    if (signalFromBus) {
+        SignalBusSubscriber& bus = getSignalBusSubscriber(sc, channel);
+        bus.update();
+        if (const SignalRecord* record = bus.find(sc.BaseDateTimeIn[i].GetAsDouble()); record != nullptr) {
+            SignalValue = static_cast<float>(record->signal);
+            ASkVBidV = record->values[0];
+            UpDownTVolDiff = record->values[1];
+        }
+    } else {
+        SignalValue = bindings[2][i];
+        ASkVBidV = bindings[3][i];
+        UpDownTVolDiff = bindings[4][i];
+    }
 
-    sc.GetStudyArrayUsingID(RangeBarPredictors.GetStudyID(), 0, TopBarPredictor);
-    sc.GetStudyArrayUsingID(RangeBarPredictors.GetStudyID(), 1, LowBarPredictor);
+    // The volume EMA only moves with the bar's trades. The entry decision is still taken on every update, an order
+    // refused earlier on the same inputs can go through once the position changed
+    BarChangeTracker& barChanges = getBarChangeTracker(sc);
+    const uint8_t changes = barChanges.changesAt(sc, i, bindings);
+    barChanges.settle(sc, i, bindings);
 
-    sc.ExponentialMovAvg(sc.Volume, TradeId.Arrays[0], VolumeEMEAWindow.GetInt());
+    if (changes & BAR_TRADED) {
+        sc.ExponentialMovAvg(sc.Volume, TradeId.Arrays[0], VolumeEMEAWindow.GetInt());
+    }
 
-    const int allGreen = (ASkVBidV[i] > 0 && UpDownTVolDiff[i] > 0) ? 1 : 0;
-    const int allRed = (ASkVBidV[i] < 0 && UpDownTVolDiff[i] < 0) ? 1 : 0;
+    const int allGreen = (ASkVBidV > 0 && UpDownTVolDiff > 0) ? 1 : 0;
+    const int allRed = (ASkVBidV < 0 && UpDownTVolDiff < 0) ? 1 : 0;
     const bool volCondition = TradeId.Arrays[0][i] * 0.5 <= sc.Volume[i];
 
-    const bool buyCondition = allGreen && SignalValue[i] == 1 && volCondition && TradingAllowed;
-    const bool sellCondition = allRed && SignalValue[i] == -1 && volCondition && TradingAllowed;
+    const bool buyCondition = allGreen && SignalValue == 1 && volCondition && TradingAllowed;
+    const bool sellCondition = allRed && SignalValue == -1 && volCondition && TradingAllowed;
     int orderSubmitted = 0;
 
     if (buyCondition) {
@@ -504,13 +691,14 @@ SCSFExport scsf_StrategyBasicPeakTypeVolumeExec(SCStudyInterfaceRef sc) {
         NewOrder.Target1Price = std::max<double>(NewOrder.Price1 + sc.TickSize * 3, TopBarPredictor[i]);
         NewOrder.Stop1Offset = sc.TickSize * 3;
 
-        orderSubmitted = static_cast<int>(sc.BuyOrder(NewOrder));
+        {
+            LATENCY_PROBE("sc.BuyOrder");
+            orderSubmitted = static_cast<int>(sc.BuyOrder(NewOrder));
+        }
         if (orderSubmitted > 0) {
             InternalOrderID = NewOrder.InternalOrderID;
             sc.Subgraph[0][sc.Index] = static_cast<float>(InternalOrderID);
-            SCString Buffer;
-            Buffer.Format("ADDED ORDER WITH ID %d", InternalOrderID);
-            sc.AddMessageToLog(Buffer, 1);
+            logTradeEvent(sc, TradeEventType::OrderSubmitted, sc.Index, InternalOrderID, NewOrder.Price1);
         }
     }
     else if (sellCondition) {
@@ -518,13 +706,14 @@ SCSFExport scsf_StrategyBasicPeakTypeVolumeExec(SCStudyInterfaceRef sc) {
         NewOrder.Target1Price = std::min<double>(NewOrder.Price1 - sc.TickSize * 3, LowBarPredictor[i]);
         NewOrder.Stop1Offset = sc.TickSize * 3;
 
-        orderSubmitted = static_cast<int>(sc.SellOrder(NewOrder));
+        {
+            LATENCY_PROBE("sc.SellOrder");
+            orderSubmitted = static_cast<int>(sc.SellOrder(NewOrder));
+        }
         if (orderSubmitted > 0) {
             InternalOrderID = NewOrder.InternalOrderID;
             sc.Subgraph[0][sc.Index] = static_cast<float>(InternalOrderID);
-            SCString Buffer;
-            Buffer.Format("ADDED ORDER WITH ID %d", InternalOrderID);
-            sc.AddMessageToLog(Buffer, 1);
+            logTradeEvent(sc, TradeEventType::OrderSubmitted, sc.Index, InternalOrderID, NewOrder.Price1);
         }
     }
 }
\ No newline at end of file
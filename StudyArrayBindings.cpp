@@ -0,0 +1,51 @@
+#include "StudyArrayBindings.h"
+
+
+bool StudyArrayBindings::sameKeys(const std::initializer_list<StudyArrayKey> requested) const {
+    if (static_cast<int>(requested.size()) != count) {return false;}
+    int slot = 0;
+    for (const StudyArrayKey& key : requested) {
+        if (key.studyId != keys[slot].studyId || key.subgraphIndex != keys[slot].subgraphIndex) {return false;}
+        ++slot;
+    }
+    return true;
+}
+
+bool StudyArrayBindings::bind(SCStudyInterfaceRef sc, const std::initializer_list<StudyArrayKey> requested) {
+    const bool keysKept = sameKeys(requested);
+    if (keysKept && boundArraySize == sc.ArraySize) {return found;}
+
+    count = 0;
+    found = true;
+    for (const StudyArrayKey& key : requested) {
+        if (count == MAX_BINDINGS) {
+            found = false;
+            break;
+        }
+        keys[count] = key;
+        arrays[count] = SCFloatArray();
+        if (sc.GetStudyArrayUsingID(key.studyId, key.subgraphIndex, arrays[count]) == 0) {
+            found = false;
+            if (!keysKept) {
+                SCString Buffer;
+                Buffer.Format("Study array not found: study ID %d, subgraph %d", key.studyId, key.subgraphIndex + 1);
+                sc.AddMessageToLog(Buffer, 1);
+            }
+        }
+        ++count;
+    }
+    boundArraySize = sc.ArraySize;
+    return found;
+}
+
+void StudyArrayBindings::invalidate() {
+    count = 0;
+    boundArraySize = -1;
+    found = false;
+}
+
+SCFloatArrayRef StudyArrayBindings::operator[](const int slot) {return arrays[slot];}
+
+bool StudyArrayBindings::allFound() const {return found;}
+
+int StudyArrayBindings::getCount() const {return count;}
@@ -0,0 +1,44 @@
+#ifndef STUDYARRAYBINDINGS_H
+#define STUDYARRAYBINDINGS_H
+
+#include "sierrachart.h"
+
+#include <array>
+#include <initializer_list>
+
+struct StudyArrayKey {
+    int studyId;
+    int subgraphIndex;
+};
+
+/*
+ * Upstream study arrays of one study instance, resolved with GetStudyArrayUsingID only when something could have
+ * moved them: other (study ID, subgraph) pairs, a new chart size or an explicit invalidate() (full recalculation).
+ * Between those the views handed out by operator[] stay the same for every bar and tick of the update.
+ */
+class StudyArrayBindings {
+
+public:
+    static constexpr int MAX_BINDINGS = 8;
+
+    // Rebinds when needed, true when every requested array exists. A missing one is logged once per set of keys
+    bool bind(SCStudyInterfaceRef sc, std::initializer_list<StudyArrayKey> requested);
+
+    void invalidate();
+
+    // Getters
+    [[nodiscard]] SCFloatArrayRef operator[](int slot);
+    [[nodiscard]] bool allFound() const;
+    [[nodiscard]] int getCount() const;
+
+private:
+    [[nodiscard]] bool sameKeys(std::initializer_list<StudyArrayKey> requested) const;
+
+    std::array<StudyArrayKey, MAX_BINDINGS> keys{};
+    std::array<SCFloatArray, MAX_BINDINGS> arrays;
+    int count = 0;
+    int boundArraySize = -1;
+    bool found = false;
+};
+
+#endif //STUDYARRAYBINDINGS_H
@@ -0,0 +1,100 @@
+/*
+ * Prints the binary trade event logs written by TradeEventLog as text, one record per line, in the order of the files
+ * given (oldest rotation first to read a session front to back).
+ *
+ * Usage: divergence_events [--csv] divergence_events_c1_s8.bin.2 divergence_events_c1_s8.bin.1 divergence_events_c1_s8.bin
+ */
+
+#include "TradeEventLog.h"
+
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+namespace {
+
+constexpr double SCDATETIME_UNIX_EPOCH_DAYS = 25569.0;  // 1970-01-01 in days since 1899-12-30
+
+std::tm toUtc(const std::time_t t) {
+    std::tm utc{};
+#ifdef _WIN32
+    gmtime_s(&utc, &t);
+#else
+    gmtime_r(&t, &utc);
+#endif
+    return utc;
+}
+
+void formatUtc(const int64_t seconds, const int64_t nanoseconds, char* out, const size_t size) {
+    const std::tm utc = toUtc(static_cast<std::time_t>(seconds));
+    const size_t length = std::strftime(out, size, "%Y-%m-%d %H:%M:%S", &utc);
+    std::snprintf(out + length, size - length, ".%09" PRId64, nanoseconds);
+}
+
+void formatBarTime(const double days, char* out, const size_t size) {
+    const auto milliseconds = static_cast<int64_t>(std::llround((days - SCDATETIME_UNIX_EPOCH_DAYS) * 86400000.0));
+    const std::tm utc = toUtc(static_cast<std::time_t>(milliseconds / 1000));
+    const size_t length = std::strftime(out, size, "%Y-%m-%d %H:%M:%S", &utc);
+    std::snprintf(out + length, size - length, ".%03" PRId64, milliseconds % 1000);
+}
+
+bool decodeFile(const char* path, const bool csv, int64_t& total) {
+    std::FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) {
+        std::fprintf(stderr, "Cannot open %s\n", path);
+        return false;
+    }
+    TradeEventFileHeader header{};
+    if (std::fread(&header, sizeof(header), 1, file) != 1 || std::memcmp(header.magic, TRADE_EVENT_MAGIC, sizeof(header.magic)) != 0
+        || header.version != TRADE_EVENT_VERSION || header.recordSize != sizeof(TradeEventRecord)) {
+        std::fprintf(stderr, "%s is not a version %u trade event log\n", path, TRADE_EVENT_VERSION);
+        std::fclose(file);
+        return false;
+    }
+
+    TradeEventRecord record{};
+    char pushed[48], bar[32];
+    while (std::fread(&record, sizeof(record), 1, file) == 1) {
+        formatUtc(record.timestampNs / 1000000000, record.timestampNs % 1000000000, pushed, sizeof(pushed));
+        formatBarTime(record.barDateTime, bar, sizeof(bar));
+        if (csv) {
+            std::printf("%s,%d,%s,%s,%" PRId64 ",%" PRId64 ",%.8g,%u\n", pushed, record.barIndex, bar,
+                        tradeEventTypeName(record.type), record.internalOrderId, record.parentOrderId, record.price,
+                        record.detail);
+        } else {
+            std::printf("%s bar=%d bar_time=%s %-15s order=%" PRId64 " parent=%" PRId64 " price=%.8g detail=%u\n", pushed,
+                        record.barIndex, bar, tradeEventTypeName(record.type), record.internalOrderId,
+                        record.parentOrderId, record.price, record.detail);
+        }
+        ++total;
+    }
+    std::fclose(file);
+    return true;
+}
+
+}
+
+int main(const int argc, char** argv) {
+    bool csv = false;
+    int firstFile = 1;
+    if (argc > 1 && std::strcmp(argv[1], "--csv") == 0) {
+        csv = true;
+        firstFile = 2;
+    }
+    if (firstFile >= argc) {
+        std::fprintf(stderr, "Usage: %s [--csv] file.bin...\n", argv[0]);
+        return 2;
+    }
+    if (csv) {
+        std::printf("pushed_utc,bar_index,bar_time,type,internal_order_id,parent_order_id,price,detail\n");
+    }
+    int64_t total = 0;
+    bool ok = true;
+    for (int a = firstFile; a < argc; ++a) {
+        ok = decodeFile(argv[a], csv, total) && ok;
+    }
+    std::fprintf(stderr, "%" PRId64 " records\n", total);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+#include "TradeEventLog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <system_error>
+#include <utility>
+
+namespace {
+
+// Header of the current format followed by whole records, a crash mid-record leaves a log that is not appended to
+bool isAppendable(const std::string& path, const uintmax_t size) {
+    if (size < sizeof(TradeEventFileHeader) || (size - sizeof(TradeEventFileHeader)) % sizeof(TradeEventRecord) != 0) {
+        return false;
+    }
+    std::FILE* existing = std::fopen(path.c_str(), "rb");
+    if (existing == nullptr) {return false;}
+    TradeEventFileHeader header{};
+    const bool read = std::fread(&header, sizeof(header), 1, existing) == 1;
+    std::fclose(existing);
+    return read && std::memcmp(header.magic, TRADE_EVENT_MAGIC, sizeof(header.magic)) == 0
+           && header.version == TRADE_EVENT_VERSION && header.recordSize == sizeof(TradeEventRecord);
+}
+
+}
+
+const char* tradeEventTypeName(const TradeEventType type) {
+    switch (type) {
+        case TradeEventType::OrderSubmitted: return "OrderSubmitted";
+        case TradeEventType::OrderRejected: return "OrderRejected";
+        case TradeEventType::ModifySent: return "ModifySent";
+        case TradeEventType::ModifyRejected: return "ModifyRejected";
+        case TradeEventType::TradeClosed: return "TradeClosed";
+        case TradeEventType::OrderState: return "OrderState";
+        case TradeEventType::EventsDropped: return "EventsDropped";
+    }
+    return "Unknown";
+}
+
+TradeEventLog::TradeEventLog(std::string basePath, const int64_t maxFileBytes, const int keepFiles)
+    : basePath(std::move(basePath)),
+      maxFileBytes(maxFileBytes),
+      keepFiles(keepFiles) {
+    openFile();
+    writer = std::thread(&TradeEventLog::writerLoop, this);
+}
+
+TradeEventLog::~TradeEventLog() {
+    stopping.store(true, std::memory_order_release);
+    writer.join();
+    if (file != nullptr) {
+        // Drops nothing got through to report, the writer is gone so the file is ours
+        if (pendingDrops > 0) {
+            TradeEventRecord dropped{};
+            dropped.timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            dropped.type = TradeEventType::EventsDropped;
+            dropped.internalOrderId = pendingDrops;
+            std::fwrite(&dropped, sizeof(dropped), 1, file);
+        }
+        std::fclose(file);
+    }
+}
+
+void TradeEventLog::push(const TradeEventRecord& record) noexcept {
+    if (pendingDrops > 0) {
+        TradeEventRecord dropped = record;
+        dropped.type = TradeEventType::EventsDropped;
+        dropped.internalOrderId = pendingDrops;
+        if (!ring.tryPush(dropped)) {
+            ++pendingDrops;
+            ++droppedCount;
+            return;
+        }
+        pendingDrops = 0;
+    }
+    if (!ring.tryPush(record)) {
+        ++pendingDrops;
+        ++droppedCount;
+    }
+}
+
+void TradeEventLog::writerLoop() {
+    while (!stopping.load(std::memory_order_acquire)) {
+        if (ring.empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        drain();
+    }
+    drain();
+}
+
+void TradeEventLog::drain() {
+    TradeEventRecord batch[DRAIN_BATCH];
+    while (const size_t count = ring.popBulk(batch, DRAIN_BATCH)) {
+        if (file == nullptr) {continue;}
+        std::fwrite(batch, sizeof(TradeEventRecord), count, file);
+        fileBytes += static_cast<int64_t>(count * sizeof(TradeEventRecord));
+        if (fileBytes >= maxFileBytes) {
+            rotate();
+        }
+    }
+    if (file != nullptr) {
+        std::fflush(file);
+    }
+}
+
+void TradeEventLog::openFile() {
+    // Continues what an earlier session left, unless it is not whole records of this format
+    std::error_code error;
+    const uintmax_t existing = std::filesystem::file_size(basePath, error);
+    const bool resume = !error && existing > 0 && isAppendable(basePath, existing);
+    if (!error && existing > 0 && !resume) {
+        shiftFiles();
+    }
+    file = std::fopen(basePath.c_str(), resume ? "ab" : "wb");
+    fileBytes = 0;
+    if (file == nullptr) {return;}
+    if (resume) {
+        fileBytes = static_cast<int64_t>(existing);
+        return;
+    }
+    TradeEventFileHeader header{};
+    std::copy(std::begin(TRADE_EVENT_MAGIC), std::end(TRADE_EVENT_MAGIC), header.magic);
+    header.version = TRADE_EVENT_VERSION;
+    header.recordSize = sizeof(TradeEventRecord);
+    std::fwrite(&header, sizeof(header), 1, file);
+    fileBytes = sizeof(header);
+}
+
+void TradeEventLog::shiftFiles() const {
+    std::error_code ignored;
+    for (int k = keepFiles - 1; k >= 1; --k) {
+        std::filesystem::rename(basePath + "." + std::to_string(k), basePath + "." + std::to_string(k + 1), ignored);
+    }
+    if (keepFiles > 0) {
+        std::filesystem::rename(basePath, basePath + ".1", ignored);
+    }
+}
+
+void TradeEventLog::rotate() {
+    std::fclose(file);
+    file = nullptr;
+    shiftFiles();
+    openFile();
+}
+
+int64_t TradeEventLog::getDroppedCount() const {return droppedCount;}
+
+const std::string& TradeEventLog::getPath() const {return basePath;}
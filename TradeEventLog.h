@@ -0,0 +1,90 @@
+#ifndef TRADEEVENTLOG_H
+#define TRADEEVENTLOG_H
+
+#include "SpscRing.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+enum class TradeEventType : uint16_t {
+    OrderSubmitted = 1,
+    OrderRejected = 2,  // detail is the negated SCTRADING_* error code
+    ModifySent = 3,
+    ModifyRejected = 4,
+    TradeClosed = 5,
+    OrderState = 6,     // Snapshot of an order, detail is its SCOrderStatusCodeEnum
+    EventsDropped = 7,  // The ring was full, internalOrderId holds how many events were lost
+};
+
+// On disk as is, little endian, after a TradeEventFileHeader
+struct TradeEventRecord {
+    int64_t timestampNs;  // system_clock at push
+    double barDateTime;   // SCDateTime of the bar
+    int64_t internalOrderId;
+    int64_t parentOrderId;
+    double price;
+    int32_t barIndex;
+    TradeEventType type;
+    uint16_t detail;
+};
+static_assert(sizeof(TradeEventRecord) == 48, "TradeEventRecord is a file format");
+
+struct TradeEventFileHeader {
+    char magic[8];  // TRADE_EVENT_MAGIC
+    uint32_t version;
+    uint32_t recordSize;
+};
+
+constexpr char TRADE_EVENT_MAGIC[8] = {'D', 'V', 'E', 'V', 'L', 'O', 'G', '1'};
+constexpr uint32_t TRADE_EVENT_VERSION = 1;
+
+const char* tradeEventTypeName(TradeEventType type);
+
+/*
+ * Binary trade event log of one study. The study pushes records into a ring and a writer thread drains it to
+ * basePath, rotated to basePath.1 .. basePath.<keepFiles> once it holds maxFileBytes. The log an earlier session left
+ * at basePath is appended to, or rotated first when it is not whole records of this format. push never blocks: when
+ * the writer falls behind the event is counted and reported with the next one that fits.
+ */
+class TradeEventLog {
+
+public:
+    TradeEventLog(std::string basePath, int64_t maxFileBytes = 64 << 20, int keepFiles = 4);
+    ~TradeEventLog();
+
+    TradeEventLog(const TradeEventLog&) = delete;
+    TradeEventLog& operator=(const TradeEventLog&) = delete;
+
+    // Producer side, from the study only
+    void push(const TradeEventRecord& record) noexcept;
+
+    // Getters
+    [[nodiscard]] int64_t getDroppedCount() const;
+    [[nodiscard]] const std::string& getPath() const;
+
+private:
+    static constexpr size_t RING_CAPACITY = 4096;
+    static constexpr size_t DRAIN_BATCH = 256;
+
+    void writerLoop();
+    void drain();
+    void openFile();
+    void shiftFiles() const;
+    void rotate();
+
+    SpscRing<TradeEventRecord, RING_CAPACITY> ring;
+    const std::string basePath;
+    const int64_t maxFileBytes;
+    const int keepFiles;
+    int64_t pendingDrops = 0;
+    int64_t droppedCount = 0;
+    std::FILE* file = nullptr;
+    int64_t fileBytes = 0;
+    std::atomic<bool> stopping{false};
+    std::thread writer;
+};
+
+#endif //TRADEEVENTLOG_H
@@ -0,0 +1,180 @@
+#include "TradeJournal.h"
+
+#include <algorithm>
+#include <cstring>
+
+using trade_journal::Column;
+using trade_journal::Header;
+using trade_journal::BLOCK_BYTES;
+
+namespace {
+
+constexpr size_t HEADER_BYTES = sizeof(Header);
+
+bool isCurrentLayout(const Header& header) {
+    return std::memcmp(header.magic, TRADE_JOURNAL_MAGIC, sizeof(header.magic)) == 0
+           && header.version == TRADE_JOURNAL_VERSION && header.blockRows == TRADE_JOURNAL_BLOCK_ROWS
+           && header.columnCount == trade_journal::COLUMN_COUNT && header.rowBytes == trade_journal::rowBytes();
+}
+
+bool isBlank(const Header& header) {
+    static constexpr char blank[sizeof(header.magic)] = {};
+    return std::memcmp(header.magic, blank, sizeof(blank)) == 0;
+}
+
+template <typename T>
+void store(uint8_t* block, const Column column, const size_t slot, const T value) {
+    std::memcpy(block + trade_journal::columnOffset(column) + slot * sizeof(T), &value, sizeof(T));
+}
+
+template <typename T>
+T load(const uint8_t* block, const Column column, const size_t slot) {
+    T value;
+    std::memcpy(&value, block + trade_journal::columnOffset(column) + slot * sizeof(T), sizeof(T));
+    return value;
+}
+
+}
+
+const char* journalEventName(const JournalEvent event) {
+    switch (event) {
+        case JournalEvent::Entry: return "Entry";
+        case JournalEvent::PlateauStep: return "PlateauStep";
+        case JournalEvent::Modify: return "Modify";
+        case JournalEvent::Exit: return "Exit";
+    }
+    return "Unknown";
+}
+
+bool TradeJournalWriter::open(const std::string& journalPath) {
+    close();
+    path = journalPath;
+    if (!map(GROW_BLOCKS)) {return false;}
+    if (isBlank(*header)) {
+        std::memcpy(header->magic, TRADE_JOURNAL_MAGIC, sizeof(header->magic));
+        header->version = TRADE_JOURNAL_VERSION;
+        header->blockRows = TRADE_JOURNAL_BLOCK_ROWS;
+        header->columnCount = trade_journal::COLUMN_COUNT;
+        header->rowBytes = trade_journal::rowBytes();
+        header->rowCount.store(0, std::memory_order_release);
+    } else if (!isCurrentLayout(*header)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool TradeJournalWriter::map(const size_t blocks) {
+    file.close();
+    header = nullptr;
+    mappedBlocks = 0;
+    if (!file.open(path, MapMode::ReadWrite, HEADER_BYTES + blocks * BLOCK_BYTES)
+        || file.getSize() < HEADER_BYTES + blocks * BLOCK_BYTES) {
+        file.close();
+        return false;
+    }
+    header = reinterpret_cast<Header*>(file.getData());
+    mappedBlocks = (file.getSize() - HEADER_BYTES) / BLOCK_BYTES;
+    return true;
+}
+
+void TradeJournalWriter::close() {
+    file.close();
+    header = nullptr;
+    mappedBlocks = 0;
+}
+
+void TradeJournalWriter::append(const JournalRow& row) {
+    if (header == nullptr) {return;}
+    const uint64_t index = header->rowCount.load(std::memory_order_relaxed);
+    const size_t block = index / TRADE_JOURNAL_BLOCK_ROWS;
+    // The file grows a few blocks at a time, remapping is rare next to the appends
+    if (block >= mappedBlocks && !map(block + GROW_BLOCKS)) {return;}
+
+    uint8_t* data = file.getData() + HEADER_BYTES + block * BLOCK_BYTES;
+    const size_t slot = index % TRADE_JOURNAL_BLOCK_ROWS;
+    store(data, trade_journal::TIMESTAMP, slot, row.timestampNs);
+    store(data, trade_journal::BAR_DATETIME, slot, row.barDateTime);
+    store(data, trade_journal::TRADE_ID, slot, row.tradeId);
+    store(data, trade_journal::BAR_INDEX, slot, row.barIndex);
+    store(data, trade_journal::PRICE, slot, row.price);
+    store(data, trade_journal::FILL_PRICE, slot, row.fillPrice);
+    store(data, trade_journal::STOP_PRICE, slot, row.stopPrice);
+    store(data, trade_journal::TARGET_PRICE, slot, row.targetPrice);
+    store(data, trade_journal::MAX_FAVORABLE, slot, row.maxFavorable);
+    store(data, trade_journal::MAX_ADVERSE, slot, row.maxAdverse);
+    store(data, trade_journal::PLATEAU, slot, row.plateau);
+    store(data, trade_journal::EVENT, slot, static_cast<uint8_t>(row.event));
+    store(data, trade_journal::DIRECTION, slot, row.direction);
+    header->rowCount.store(index + 1, std::memory_order_release);
+}
+
+bool TradeJournalWriter::isOpen() const {return header != nullptr;}
+
+const std::string& TradeJournalWriter::getPath() const {return path;}
+
+uint64_t TradeJournalWriter::getRowCount() const {
+    return header != nullptr ? header->rowCount.load(std::memory_order_relaxed) : 0;
+}
+
+bool TradeJournalReader::open(const std::string& journalPath) {
+    close();
+    path = journalPath;
+    refresh();
+    return isOpen();
+}
+
+void TradeJournalReader::close() {
+    file.close();
+    rowCount = 0;
+}
+
+uint64_t TradeJournalReader::refresh() {
+    // Mapped again to see the blocks the writer added since
+    if (!file.open(path, MapMode::ReadOnly) || file.getSize() < HEADER_BYTES
+        || !isCurrentLayout(*reinterpret_cast<const Header*>(file.getData()))) {
+        close();
+        return 0;
+    }
+    const auto& header = *reinterpret_cast<const Header*>(file.getData());
+    const uint64_t mappedRows = (file.getSize() - HEADER_BYTES) / BLOCK_BYTES * TRADE_JOURNAL_BLOCK_ROWS;
+    rowCount = std::min(header.rowCount.load(std::memory_order_acquire), mappedRows);
+    return rowCount;
+}
+
+JournalRow TradeJournalReader::row(const uint64_t index) const {
+    const uint8_t* data = blockData(index / TRADE_JOURNAL_BLOCK_ROWS);
+    const size_t slot = index % TRADE_JOURNAL_BLOCK_ROWS;
+    JournalRow row;
+    row.timestampNs = load<int64_t>(data, trade_journal::TIMESTAMP, slot);
+    row.barDateTime = load<double>(data, trade_journal::BAR_DATETIME, slot);
+    row.tradeId = load<int64_t>(data, trade_journal::TRADE_ID, slot);
+    row.barIndex = load<int32_t>(data, trade_journal::BAR_INDEX, slot);
+    row.price = load<int32_t>(data, trade_journal::PRICE, slot);
+    row.fillPrice = load<int32_t>(data, trade_journal::FILL_PRICE, slot);
+    row.stopPrice = load<int32_t>(data, trade_journal::STOP_PRICE, slot);
+    row.targetPrice = load<int32_t>(data, trade_journal::TARGET_PRICE, slot);
+    row.maxFavorable = load<int32_t>(data, trade_journal::MAX_FAVORABLE, slot);
+    row.maxAdverse = load<int32_t>(data, trade_journal::MAX_ADVERSE, slot);
+    row.plateau = load<int16_t>(data, trade_journal::PLATEAU, slot);
+    row.event = static_cast<JournalEvent>(load<uint8_t>(data, trade_journal::EVENT, slot));
+    row.direction = load<int8_t>(data, trade_journal::DIRECTION, slot);
+    return row;
+}
+
+const uint8_t* TradeJournalReader::blockData(const size_t block) const {
+    return file.getData() + HEADER_BYTES + block * BLOCK_BYTES;
+}
+
+bool TradeJournalReader::isOpen() const {return file.isOpen();}
+
+uint64_t TradeJournalReader::getRowCount() const {return rowCount;}
+
+size_t TradeJournalReader::getBlockCount() const {
+    return static_cast<size_t>((rowCount + TRADE_JOURNAL_BLOCK_ROWS - 1) / TRADE_JOURNAL_BLOCK_ROWS);
+}
+
+size_t TradeJournalReader::getRowsInBlock(const size_t block) const {
+    const uint64_t first = static_cast<uint64_t>(block) * TRADE_JOURNAL_BLOCK_ROWS;
+    return first >= rowCount ? 0 : static_cast<size_t>(std::min<uint64_t>(TRADE_JOURNAL_BLOCK_ROWS, rowCount - first));
+}
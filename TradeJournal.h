@@ -0,0 +1,143 @@
+#ifndef TRADEJOURNAL_H
+#define TRADEJOURNAL_H
+
+#include "MappedFile.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * Append-only journal of trade lifecycles: a row per entry, plateau step, stop/target modification and exit, with the
+ * trade's prices and excursions at that point. The file is memory mapped and stored by column in blocks of
+ * TRADE_JOURNAL_BLOCK_ROWS rows, so an analysis reads the few columns it needs over millions of rows without parsing.
+ * Rows count once the writer published them in the header, a reader mapping the file while it grows sees whole rows.
+ * A study keeps appending to its journal across sessions.
+ */
+
+enum class JournalEvent : uint8_t {
+    Entry = 1,        // The bracket is working, price is the fill
+    PlateauStep = 2,  // The favorable excursion reached a new plateau, stop and target moved with it
+    Modify = 3,       // New stop/target prices were requested
+    Exit = 4,         // The bracket is done, price is the exit fill (the bar's close when unknown)
+};
+
+const char* journalEventName(JournalEvent event);
+
+// One row as appended, on disk column by column. Prices in ticks, excursions in ticks from the fill
+struct JournalRow {
+    int64_t timestampNs = 0;  // system_clock when appended
+    double barDateTime = 0;   // SCDateTime of the bar
+    int64_t tradeId = 0;      // Parent InternalOrderID
+    int32_t barIndex = 0;
+    int32_t price = 0;
+    int32_t fillPrice = 0;
+    int32_t stopPrice = 0;
+    int32_t targetPrice = 0;
+    int32_t maxFavorable = 0;  // MFE so far
+    int32_t maxAdverse = 0;    // MAE so far, positive against the trade
+    int16_t plateau = 0;
+    JournalEvent event = JournalEvent::Entry;
+    int8_t direction = 0;  // 1 long, -1 short
+};
+
+constexpr char TRADE_JOURNAL_MAGIC[8] = {'D', 'V', 'J', 'O', 'U', 'R', 'N', 'L'};
+constexpr uint32_t TRADE_JOURNAL_VERSION = 1;
+constexpr uint32_t TRADE_JOURNAL_BLOCK_ROWS = 16384;  // A multiple of 8 keeps every column aligned
+
+namespace trade_journal {
+
+// Widest first, in block order
+enum Column {
+    TIMESTAMP, BAR_DATETIME, TRADE_ID, BAR_INDEX, PRICE, FILL_PRICE, STOP_PRICE, TARGET_PRICE, MAX_FAVORABLE,
+    MAX_ADVERSE, PLATEAU, EVENT, DIRECTION, COLUMN_COUNT
+};
+
+constexpr size_t COLUMN_WIDTH[COLUMN_COUNT] = {8, 8, 8, 4, 4, 4, 4, 4, 4, 4, 2, 1, 1};
+
+constexpr size_t rowBytes() {
+    size_t bytes = 0;
+    for (const size_t width : COLUMN_WIDTH) {bytes += width;}
+    return bytes;
+}
+
+constexpr size_t BLOCK_BYTES = rowBytes() * TRADE_JOURNAL_BLOCK_ROWS;
+
+// Of the column within its block
+constexpr size_t columnOffset(const Column column) {
+    size_t offset = 0;
+    for (int c = 0; c < column; ++c) {offset += COLUMN_WIDTH[c] * TRADE_JOURNAL_BLOCK_ROWS;}
+    return offset;
+}
+
+struct alignas(64) Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t blockRows;
+    uint32_t columnCount;
+    uint32_t rowBytes;
+    std::atomic<uint64_t> rowCount;  // Rows published, stored after the row
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "The journal's row count is read from other processes");
+
+}
+
+class TradeJournalWriter {
+
+public:
+    // Continues the journal at path or starts one, false when the file holds something else
+    bool open(const std::string& path);
+    void close();
+
+    void append(const JournalRow& row);
+
+    // Getters
+    [[nodiscard]] bool isOpen() const;
+    [[nodiscard]] const std::string& getPath() const;
+    [[nodiscard]] uint64_t getRowCount() const;
+
+private:
+    static constexpr size_t GROW_BLOCKS = 4;
+
+    bool map(size_t blocks);
+
+    MappedFile file;
+    std::string path;
+    trade_journal::Header* header = nullptr;
+    size_t mappedBlocks = 0;
+};
+
+class TradeJournalReader {
+
+public:
+    bool open(const std::string& path);
+    void close();
+
+    // Rows published when the journal was opened, or when refresh() was last called
+    uint64_t refresh();
+
+    // Column c of the block holding rows [block * TRADE_JOURNAL_BLOCK_ROWS, ...), T of the column's width
+    template <typename T>
+    [[nodiscard]] const T* column(const size_t block, const trade_journal::Column c) const {
+        static_assert(sizeof(T) <= 8, "Journal columns are at most 8 bytes wide");
+        return reinterpret_cast<const T*>(blockData(block) + trade_journal::columnOffset(c));
+    }
+    [[nodiscard]] JournalRow row(uint64_t index) const;
+
+    // Getters
+    [[nodiscard]] bool isOpen() const;
+    [[nodiscard]] uint64_t getRowCount() const;
+    [[nodiscard]] size_t getBlockCount() const;
+    [[nodiscard]] size_t getRowsInBlock(size_t block) const;
+
+private:
+    [[nodiscard]] const uint8_t* blockData(size_t block) const;
+
+    MappedFile file;
+    std::string path;
+    uint64_t rowCount = 0;
+};
+
+#endif //TRADEJOURNAL_H
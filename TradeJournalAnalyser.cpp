@@ -0,0 +1,287 @@
+/*
+ * Trade statistics from the journals written by TradeJournalWriter: realized result, maximum favorable and adverse
+ * excursions (MFE/MAE), what was given back from the MFE, and how far trades climbed the plateaus, overall and per
+ * highest plateau reached. Only the columns the statistics need are read, block by block.
+ *
+ * Usage: divergence_journal [--trades] divergence_journal_c1_s8.dvj [more journals]
+ *        divergence_journal --write-synthetic N journal.dvj
+ *
+ * --trades prints one CSV line per closed trade instead. --write-synthetic appends N made up trades to a journal, to
+ * time the analysis on millions of them. Values are in ticks.
+ */
+
+#include "TradeJournal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct AnalyserOptions {
+    std::vector<std::string> paths;
+    bool trades = false;
+    int64_t syntheticTrades = 0;
+};
+
+bool parseOptions(const int argc, char** argv, AnalyserOptions& options) {
+    for (int a = 1; a < argc; ++a) {
+        if (std::strcmp(argv[a], "--trades") == 0) {
+            options.trades = true;
+        } else if (std::strcmp(argv[a], "--write-synthetic") == 0) {
+            options.syntheticTrades = a + 1 < argc ? std::atoll(argv[++a]) : 0;
+        } else if (argv[a][0] == '-') {
+            std::fprintf(stderr, "Unknown option %s\n", argv[a]);
+            return false;
+        } else {
+            options.paths.emplace_back(argv[a]);
+        }
+    }
+    if (options.paths.empty()) {
+        std::fprintf(stderr, "A journal is required\n");
+        return false;
+    }
+    return true;
+}
+
+struct TradeSummary {
+    int64_t tradeId = 0;
+    double entryBarDateTime = 0;
+    double exitBarDateTime = 0;
+    int32_t fillPrice = 0;
+    int32_t exitPrice = 0;
+    int32_t realized = 0;
+    int32_t maxFavorable = 0;
+    int32_t maxAdverse = 0;
+    int32_t plateau = 0;
+    int32_t plateauSteps = 0;
+    int32_t modifies = 0;
+    int8_t direction = 0;
+    bool closed = false;
+};
+
+struct JournalScan {
+    std::vector<TradeSummary> trades;
+    uint64_t rows = 0;
+    uint64_t orphanRows = 0;  // Events of a trade whose entry is not in the journals
+};
+
+// Trades are matched by parent order id, an entry under an id already open starts a new trade
+void scanJournal(const TradeJournalReader& journal, JournalScan& scan) {
+    std::unordered_map<int64_t, size_t> open;
+    for (size_t block = 0; block < journal.getBlockCount(); ++block) {
+        const size_t rows = journal.getRowsInBlock(block);
+        const auto* tradeIds = journal.column<int64_t>(block, trade_journal::TRADE_ID);
+        const auto* barDateTimes = journal.column<double>(block, trade_journal::BAR_DATETIME);
+        const auto* events = journal.column<uint8_t>(block, trade_journal::EVENT);
+        const auto* prices = journal.column<int32_t>(block, trade_journal::PRICE);
+        const auto* fillPrices = journal.column<int32_t>(block, trade_journal::FILL_PRICE);
+        const auto* maxFavorable = journal.column<int32_t>(block, trade_journal::MAX_FAVORABLE);
+        const auto* maxAdverse = journal.column<int32_t>(block, trade_journal::MAX_ADVERSE);
+        const auto* plateaus = journal.column<int16_t>(block, trade_journal::PLATEAU);
+        const auto* directions = journal.column<int8_t>(block, trade_journal::DIRECTION);
+
+        for (size_t r = 0; r < rows; ++r) {
+            const auto event = static_cast<JournalEvent>(events[r]);
+            if (event == JournalEvent::Entry) {
+                TradeSummary trade;
+                trade.tradeId = tradeIds[r];
+                trade.entryBarDateTime = barDateTimes[r];
+                trade.direction = directions[r];
+                open[tradeIds[r]] = scan.trades.size();
+                scan.trades.push_back(trade);
+                continue;
+            }
+            const auto it = open.find(tradeIds[r]);
+            if (it == open.end()) {
+                ++scan.orphanRows;
+                continue;
+            }
+            TradeSummary& trade = scan.trades[it->second];
+            trade.fillPrice = fillPrices[r];
+            trade.maxFavorable = std::max(trade.maxFavorable, maxFavorable[r]);
+            trade.maxAdverse = std::max(trade.maxAdverse, maxAdverse[r]);
+            trade.plateau = std::max<int32_t>(trade.plateau, plateaus[r]);
+            switch (event) {
+                case JournalEvent::PlateauStep: ++trade.plateauSteps; break;
+                case JournalEvent::Modify: ++trade.modifies; break;
+                case JournalEvent::Exit:
+                    trade.exitBarDateTime = barDateTimes[r];
+                    trade.exitPrice = prices[r];
+                    trade.realized = trade.direction * (prices[r] - trade.fillPrice);
+                    trade.closed = true;
+                    open.erase(it);
+                    break;
+                case JournalEvent::Entry: break;
+            }
+        }
+        scan.rows += rows;
+    }
+}
+
+// Plateaus from this one up share the last row of the plateau table
+constexpr int32_t PLATEAU_ROWS = 10;
+
+struct Distribution {
+    double mean = 0;
+    int32_t p50 = 0, p90 = 0, max = 0;
+};
+
+Distribution distributionOf(std::vector<int32_t>& values) {
+    Distribution d;
+    if (values.empty()) {return d;}
+    double total = 0;
+    for (const int32_t v : values) {total += v;}
+    d.mean = total / static_cast<double>(values.size());
+    const auto at = [&](const double p) {
+        const auto nth = values.begin() + static_cast<std::ptrdiff_t>(p * static_cast<double>(values.size() - 1));
+        std::nth_element(values.begin(), nth, values.end());
+        return *nth;
+    };
+    d.p50 = at(0.5);
+    d.p90 = at(0.9);
+    d.max = *std::max_element(values.begin(), values.end());
+    return d;
+}
+
+void printDistribution(const char* name, std::vector<int32_t>& values) {
+    const Distribution d = distributionOf(values);
+    std::printf("%-10s mean=%8.2f p50=%6d p90=%6d max=%6d\n", name, d.mean, d.p50, d.p90, d.max);
+}
+
+void printStatistics(const JournalScan& scan) {
+    std::vector<int32_t> realized, mfe, mae, giveBack, modifies;
+    // Highest plateau reached -> trades, total realized, total given back
+    std::map<int32_t, std::tuple<int64_t, double, double>> byPlateau;
+    int64_t winners = 0;
+    double totalRealized = 0, totalMfe = 0;
+    for (const TradeSummary& trade : scan.trades) {
+        if (!trade.closed) {continue;}
+        realized.push_back(trade.realized);
+        mfe.push_back(trade.maxFavorable);
+        mae.push_back(trade.maxAdverse);
+        giveBack.push_back(trade.maxFavorable - trade.realized);
+        modifies.push_back(trade.modifies);
+        winners += trade.realized > 0 ? 1 : 0;
+        totalRealized += trade.realized;
+        totalMfe += trade.maxFavorable;
+        auto& [count, plateauRealized, plateauGiveBack] = byPlateau[std::min(trade.plateau, PLATEAU_ROWS)];
+        ++count;
+        plateauRealized += trade.realized;
+        plateauGiveBack += trade.maxFavorable - trade.realized;
+    }
+    const auto closed = static_cast<int64_t>(realized.size());
+    std::printf("rows=%" PRIu64 " trades=%zu closed=%" PRId64 " open=%" PRId64 " orphan_rows=%" PRIu64 "\n", scan.rows,
+                scan.trades.size(), closed, static_cast<int64_t>(scan.trades.size()) - closed, scan.orphanRows);
+    if (closed == 0) {return;}
+    std::printf("win_rate=%.3f capture=%.3f (realized / MFE)\n", static_cast<double>(winners) / static_cast<double>(closed),
+                totalMfe > 0 ? totalRealized / totalMfe : 0.0);
+    printDistribution("realized", realized);
+    printDistribution("mfe", mfe);
+    printDistribution("mae", mae);
+    printDistribution("give_back", giveBack);
+    printDistribution("modifies", modifies);
+    std::printf("%-8s %10s %8s %12s %14s\n", "plateau", "trades", "share", "mean_result", "mean_give_back");
+    for (const auto& [plateau, totals] : byPlateau) {
+        const auto& [count, plateauRealized, plateauGiveBack] = totals;
+        char level[16];
+        std::snprintf(level, sizeof(level), plateau < PLATEAU_ROWS ? "%d" : "%d+", plateau);
+        std::printf("%-8s %10" PRId64 " %8.3f %12.2f %14.2f\n", level, count,
+                    static_cast<double>(count) / static_cast<double>(closed), plateauRealized / static_cast<double>(count),
+                    plateauGiveBack / static_cast<double>(count));
+    }
+}
+
+void printTrades(const JournalScan& scan) {
+    std::printf("trade_id,direction,entry_bar_time,exit_bar_time,fill,exit,realized,mfe,mae,give_back,plateau,"
+                "plateau_steps,modifies\n");
+    for (const TradeSummary& t : scan.trades) {
+        if (!t.closed) {continue;}
+        std::printf("%" PRId64 ",%d,%.8f,%.8f,%d,%d,%d,%d,%d,%d,%d,%d,%d\n", t.tradeId, t.direction, t.entryBarDateTime,
+                    t.exitBarDateTime, t.fillPrice, t.exitPrice, t.realized, t.maxFavorable, t.maxAdverse,
+                    t.maxFavorable - t.realized, t.plateau, t.plateauSteps, t.modifies);
+    }
+}
+
+// Random walks around a fill with a plateau every 8 ticks of MFE, the way TradeWrapper steps them
+int writeSynthetic(const std::string& path, const int64_t count) {
+    TradeJournalWriter journal;
+    if (!journal.open(path)) {
+        std::fprintf(stderr, "Cannot open %s as a trade journal\n", path.c_str());
+        return 1;
+    }
+    constexpr int32_t PLATEAU_TICKS = 8;
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> step(-2, 2);
+    std::uniform_int_distribution<int> length(5, 60);
+    const double firstBar = 46000.0;
+    int64_t barIndex = 0;
+    for (int64_t n = 0; n < count; ++n) {
+        JournalRow row;
+        row.tradeId = n + 1;
+        row.direction = static_cast<int8_t>(n % 2 == 0 ? 1 : -1);
+        row.fillPrice = 20000;
+        row.stopPrice = row.fillPrice - row.direction * 12;
+        row.targetPrice = row.fillPrice + row.direction * 12;
+        const auto append = [&](const JournalEvent event, const int32_t price) {
+            row.event = event;
+            row.price = price;
+            row.barIndex = static_cast<int32_t>(barIndex);
+            row.barDateTime = firstBar + static_cast<double>(barIndex) / 1440.0;
+            journal.append(row);
+        };
+        append(JournalEvent::Entry, row.fillPrice);
+        int32_t price = row.fillPrice;
+        const int bars = length(rng);
+        for (int b = 0; b < bars; ++b, ++barIndex) {
+            price += step(rng);
+            const int32_t gain = row.direction * (price - row.fillPrice);
+            row.maxFavorable = std::max(row.maxFavorable, gain);
+            row.maxAdverse = std::max(row.maxAdverse, -gain);
+            if (const auto plateau = static_cast<int16_t>(row.maxFavorable / PLATEAU_TICKS + 1); plateau > row.plateau) {
+                row.plateau = plateau;
+                row.stopPrice += row.direction * PLATEAU_TICKS;
+                row.targetPrice += row.direction * PLATEAU_TICKS;
+                append(JournalEvent::PlateauStep, price);
+                append(JournalEvent::Modify, price);
+            }
+            if (row.direction * (price - row.stopPrice) <= 0 || row.direction * (price - row.targetPrice) >= 0) {break;}
+        }
+        append(JournalEvent::Exit, price);
+    }
+    std::printf("rows=%" PRIu64 " path=%s\n", journal.getRowCount(), path.c_str());
+    return 0;
+}
+
+}
+
+int main(const int argc, char** argv) {
+    AnalyserOptions options;
+    if (!parseOptions(argc, argv, options)) {return 2;}
+    if (options.syntheticTrades > 0) {return writeSynthetic(options.paths.front(), options.syntheticTrades);}
+
+    const auto start = std::chrono::steady_clock::now();
+    JournalScan scan;
+    for (const std::string& path : options.paths) {
+        TradeJournalReader journal;
+        if (!journal.open(path)) {
+            std::fprintf(stderr, "Cannot read %s as a trade journal\n", path.c_str());
+            return 1;
+        }
+        scanJournal(journal, scan);
+    }
+    options.trades ? printTrades(scan) : printStatistics(scan);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::fprintf(stderr, "rows=%" PRIu64 " seconds=%.3f rows_per_second=%.0f\n", scan.rows, seconds,
+                 static_cast<double>(scan.rows) / seconds);
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include "TradeManager.h"
+
+
+TradeManager::TradeManager(const int capacity) : slots(capacity), activePosition(capacity, -1) {
+    freeSlots.reserve(capacity);
+    active.reserve(capacity);
+    slotByParentId.reserve(capacity);
+    // Lowest slots first, so a lightly used manager stays at the front of the slab
+    for (int slot = capacity - 1; slot >= 0; --slot) {
+        freeSlots.push_back(slot);
+    }
+}
+
+TradeWrapper* TradeManager::open(
+    const int64_t parentId,
+    const int createdIndex,
+    const TargetMode mode,
+    const BuySellEnum dir,
+    const PriceTicks constPlateauSize,
+    const int expirationBars
+) {
+    return place(parentId, parentId, createdIndex, mode, dir, constPlateauSize, expirationBars);
+}
+
+TradeWrapper* TradeManager::restore(const TradeWrapperState& state) {
+    return place(state.parentOrderId, state);
+}
+
+TradeWrapper* TradeManager::find(const int64_t parentId) {
+    const auto it = slotByParentId.find(parentId);
+    return it == slotByParentId.end() ? nullptr : &*slots[it->second];
+}
+
+void TradeManager::close(const int64_t parentId) {
+    const auto it = slotByParentId.find(parentId);
+    if (it == slotByParentId.end()) {return;}
+    const int slot = it->second;
+    slotByParentId.erase(it);
+
+    // Swap-remove from the open list
+    const int position = activePosition[slot];
+    const int lastSlot = active.back();
+    active[position] = lastSlot;
+    activePosition[lastSlot] = position;
+    active.pop_back();
+    activePosition[slot] = -1;
+
+    slots[slot].reset();
+    freeSlots.push_back(slot);
+}
+
+void TradeManager::clear() {
+    for (const int slot : active) {
+        slots[slot].reset();
+        activePosition[slot] = -1;
+    }
+    active.clear();
+    slotByParentId.clear();
+    freeSlots.clear();
+    for (int slot = static_cast<int>(slots.size()) - 1; slot >= 0; --slot) {
+        freeSlots.push_back(slot);
+    }
+}
+
+int TradeManager::getActiveCount() const {return static_cast<int>(active.size());}
+
+int TradeManager::getCapacity() const {return static_cast<int>(slots.size());}
+
+bool TradeManager::isFull() const {return freeSlots.empty();}
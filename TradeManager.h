@@ -0,0 +1,70 @@
+#ifndef TRADEMANAGER_H
+#define TRADEMANAGER_H
+
+#include "TradeWrapper.h"
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+constexpr int TRADE_MANAGER_CAPACITY = 32;
+
+/*
+ * Concurrent trades of a study in a slab allocated once: opening and closing a trade reuses a free slot instead of
+ * going through new/delete. Trades are found by parent InternalOrderID, and the open ones are listed densely so
+ * iterating them does not walk the free slots.
+ */
+class TradeManager {
+
+public:
+    explicit TradeManager(int capacity = TRADE_MANAGER_CAPACITY);
+
+    // New trade in a free slot, nullptr when the slab is full or the parent order already has one
+    TradeWrapper* open(int64_t parentId, int createdIndex, TargetMode mode, BuySellEnum dir, PriceTicks constPlateauSize,
+                       int expirationBars = 10);
+
+    // A trade saved in a state snapshot, nullptr like open()
+    TradeWrapper* restore(const TradeWrapperState& state);
+
+    [[nodiscard]] TradeWrapper* find(int64_t parentId);
+
+    void close(int64_t parentId);
+    void clear();
+
+    // Runs fn(trade) over the open trades, fn may close the trade it is given
+    template <typename Function>
+    void forEachActive(Function&& fn) {
+        for (size_t k = active.size(); k-- > 0;) {
+            fn(*slots[active[k]]);
+        }
+    }
+
+    // Getters
+    [[nodiscard]] int getActiveCount() const;
+    [[nodiscard]] int getCapacity() const;
+    [[nodiscard]] bool isFull() const;
+
+private:
+    // A trade built from args in a free slot, listed under parentId
+    template <typename... Args>
+    TradeWrapper* place(const int64_t parentId, Args&&... args) {
+        if (freeSlots.empty() || slotByParentId.contains(parentId)) {return nullptr;}
+        const int slot = freeSlots.back();
+        freeSlots.pop_back();
+        slots[slot].emplace(std::forward<Args>(args)...);
+        activePosition[slot] = static_cast<int>(active.size());
+        active.push_back(slot);
+        slotByParentId.emplace(parentId, slot);
+        return &*slots[slot];
+    }
+
+    std::vector<std::optional<TradeWrapper>> slots;
+    std::vector<int> freeSlots;
+    std::vector<int> active;          // Slots of the open trades
+    std::vector<int> activePosition;  // Position of each slot in active
+    std::unordered_map<int64_t, int> slotByParentId;
+};
+
+#endif //TRADEMANAGER_H
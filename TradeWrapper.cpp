@@ -1,4 +1,8 @@
 #include "TradeWrapper.h"
+#include "LatencyProbe.h"
+#include "OrderModifyQueue.h"
+#include "Side.h"
+#include "helpers.h"
 
 
 TradeWrapper::TradeWrapper(
@@ -6,7 +10,7 @@ TradeWrapper::TradeWrapper(
     const int createdIndex,
     const TargetMode mode,
     const BuySellEnum dir,
-    const double constPlateauSize,
+    const PriceTicks constPlateauSize,
     const int expirationBars
 )
     : parentOrderId(parentId),
@@ -14,15 +18,32 @@ TradeWrapper::TradeWrapper(
       expirationBars(expirationBars),
       parentOrderDirection(dir),
       targetMode(mode),
+      hasBracketPrices(false),
       fillPrice(0),
-      maxFavorablePriceDifference(0.0),
-      targetPrice(0.0),
-      stopPrice(0.0),
+      maxFavorablePriceDifference(0),
+      maxAdversePriceDifference(0),
+      targetPrice(0),
+      stopPrice(0),
       constPlateauSize(constPlateauSize),
       currentPlateau(0) {}
 
+TradeWrapper::TradeWrapper(const TradeWrapperState& state)
+    : parentOrderId(state.parentOrderId),
+      createdIndex(state.createdIndex),
+      expirationBars(state.expirationBars),
+      parentOrderDirection(static_cast<BuySellEnum>(state.parentOrderDirection)),
+      targetMode(static_cast<TargetMode>(state.targetMode)),
+      hasBracketPrices(state.hasBracketPrices != 0),
+      fillPrice(state.fillPrice),
+      maxFavorablePriceDifference(state.maxFavorablePriceDifference),
+      maxAdversePriceDifference(state.maxAdversePriceDifference),
+      targetPrice(state.targetPrice),
+      stopPrice(state.stopPrice),
+      constPlateauSize(state.constPlateauSize),
+      currentPlateau(state.currentPlateau) {}
+
 [[nodiscard]] TradeStatus TradeWrapper::getRealStatus(const int index) const {
-    const bool priceCondition = parentOrder.Price1 != 0 && stopOrder.Price1 != 0 && targetOrder.Price1 != 0;
+    const bool priceCondition = orders.parent.price1Ticks != 0 && orders.stop.price1Ticks != 0 && orders.target.price1Ticks != 0;
     const bool activeCondition = getStopOrderStatus() == SCT_OSC_OPEN && getTargetOrderStatus() == SCT_OSC_OPEN && priceCondition;
     const bool terminatedCondition = (getStopOrderStatus() == SCT_OSC_CANCELED || getTargetOrderStatus() == SCT_OSC_CANCELED) && priceCondition;
     if (activeCondition) {
@@ -35,118 +56,157 @@ TradeWrapper::TradeWrapper(
 
 
 void TradeWrapper::updateAll(SCStudyInterfaceRef sc, const int i) {
+    LATENCY_PROBE("TradeWrapper::updateAll");
     fetchAndUpdateOrders(sc);
     if (getRealStatus(i) != TradeStatus::Active) {return;}
     
     // Initialize fill price once we have valid order data
-    fillPrice = parentOrder.Price1;
-    targetPrice = targetOrder.Price1;
-    stopPrice = stopOrder.Price1;
-
-    // Calculate price difference from fill price
-    double currentPriceDifference = 0.0;
-    double price;
-    switch (parentOrderDirection) {
-        case BSE_BUY:
-            price = std::max<double>(sc.High[i], sc.Close[i]);
-            currentPriceDifference = price - fillPrice;
-            maxFavorablePriceDifference = std::max<double>(maxFavorablePriceDifference, currentPriceDifference);
-            break;
-        case BSE_SELL:
-            price = std::max<double>(sc.Low[i], sc.Close[i]);
-            currentPriceDifference = fillPrice - price;
-            maxFavorablePriceDifference = std::max<double>(maxFavorablePriceDifference, currentPriceDifference);
-            break;
-        case BSE_UNDEFINED:
-            break;
+    fillPrice = orders.parent.price1Ticks;
+    targetPrice = orders.target.price1Ticks;
+    stopPrice = orders.stop.price1Ticks;
+    const bool entryBar = !hasBracketPrices;
+    if (entryBar) {
+        hasBracketPrices = true;
+        journal(sc, JournalEvent::Entry, i, fillPrice);
     }
+
+    // Favorable and adverse excursions from the fill price, from the bar's extremes in and against the trade's direction.
+    // The part of the entry bar against the trade may precede the fill, only its close counts there. The favorable
+    // price of a short is max(Low, Close) as it always was, i.e. the close
+    withSide(parentOrderDirection, [&](auto side) {
+        using S = decltype(side);
+        const PriceTicks best = toTicks(sc, std::max(S::pick(sc.High[i], sc.Low[i]), sc.Close[i]));
+        const PriceTicks worst = toTicks(sc, entryBar ? sc.Close[i] : S::pick(sc.Low[i], sc.High[i]));
+        maxFavorablePriceDifference = std::max(maxFavorablePriceDifference, S::gain(fillPrice, best));
+        maxAdversePriceDifference = std::max(maxAdversePriceDifference, -S::gain(fillPrice, worst));
+    });
     
     // Check for new plateau and update stops/targets accordingly
-    updatePlateau();
+    if (updatePlateau()) {
+        journal(sc, JournalEvent::PlateauStep, i, toTicks(sc, sc.Close[i]));
+    }
 }
 
 void TradeWrapper::updateStopTargetPrice() {
-    switch (parentOrderDirection) {
-        case BSE_BUY:
-            stopPrice = stopPrice + currentPlateau * constPlateauSize;
-            targetPrice = targetPrice + currentPlateau * constPlateauSize;
-            break;
-
-        case BSE_SELL:
-            stopPrice = stopPrice - currentPlateau * constPlateauSize;
-            targetPrice = targetPrice - currentPlateau * constPlateauSize;
-            break;
-
-        case BSE_UNDEFINED:
-            break;
-    }
+    withSide(parentOrderDirection, [&](auto side) {
+        using S = decltype(side);
+        stopPrice = S::offset(stopPrice, currentPlateau * constPlateauSize);
+        targetPrice = S::offset(targetPrice, currentPlateau * constPlateauSize);
+    });
 }
 
 
-void TradeWrapper::updatePlateau() {
-    if (const int newPlateau = static_cast<int>(maxFavorablePriceDifference / constPlateauSize) + 1; newPlateau > currentPlateau) {
+bool TradeWrapper::updatePlateau() {
+    if (const int newPlateau = maxFavorablePriceDifference / constPlateauSize + 1; newPlateau > currentPlateau) {
         currentPlateau = newPlateau;
         updateStopTargetPrice();
+        return true;
     }
+    return false;
 }
 
-int TradeWrapper::flattenOrder(SCStudyInterfaceRef sc, const double price) const {
+int TradeWrapper::flattenOrder(SCStudyInterfaceRef sc, const PriceTicks price) const {
     if (targetMode == TargetMode::Flat) {
         bool flattenPosition = false;
-        switch (getParentOrderDirection()) {
-            case BSE_BUY:
-                flattenPosition = price >= targetPrice; break;
-            case BSE_SELL:
-                flattenPosition = price <= targetPrice; break;
-            case BSE_UNDEFINED:
-                break;
-
-        }
-        if (flattenPosition && targetPrice != 0.0) { // Make sure it's not cancelled right after object creation
+        withSide(getParentOrderDirection(), [&](auto side) {
+            flattenPosition = decltype(side)::reached(price, targetPrice);
+        });
+        if (flattenPosition && hasBracketPrices) { // Make sure it's not cancelled right after object creation
+            LATENCY_PROBE("sc.CancelOrder");
             return sc.CancelOrder(parentOrderId);
         }
     }
     return -1;
 }
 
-int TradeWrapper::modifyStopTargetOrders(SCStudyInterfaceRef sc, const int i) const {
-    int success = 0;
-    if (getRealStatus(i) == TradeStatus::Active) {
-        s_SCNewOrder modifyStopOrder;
-        s_SCNewOrder modifyTargetOrder;
+int TradeWrapper::modifyStopTargetOrders(SCStudyInterfaceRef sc, const int i) {
+    if (getRealStatus(i) != TradeStatus::Active) {return 0;}
+    OrderModifyQueue& modifications = getOrderModifyQueue(sc);
+    modifications.request(orders.target, parentOrderId, targetPrice);
+    modifications.request(orders.stop, parentOrderId, stopPrice);
+    // Journaled once per new pair of prices, not on every update while the queue holds it back
+    const bool moved = stopPrice != orders.stop.price1Ticks || targetPrice != orders.target.price1Ticks;
+    if (moved && (stopPrice != journaledStop || targetPrice != journaledTarget)) {
+        journaledStop = stopPrice;
+        journaledTarget = targetPrice;
+        journal(sc, JournalEvent::Modify, i, toTicks(sc, sc.Close[i]));
+    }
+    return 2;
+}
 
-        modifyTargetOrder.InternalOrderID = targetOrder.InternalOrderID;
-        modifyTargetOrder.Price1 = targetPrice;
-        success += sc.ModifyOrder(modifyTargetOrder);
+void TradeWrapper::journal(SCStudyInterfaceRef sc, const JournalEvent event, const int barIndex,
+                           const PriceTicks price) const {
+    JournalRow row;
+    row.tradeId = parentOrderId;
+    row.barIndex = barIndex;
+    row.price = price;
+    row.fillPrice = fillPrice;
+    row.stopPrice = stopPrice;
+    row.targetPrice = targetPrice;
+    row.maxFavorable = maxFavorablePriceDifference;
+    row.maxAdverse = maxAdversePriceDifference;
+    row.plateau = static_cast<int16_t>(currentPlateau);
+    row.event = event;
+    row.direction = static_cast<int8_t>(parentOrderDirection == BSE_BUY ? 1 : -1);
+    journalTradeRow(sc, row);
+}
 
-        modifyStopOrder.InternalOrderID = stopOrder.InternalOrderID;
-        modifyStopOrder.Price1 = stopPrice;
-        success += sc.ModifyOrder(modifyStopOrder);
+void TradeWrapper::journalExit(SCStudyInterfaceRef sc, const int barIndex) const {
+    if (!hasBracketPrices) {return;}
+    PriceTicks exitPrice = toTicks(sc, sc.Close[barIndex]);
+    if (orders.target.status == SCT_OSC_FILLED) {
+        exitPrice = orders.target.price1Ticks;
+    } else if (orders.stop.status == SCT_OSC_FILLED) {
+        exitPrice = orders.stop.price1Ticks;
     }
-    return success;
+    journal(sc, JournalEvent::Exit, barIndex, exitPrice);
 }
 
 int TradeWrapper::fetchAndUpdateOrders(SCStudyInterfaceRef sc) {
-    const int successParent = sc.GetOrderByOrderID(parentOrderId, parentOrder);
-    const int successStop = sc.GetOrderByOrderID(parentOrder.StopChildInternalOrderID, stopOrder);
-    const int successTarget = sc.GetOrderByOrderID(parentOrder.TargetChildInternalOrderID, targetOrder);
-    return successParent + successStop + successTarget;
+    if (!getOrderStateCache(sc).getBracket(sc, parentOrderId, orders)) {return 0;}
+    return 1 + (orders.stop.internalOrderId != 0 ? 1 : 0) + (orders.target.internalOrderId != 0 ? 1 : 0);
 }
 
-[[nodiscard]] double TradeWrapper::getFilledPrice() const {return fillPrice;}
+[[nodiscard]] int64_t TradeWrapper::getParentOrderId() const {return parentOrderId;}
+
+[[nodiscard]] int64_t TradeWrapper::getStopOrderId() const {return orders.stop.internalOrderId;}
+
+[[nodiscard]] int64_t TradeWrapper::getTargetOrderId() const {return orders.target.internalOrderId;}
+
+[[nodiscard]] PriceTicks TradeWrapper::getFilledPrice() const {return fillPrice;}
 
-[[nodiscard]] double TradeWrapper::getMaxFavorablePriceDifference() const {return maxFavorablePriceDifference;}
+[[nodiscard]] PriceTicks TradeWrapper::getMaxFavorablePriceDifference() const {return maxFavorablePriceDifference;}
 
-[[nodiscard]] BuySellEnum TradeWrapper::getParentOrderDirection() const {return parentOrder.BuySell;}
+[[nodiscard]] PriceTicks TradeWrapper::getMaxAdversePriceDifference() const {return maxAdversePriceDifference;}
+
+[[nodiscard]] BuySellEnum TradeWrapper::getParentOrderDirection() const {return orders.parent.buySell;}
 
 
 [[nodiscard]] SCOrderStatusCodeEnum TradeWrapper::getTargetOrderStatus() const {
-    return targetOrder.OrderStatusCode;
+    return orders.target.status;
 }
 
 [[nodiscard]] SCOrderStatusCodeEnum TradeWrapper::getStopOrderStatus() const {
-    return stopOrder.OrderStatusCode;
+    return orders.stop.status;
 }
 
 
 
+
+[[nodiscard]] TradeWrapperState TradeWrapper::getState() const {
+    TradeWrapperState state{};
+    state.parentOrderId = parentOrderId;
+    state.createdIndex = createdIndex;
+    state.expirationBars = expirationBars;
+    state.parentOrderDirection = parentOrderDirection;
+    state.targetMode = static_cast<int32_t>(targetMode);
+    state.hasBracketPrices = hasBracketPrices ? 1 : 0;
+    state.fillPrice = fillPrice;
+    state.maxFavorablePriceDifference = maxFavorablePriceDifference;
+    state.targetPrice = targetPrice;
+    state.stopPrice = stopPrice;
+    state.constPlateauSize = constPlateauSize;
+    state.currentPlateau = currentPlateau;
+    state.maxAdversePriceDifference = maxAdversePriceDifference;
+    return state;
+}
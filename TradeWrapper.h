@@ -1,16 +1,39 @@
 #ifndef TRADEWRAPPER_H
 #define TRADEWRAPPER_H
 
+#include "OrderStateCache.h"
+#include "PriceTicks.h"
+#include "TradeJournal.h"
 #include "sierrachart.h"
 
 enum class TargetMode { Flat, Evolving };
 
 enum class TradeStatus {Terminated, Active, Other, Expired};
 
+// What a trade carries between updates as saved in a state snapshot, the orders are read again from the trade service
+struct TradeWrapperState {
+    int64_t parentOrderId;
+    int32_t createdIndex;
+    int32_t expirationBars;
+    int32_t parentOrderDirection;  // BuySellEnum
+    int32_t targetMode;            // TargetMode
+    int32_t hasBracketPrices;
+    PriceTicks fillPrice;
+    PriceTicks maxFavorablePriceDifference;
+    PriceTicks targetPrice;
+    PriceTicks stopPrice;
+    PriceTicks constPlateauSize;
+    int32_t currentPlateau;
+    PriceTicks maxAdversePriceDifference;
+};
+
 class TradeWrapper {
 
 public:
-    TradeWrapper(int64_t parentId, int createdIndex, TargetMode mode, BuySellEnum dir, double constPlateauSize, int expirationBars = 10);
+    // Prices are held in ticks, constPlateauSize included
+    TradeWrapper(int64_t parentId, int createdIndex, TargetMode mode, BuySellEnum dir, PriceTicks constPlateauSize, int expirationBars = 10);
+    // A trade restored from a state snapshot
+    explicit TradeWrapper(const TradeWrapperState& state);
 
     // Setters
     int fetchAndUpdateOrders(SCStudyInterfaceRef sc);
@@ -19,12 +42,21 @@ public:
 
     void updateStopTargetPrice();
 
-    void updatePlateau();
+    // True when the trade stepped up to a new plateau
+    bool updatePlateau();
 
     // Getters
-    [[nodiscard]] double getFilledPrice() const;
+    [[nodiscard]] int64_t getParentOrderId() const;
+
+    [[nodiscard]] int64_t getStopOrderId() const;
+
+    [[nodiscard]] int64_t getTargetOrderId() const;
 
-    [[nodiscard]] double getMaxFavorablePriceDifference() const;
+    [[nodiscard]] PriceTicks getFilledPrice() const;
+
+    [[nodiscard]] PriceTicks getMaxFavorablePriceDifference() const;
+
+    [[nodiscard]] PriceTicks getMaxAdversePriceDifference() const;
 
     [[nodiscard]] TradeStatus getRealStatus(int index) const;
 
@@ -34,9 +66,18 @@ public:
 
     [[nodiscard]] SCOrderStatusCodeEnum getTargetOrderStatus() const;
 
+    [[nodiscard]] TradeWrapperState getState() const;
+
     // Sierra Chart ops
-    int flattenOrder(SCStudyInterfaceRef sc, double price) const;
-    int modifyStopTargetOrders(SCStudyInterfaceRef sc, int i) const;
+    int flattenOrder(SCStudyInterfaceRef sc, PriceTicks price) const;
+    // Queues the stop/target prices on the study's modification queue (sent by its next flush), returns the orders queued
+    int modifyStopTargetOrders(SCStudyInterfaceRef sc, int i);
+
+    // Appends the trade as it stands to the study's trade journal
+    void journal(SCStudyInterfaceRef sc, JournalEvent event, int barIndex, PriceTicks price) const;
+    // Journals the exit at the price of the child order that filled, the bar's close when neither did. Trades that
+    // never got their bracket have no entry in the journal and are skipped
+    void journalExit(SCStudyInterfaceRef sc, int barIndex) const;
 
 private:
     const int64_t parentOrderId;
@@ -44,14 +85,16 @@ private:
     const int expirationBars;
     const BuySellEnum parentOrderDirection;
     TargetMode targetMode;
-    s_SCTradeOrder parentOrder;
-    s_SCTradeOrder stopOrder;
-    s_SCTradeOrder targetOrder;
-    double fillPrice;
-    double maxFavorablePriceDifference;  // Price difference from fill price (starts at 0)
-    double targetPrice;
-    double stopPrice;
-    double constPlateauSize;
+    BracketSnapshot orders;  // Parent, stop and target as last read from the study's order state cache
+    bool hasBracketPrices;  // Fill, target and stop were read from an active bracket at least once
+    PriceTicks fillPrice;
+    PriceTicks maxFavorablePriceDifference;  // Price difference from fill price (starts at 0)
+    PriceTicks maxAdversePriceDifference;    // Same against the trade, positive
+    PriceTicks targetPrice;
+    PriceTicks stopPrice;
+    PriceTicks constPlateauSize;
     int currentPlateau;  // Current ATR plateau level
+    PriceTicks journaledStop = 0;    // Stop/target of the last Modify in the journal
+    PriceTicks journaledTarget = 0;
 };
 #endif //TRADEWRAPPER_H
\ No newline at end of file
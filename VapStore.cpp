@@ -0,0 +1,188 @@
+#include "VapStore.h"
+
+#include <algorithm>
+
+
+void VapStore::addTrade(const int barIndex, const PriceTicks priceInTicks, const uint32_t volume, const bool atAsk) {
+    if (barIndex < 0) {return;}
+    BarRun& run = runFor(barIndex);
+    cover(run, priceInTicks, priceInTicks);
+    const uint32_t at = run.first + static_cast<uint32_t>(priceInTicks - run.lowTicks);
+    (atAsk ? askVolume : bidVolume)[at] += volume;
+}
+
+void VapStore::syncBar(SCStudyInterfaceRef sc, const int barIndex) {
+    if (barIndex < 0 || barIndex >= sc.ArraySize) {return;}
+    BarRun& run = runFor(barIndex);
+    if (run.finalized) {return;}
+
+    if (const float volume = sc.Volume[barIndex]; volume != run.seenVolume) {
+        const int vapCount = static_cast<int>(sc.VolumeAtPriceForBars->GetSizeAtBarIndex(barIndex));
+        const s_VolumeAtPriceV2* lowest = nullptr;
+        const s_VolumeAtPriceV2* highest = nullptr;
+        // Elements are sorted by price
+        if (vapCount > 0 && sc.VolumeAtPriceForBars->GetVAPElementAtIndex(barIndex, 0, &lowest)
+            && sc.VolumeAtPriceForBars->GetVAPElementAtIndex(barIndex, vapCount - 1, &highest)) {
+            cover(run, lowest->PriceInTicks, highest->PriceInTicks);
+            const s_VolumeAtPriceV2* pVAP = nullptr;
+            for (int i = 0; i < vapCount; ++i) {
+                if (sc.VolumeAtPriceForBars->GetVAPElementAtIndex(barIndex, i, &pVAP)) {
+                    const uint32_t at = run.first + static_cast<uint32_t>(pVAP->PriceInTicks - run.lowTicks);
+                    bidVolume[at] = pVAP->BidVolume;
+                    askVolume[at] = pVAP->AskVolume;
+                }
+            }
+        }
+        run.seenVolume = volume;
+    }
+    // Only the last bar can still receive volume
+    run.finalized = barIndex < sc.ArraySize - 1;
+}
+
+void VapStore::reset() {
+    bars.clear();
+    bidVolume.clear();
+    askVolume.clear();
+}
+
+const VapStore::BarRun* VapStore::runAt(const int barIndex) const {
+    if (barIndex < 0 || barIndex >= static_cast<int>(bars.size()) || bars[barIndex].levels == 0) {return nullptr;}
+    return &bars[barIndex];
+}
+
+VapStore::BarRun& VapStore::runFor(const int barIndex) {
+    if (static_cast<int>(bars.size()) <= barIndex) {
+        bars.resize(barIndex + 1);
+    }
+    return bars[barIndex];
+}
+
+void VapStore::cover(BarRun& run, PriceTicks lowTicks, PriceTicks highTicks) {
+    if (run.levels != 0) {
+        if (lowTicks >= run.lowTicks && highTicks < run.lowTicks + static_cast<PriceTicks>(run.levels)) {return;}
+        lowTicks = std::min(lowTicks, run.lowTicks);
+        highTicks = std::max(highTicks, run.lowTicks + static_cast<PriceTicks>(run.levels) - 1);
+    }
+    const auto levels = static_cast<uint32_t>(highTicks - lowTicks + 1);
+    const auto shift = run.levels == 0 ? 0u : static_cast<uint32_t>(run.lowTicks - lowTicks);
+    const bool atEnd = run.levels != 0 && run.first + run.levels == bidVolume.size();
+    const uint32_t first = atEnd ? run.first : static_cast<uint32_t>(bidVolume.size());
+    bidVolume.resize(first + levels, 0);
+    askVolume.resize(first + levels, 0);
+    // Destination is never below the source, copying from the top keeps an in place move intact
+    for (std::vector<uint32_t>* column : {&bidVolume, &askVolume}) {
+        const auto source = column->begin() + run.first;
+        std::copy_backward(source, source + run.levels, column->begin() + first + shift + run.levels);
+        std::fill(column->begin() + first, column->begin() + first + shift, 0u);
+    }
+    run.lowTicks = lowTicks;
+    run.first = first;
+    run.levels = levels;
+}
+
+int VapStore::getBarCount() const {return static_cast<int>(bars.size());}
+
+VapLadder VapStore::ladder(const int barIndex) const {
+    const BarRun* run = runAt(barIndex);
+    if (run == nullptr) {return {};}
+    return {run->lowTicks, {bidVolume.data() + run->first, run->levels}, {askVolume.data() + run->first, run->levels}};
+}
+
+bool VapStore::isClean(const int barIndex, const PriceTicks priceInTicks, const int minVolume) const {
+    const BarRun* run = runAt(barIndex);
+    if (run == nullptr || priceInTicks < run->lowTicks) {return false;}
+    const auto offset = static_cast<uint32_t>(priceInTicks - run->lowTicks);
+    const auto threshold = static_cast<uint32_t>(minVolume);
+    return offset < run->levels
+           && bidVolume[run->first + offset] > threshold && askVolume[run->first + offset] > threshold;
+}
+
+bool VapStore::cleanRange(const int barIndex, const int minVolume, PriceTicks& lowTicks, PriceTicks& highTicks) const {
+    const BarRun* run = runAt(barIndex);
+    if (run == nullptr) {return false;}
+    const uint32_t* bid = bidVolume.data() + run->first;
+    const uint32_t* ask = askVolume.data() + run->first;
+    const auto threshold = static_cast<uint32_t>(minVolume);
+    uint32_t low = 0;
+    while (low < run->levels && (bid[low] <= threshold || ask[low] <= threshold)) {++low;}
+    if (low == run->levels) {return false;}
+    uint32_t high = run->levels - 1;
+    while (bid[high] <= threshold || ask[high] <= threshold) {--high;}
+    lowTicks = run->lowTicks + static_cast<PriceTicks>(low);
+    highTicks = run->lowTicks + static_cast<PriceTicks>(high);
+    return true;
+}
+
+int VapStore::cleanCount(const int barIndex, const int minVolume) const {
+    const BarRun* run = runAt(barIndex);
+    if (run == nullptr) {return 0;}
+    const uint32_t* bid = bidVolume.data() + run->first;
+    const uint32_t* ask = askVolume.data() + run->first;
+    const auto threshold = static_cast<uint32_t>(minVolume);
+    int count = 0;
+    for (uint32_t k = 0; k < run->levels; ++k) {
+        count += (bid[k] > threshold) & (ask[k] > threshold);
+    }
+    return count;
+}
+
+int64_t VapStore::delta(const int barIndex) const {
+    const BarRun* run = runAt(barIndex);
+    if (run == nullptr) {return 0;}
+    const uint32_t* bid = bidVolume.data() + run->first;
+    const uint32_t* ask = askVolume.data() + run->first;
+    int64_t sum = 0;
+    for (uint32_t k = 0; k < run->levels; ++k) {
+        sum += static_cast<int64_t>(ask[k]) - static_cast<int64_t>(bid[k]);
+    }
+    return sum;
+}
+
+void VapStore::imbalanceCounts(const int barIndex, const float ratio, int& buying, int& selling) const {
+    buying = 0;
+    selling = 0;
+    const BarRun* run = runAt(barIndex);
+    if (run == nullptr) {return;}
+    const uint32_t* bid = bidVolume.data() + run->first;
+    const uint32_t* ask = askVolume.data() + run->first;
+    for (uint32_t k = 1; k < run->levels; ++k) {
+        // ask[k] against bid[k - 1] and bid[k - 1] against ask[k] are the two diagonals of the same pair of ticks
+        const auto up = static_cast<float>(ask[k]);
+        const auto down = static_cast<float>(bid[k - 1]);
+        buying += (ask[k] != 0) & (up >= ratio * down);
+        selling += (bid[k - 1] != 0) & (down >= ratio * up);
+    }
+}
+
+void VapStore::aggregate(int firstBar, int lastBar, VapProfile& profile) const {
+    profile.bidVolume.clear();
+    profile.askVolume.clear();
+    firstBar = std::max(firstBar, 0);
+    lastBar = std::min(lastBar, getBarCount() - 1);
+    PriceTicks lowTicks = 0, highTicks = 0;
+    bool any = false;
+    for (int i = firstBar; i <= lastBar; ++i) {
+        if (const BarRun* run = runAt(i); run != nullptr) {
+            const PriceTicks top = run->lowTicks + static_cast<PriceTicks>(run->levels) - 1;
+            lowTicks = any ? std::min(lowTicks, run->lowTicks) : run->lowTicks;
+            highTicks = any ? std::max(highTicks, top) : top;
+            any = true;
+        }
+    }
+    profile.lowTicks = lowTicks;
+    if (!any) {return;}
+    profile.bidVolume.resize(highTicks - lowTicks + 1, 0);
+    profile.askVolume.resize(highTicks - lowTicks + 1, 0);
+    for (int i = firstBar; i <= lastBar; ++i) {
+        const BarRun* run = runAt(i);
+        if (run == nullptr) {continue;}
+        const uint32_t* bid = bidVolume.data() + run->first;
+        const uint32_t* ask = askVolume.data() + run->first;
+        uint64_t* bidSum = profile.bidVolume.data() + (run->lowTicks - lowTicks);
+        uint64_t* askSum = profile.askVolume.data() + (run->lowTicks - lowTicks);
+        for (uint32_t k = 0; k < run->levels; ++k) {
+            bidSum[k] += bid[k];
+            askSum[k] += ask[k];
+        }
+    }
+}
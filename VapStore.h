@@ -0,0 +1,75 @@
+#ifndef VAPSTORE_H
+#define VAPSTORE_H
+
+#include "PriceTicks.h"
+#include "sierrachart.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Volume of every tick between lowTicks and the top of a bar range, index 0 is lowTicks
+struct VapLadder {
+    PriceTicks lowTicks = 0;
+    std::span<const uint32_t> bidVolume;
+    std::span<const uint32_t> askVolume;
+};
+
+// Bid/ask volume summed over a range of bars, same layout as a VapLadder
+struct VapProfile {
+    PriceTicks lowTicks = 0;
+    std::vector<uint64_t> bidVolume;
+    std::vector<uint64_t> askVolume;
+};
+
+/*
+ * Volume at price of every bar in structure of arrays form: one bid and one ask volume column shared by all bars,
+ * each bar owns a dense run of them indexed by tick offset from its low, empty ticks included. Scans walk plain
+ * uint32 arrays instead of going through the VAP container one s_VolumeAtPriceV2 at a time.
+ * Filled either from a tick stream (addTrade, no Sierra container needed) or from sc.VolumeAtPriceForBars (syncBar).
+ */
+class VapStore {
+
+public:
+    // One trade of volume at priceInTicks, at the ask when it lifted the offer
+    void addTrade(int barIndex, PriceTicks priceInTicks, uint32_t volume, bool atAsk);
+
+    // Copies barIndex from the VAP container, a no-op when the bar's volume did not move. Finished bars are frozen.
+    void syncBar(SCStudyInterfaceRef sc, int barIndex);
+
+    void reset();
+
+    // Getters
+    [[nodiscard]] int getBarCount() const;
+    [[nodiscard]] VapLadder ladder(int barIndex) const;
+    [[nodiscard]] bool isClean(int barIndex, PriceTicks priceInTicks, int minVolume = 0) const;
+    // Lowest and highest tick with both bid and ask volume above minVolume, false when the bar has none
+    [[nodiscard]] bool cleanRange(int barIndex, int minVolume, PriceTicks& lowTicks, PriceTicks& highTicks) const;
+    [[nodiscard]] int cleanCount(int barIndex, int minVolume = 0) const;
+    // Ask volume minus bid volume over the bar
+    [[nodiscard]] int64_t delta(int barIndex) const;
+    // Diagonal imbalances: ask at a tick against bid one tick below (buying), bid against ask one tick above (selling)
+    void imbalanceCounts(int barIndex, float ratio, int& buying, int& selling) const;
+    // Sums firstBar..lastBar into profile, which is resized to cover all of their ranges
+    void aggregate(int firstBar, int lastBar, VapProfile& profile) const;
+
+private:
+    // Runs of every bar live back to back in the columns, a bar that needs to grow is moved to the end
+    struct BarRun {
+        PriceTicks lowTicks = 0;
+        uint32_t first = 0;
+        uint32_t levels = 0;
+        float seenVolume = -1;
+        bool finalized = false;
+    };
+
+    [[nodiscard]] const BarRun* runAt(int barIndex) const;
+    BarRun& runFor(int barIndex);
+    void cover(BarRun& run, PriceTicks lowTicks, PriceTicks highTicks);
+
+    std::vector<BarRun> bars;
+    std::vector<uint32_t> bidVolume;
+    std::vector<uint32_t> askVolume;
+};
+
+#endif //VAPSTORE_H
@@ -1,88 +1,420 @@
 #include "helpers.h"
+#include "BarChangeTracker.h"
+#include "CleanRangeTracker.h"
+#include "CleanTickIndex.h"
+#include "LatencyProbe.h"
+#include "MacdKernel.h"
+#include "OrderModifyQueue.h"
+#include "OrderStateCache.h"
+#include "PeakValleyIndex.h"
+#include "RollingExtrema.h"
+#include "SessionCalendar.h"
+#include "SignalBus.h"
+#include "StudyArrayBindings.h"
+#include "TradeEventLog.h"
+#include "TradeJournal.h"
+#include "TradeManager.h"
+#include "VapStore.h"
 #include "sierrachart.h"
 
+#include <chrono>
+#include <filesystem>
+#include <deque>
+#include <map>
+
+
+namespace {
+
+// One T per volume threshold the calling study asks about. That is almost always a single one, found first
+template <typename T>
+class ByMinVolume {
+
+public:
+    T& get(const int minVolume) {
+        for (T& entry : entries) {
+            if (entry.getMinVolume() == minVolume) {return entry;}
+        }
+        return entries.emplace_back(minVolume);
+    }
+
+    void reset() {
+        for (T& entry : entries) {entry.reset();}
+    }
+
+private:
+    std::deque<T> entries;  // References stay valid as thresholds are added
+};
+
+using CleanTickIndexes = ByMinVolume<CleanTickIndex>;
+using CleanRangeTrackers = ByMinVolume<CleanRangeTracker>;
+
+// Keyed by study ID and profile index
+using PeakValleyIndexes = std::map<std::pair<int, int>, PeakValleyIndex>;
+
+}
+
+void releaseHelperState(SCStudyInterfaceRef sc) {
+    LATENCY_PROBE_FLUSH();
+    delete static_cast<CleanTickIndexes*>(sc.GetPersistentPointer(PP_CLEAN_TICK_INDEX));
+    sc.SetPersistentPointer(PP_CLEAN_TICK_INDEX, nullptr);
+    delete static_cast<CleanRangeTrackers*>(sc.GetPersistentPointer(PP_CLEAN_RANGE_TRACKER));
+    sc.SetPersistentPointer(PP_CLEAN_RANGE_TRACKER, nullptr);
+    delete static_cast<BarExtremaRuns*>(sc.GetPersistentPointer(PP_BAR_EXTREMA_RUNS));
+    sc.SetPersistentPointer(PP_BAR_EXTREMA_RUNS, nullptr);
+    delete static_cast<StudyArrayBindings*>(sc.GetPersistentPointer(PP_STUDY_ARRAY_BINDINGS));
+    sc.SetPersistentPointer(PP_STUDY_ARRAY_BINDINGS, nullptr);
+    delete static_cast<OrderStateCache*>(sc.GetPersistentPointer(PP_ORDER_STATE_CACHE));
+    sc.SetPersistentPointer(PP_ORDER_STATE_CACHE, nullptr);
+    delete static_cast<OrderModifyQueue*>(sc.GetPersistentPointer(PP_ORDER_MODIFY_QUEUE));
+    sc.SetPersistentPointer(PP_ORDER_MODIFY_QUEUE, nullptr);
+    delete static_cast<TradeManager*>(sc.GetPersistentPointer(PP_TRADE_MANAGER));
+    sc.SetPersistentPointer(PP_TRADE_MANAGER, nullptr);
+    delete static_cast<SessionCalendar*>(sc.GetPersistentPointer(PP_SESSION_CALENDAR));
+    sc.SetPersistentPointer(PP_SESSION_CALENDAR, nullptr);
+    delete static_cast<BarChangeTracker*>(sc.GetPersistentPointer(PP_BAR_CHANGE_TRACKER));
+    sc.SetPersistentPointer(PP_BAR_CHANGE_TRACKER, nullptr);
+    delete static_cast<PeakValleyIndexes*>(sc.GetPersistentPointer(PP_PEAK_VALLEY_INDEX));
+    sc.SetPersistentPointer(PP_PEAK_VALLEY_INDEX, nullptr);
+    delete static_cast<VapStore*>(sc.GetPersistentPointer(PP_VAP_STORE));
+    sc.SetPersistentPointer(PP_VAP_STORE, nullptr);
+    delete static_cast<MacdKernel*>(sc.GetPersistentPointer(PP_MACD_KERNEL));
+    sc.SetPersistentPointer(PP_MACD_KERNEL, nullptr);
+    delete static_cast<SignalBusWriter*>(sc.GetPersistentPointer(PP_SIGNAL_BUS_WRITER));
+    sc.SetPersistentPointer(PP_SIGNAL_BUS_WRITER, nullptr);
+    delete static_cast<SignalBusSubscriber*>(sc.GetPersistentPointer(PP_SIGNAL_BUS_SUBSCRIBER));
+    sc.SetPersistentPointer(PP_SIGNAL_BUS_SUBSCRIBER, nullptr);
+    delete static_cast<TradeJournalWriter*>(sc.GetPersistentPointer(PP_TRADE_JOURNAL));
+    sc.SetPersistentPointer(PP_TRADE_JOURNAL, nullptr);
+    // Joins the writer once it has drained what the study pushed
+    delete static_cast<TradeEventLog*>(sc.GetPersistentPointer(PP_TRADE_EVENT_LOG));
+    sc.SetPersistentPointer(PP_TRADE_EVENT_LOG, nullptr);
+}
+
+bool isFullRecalculationStart(SCStudyInterfaceRef sc) {
+    return sc.IsFullRecalculation && (!sc.AutoLoop || sc.Index == 0);
+}
+
+void applyAutoLoopInput(SCStudyInterfaceRef sc, const bool autoLoop) {
+    const bool lastCallOfRecalculation = sc.IsFullRecalculation && (!sc.AutoLoop || sc.Index == sc.ArraySize - 1);
+    if (!lastCallOfRecalculation || (sc.AutoLoop != 0) == autoLoop) {return;}
+    sc.AutoLoop = autoLoop ? 1 : 0;
+    sc.FlagFullRecalculate = 1;
+}
+
+void beginHelperUpdate(SCStudyInterfaceRef sc, const bool sendsOrders) {
+    // Under AutoLoop only the first call of a full recalculation starts over
+    if (!isFullRecalculationStart(sc)) {return;}
+    if (auto* indexes = static_cast<CleanTickIndexes*>(sc.GetPersistentPointer(PP_CLEAN_TICK_INDEX)); indexes != nullptr) {
+        indexes->reset();
+    }
+    if (auto* trackers = static_cast<CleanRangeTrackers*>(sc.GetPersistentPointer(PP_CLEAN_RANGE_TRACKER)); trackers != nullptr) {
+        trackers->reset();
+    }
+    if (auto* runs = static_cast<BarExtremaRuns*>(sc.GetPersistentPointer(PP_BAR_EXTREMA_RUNS)); runs != nullptr) {
+        runs->reset();
+    }
+    if (auto* bindings = static_cast<StudyArrayBindings*>(sc.GetPersistentPointer(PP_STUDY_ARRAY_BINDINGS)); bindings != nullptr) {
+        bindings->invalidate();
+    }
+    if (auto* orders = static_cast<OrderStateCache*>(sc.GetPersistentPointer(PP_ORDER_STATE_CACHE)); orders != nullptr) {
+        orders->clear();
+    }
+    if (auto* modifications = static_cast<OrderModifyQueue*>(sc.GetPersistentPointer(PP_ORDER_MODIFY_QUEUE)); modifications != nullptr) {
+        modifications->clear();
+    }
+    if (auto* trades = static_cast<TradeManager*>(sc.GetPersistentPointer(PP_TRADE_MANAGER)); trades != nullptr) {
+        trades->clear();
+    }
+    if (auto* calendar = static_cast<SessionCalendar*>(sc.GetPersistentPointer(PP_SESSION_CALENDAR)); calendar != nullptr) {
+        calendar->reset();
+    }
+    if (auto* barChanges = static_cast<BarChangeTracker*>(sc.GetPersistentPointer(PP_BAR_CHANGE_TRACKER)); barChanges != nullptr) {
+        barChanges->reset();
+    }
+    if (auto* indexes = static_cast<PeakValleyIndexes*>(sc.GetPersistentPointer(PP_PEAK_VALLEY_INDEX)); indexes != nullptr) {
+        for (auto& [key, peaksValleys] : *indexes) {peaksValleys.reset();}
+    }
+    if (auto* vap = static_cast<VapStore*>(sc.GetPersistentPointer(PP_VAP_STORE)); vap != nullptr) {
+        vap->reset();
+    }
+    if (auto* macd = static_cast<MacdKernel*>(sc.GetPersistentPointer(PP_MACD_KERNEL)); macd != nullptr) {
+        macd->reset();
+    }
+    // Opened here rather than by the first event, which comes from an order being sent
+    if (sendsOrders) {
+        getTradeEventLog(sc);
+    }
+}
+
+CleanTickIndex& getCleanTickIndex(SCStudyInterfaceRef sc, const int minVolume) {
+    auto* indexes = static_cast<CleanTickIndexes*>(sc.GetPersistentPointer(PP_CLEAN_TICK_INDEX));
+    if (indexes == nullptr) {
+        indexes = new CleanTickIndexes();
+        sc.SetPersistentPointer(PP_CLEAN_TICK_INDEX, indexes);
+    }
+    return indexes->get(minVolume);
+}
+
+CleanRangeTracker& getCleanRangeTracker(SCStudyInterfaceRef sc, const int minVolume) {
+    auto* trackers = static_cast<CleanRangeTrackers*>(sc.GetPersistentPointer(PP_CLEAN_RANGE_TRACKER));
+    if (trackers == nullptr) {
+        trackers = new CleanRangeTrackers();
+        sc.SetPersistentPointer(PP_CLEAN_RANGE_TRACKER, trackers);
+    }
+    return trackers->get(minVolume);
+}
+
+BarExtremaRuns* getBarExtremaRuns(SCStudyInterfaceRef sc) {
+    auto* runs = static_cast<BarExtremaRuns*>(sc.GetPersistentPointer(PP_BAR_EXTREMA_RUNS));
+    if (runs == nullptr) {
+        runs = new BarExtremaRuns();
+        sc.SetPersistentPointer(PP_BAR_EXTREMA_RUNS, runs);
+    }
+    return runs;
+}
+
+StudyArrayBindings& getStudyArrayBindings(SCStudyInterfaceRef sc) {
+    auto* bindings = static_cast<StudyArrayBindings*>(sc.GetPersistentPointer(PP_STUDY_ARRAY_BINDINGS));
+    if (bindings == nullptr) {
+        bindings = new StudyArrayBindings();
+        sc.SetPersistentPointer(PP_STUDY_ARRAY_BINDINGS, bindings);
+    }
+    return *bindings;
+}
+
+OrderStateCache& getOrderStateCache(SCStudyInterfaceRef sc) {
+    auto* orders = static_cast<OrderStateCache*>(sc.GetPersistentPointer(PP_ORDER_STATE_CACHE));
+    if (orders == nullptr) {
+        orders = new OrderStateCache();
+        sc.SetPersistentPointer(PP_ORDER_STATE_CACHE, orders);
+    }
+    return *orders;
+}
+
+OrderModifyQueue& getOrderModifyQueue(SCStudyInterfaceRef sc) {
+    auto* modifications = static_cast<OrderModifyQueue*>(sc.GetPersistentPointer(PP_ORDER_MODIFY_QUEUE));
+    if (modifications == nullptr) {
+        modifications = new OrderModifyQueue();
+        sc.SetPersistentPointer(PP_ORDER_MODIFY_QUEUE, modifications);
+    }
+    return *modifications;
+}
+
+TradeManager& getTradeManager(SCStudyInterfaceRef sc) {
+    auto* trades = static_cast<TradeManager*>(sc.GetPersistentPointer(PP_TRADE_MANAGER));
+    if (trades == nullptr) {
+        trades = new TradeManager();
+        sc.SetPersistentPointer(PP_TRADE_MANAGER, trades);
+    }
+    return *trades;
+}
+
+BarChangeTracker& getBarChangeTracker(SCStudyInterfaceRef sc) {
+    auto* barChanges = static_cast<BarChangeTracker*>(sc.GetPersistentPointer(PP_BAR_CHANGE_TRACKER));
+    if (barChanges == nullptr) {
+        barChanges = new BarChangeTracker();
+        sc.SetPersistentPointer(PP_BAR_CHANGE_TRACKER, barChanges);
+    }
+    return *barChanges;
+}
+
+PeakValleyIndex& getPeakValleyIndex(SCStudyInterfaceRef sc, const int studyId, const int profileIndex) {
+    auto* indexes = static_cast<PeakValleyIndexes*>(sc.GetPersistentPointer(PP_PEAK_VALLEY_INDEX));
+    if (indexes == nullptr) {
+        indexes = new PeakValleyIndexes();
+        sc.SetPersistentPointer(PP_PEAK_VALLEY_INDEX, indexes);
+    }
+    PeakValleyIndex& peaksValleys = indexes->try_emplace({studyId, profileIndex}, studyId, profileIndex).first->second;
+    peaksValleys.refresh(sc);
+    return peaksValleys;
+}
+
+VapStore& getVapStore(SCStudyInterfaceRef sc) {
+    auto* vap = static_cast<VapStore*>(sc.GetPersistentPointer(PP_VAP_STORE));
+    if (vap == nullptr) {
+        vap = new VapStore();
+        sc.SetPersistentPointer(PP_VAP_STORE, vap);
+    }
+    return *vap;
+}
+
+MacdKernel& getMacdKernel(SCStudyInterfaceRef sc) {
+    auto* macd = static_cast<MacdKernel*>(sc.GetPersistentPointer(PP_MACD_KERNEL));
+    if (macd == nullptr) {
+        macd = new MacdKernel();
+        sc.SetPersistentPointer(PP_MACD_KERNEL, macd);
+    }
+    return *macd;
+}
+
+SessionCalendar& getSessionCalendar(SCStudyInterfaceRef sc) {
+    auto* calendar = static_cast<SessionCalendar*>(sc.GetPersistentPointer(PP_SESSION_CALENDAR));
+    if (calendar == nullptr) {
+        calendar = new SessionCalendar();
+        sc.SetPersistentPointer(PP_SESSION_CALENDAR, calendar);
+    }
+    return *calendar;
+}
+
+void configureSessionCalendar(SCStudyInterfaceRef sc, const char* sessions, const char* exceptions) {
+    if (const int skipped = getSessionCalendar(sc).configure(sessions, exceptions); skipped > 0) {
+        SCString Buffer;
+        Buffer.Format("Session calendar: skipped %d unreadable session/holiday entries", skipped);
+        sc.AddMessageToLog(Buffer, 1);
+    }
+}
+
+TradeEventLog& getTradeEventLog(SCStudyInterfaceRef sc) {
+    auto* events = static_cast<TradeEventLog*>(sc.GetPersistentPointer(PP_TRADE_EVENT_LOG));
+    if (events == nullptr) {
+        SCString fileName;
+        fileName.Format("divergence_events_c%d_s%d.bin", sc.ChartNumber, sc.StudyGraphInstanceID);
+        const std::filesystem::path folder(sc.DataFilesFolder().GetChars());
+        events = new TradeEventLog((folder / fileName.GetChars()).string());
+        sc.SetPersistentPointer(PP_TRADE_EVENT_LOG, events);
+    }
+    return *events;
+}
+
+TradeJournalWriter& getTradeJournal(SCStudyInterfaceRef sc) {
+    auto* journal = static_cast<TradeJournalWriter*>(sc.GetPersistentPointer(PP_TRADE_JOURNAL));
+    if (journal == nullptr) {
+        journal = new TradeJournalWriter();
+        sc.SetPersistentPointer(PP_TRADE_JOURNAL, journal);
+        SCString fileName;
+        fileName.Format("divergence_journal_c%d_s%d.dvj", sc.ChartNumber, sc.StudyGraphInstanceID);
+        const std::filesystem::path folder(sc.DataFilesFolder().GetChars());
+        // Tried once per study instance, a journal that cannot be opened leaves the appends as no-ops
+        if (const std::string path = (folder / fileName.GetChars()).string(); !journal->open(path)) {
+            SCString Buffer;
+            Buffer.Format("Trade journal: cannot open %s", path.c_str());
+            sc.AddMessageToLog(Buffer, 1);
+        }
+    }
+    return *journal;
+}
+
+void journalTradeRow(SCStudyInterfaceRef sc, const JournalRow& row) {
+    JournalRow stamped = row;
+    stamped.timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    stamped.barDateTime = sc.BaseDateTimeIn[row.barIndex].GetAsDouble();
+    getTradeJournal(sc).append(stamped);
+}
+
+SignalBusWriter& getSignalBusWriter(SCStudyInterfaceRef sc, const char* channel) {
+    auto* bus = static_cast<SignalBusWriter*>(sc.GetPersistentPointer(PP_SIGNAL_BUS_WRITER));
+    if (bus == nullptr) {
+        bus = new SignalBusWriter();
+        sc.SetPersistentPointer(PP_SIGNAL_BUS_WRITER, bus);
+    }
+    if (const std::string path = signalBusPath(sc.DataFilesFolder().GetChars(), channel); path != bus->getPath()
+        && !bus->open(path)) {
+        SCString Buffer;
+        Buffer.Format("Signal bus: cannot open %s", path.c_str());
+        sc.AddMessageToLog(Buffer, 1);
+    }
+    return *bus;
+}
+
+SignalBusSubscriber& getSignalBusSubscriber(SCStudyInterfaceRef sc, const char* channel) {
+    auto* bus = static_cast<SignalBusSubscriber*>(sc.GetPersistentPointer(PP_SIGNAL_BUS_SUBSCRIBER));
+    if (bus == nullptr) {
+        bus = new SignalBusSubscriber();
+        sc.SetPersistentPointer(PP_SIGNAL_BUS_SUBSCRIBER, bus);
+    }
+    // Until the signal study creates the channel the reader keeps trying on every update
+    bus->subscribe(signalBusPath(sc.DataFilesFolder().GetChars(), channel));
+    return *bus;
+}
+
+void publishSignal(SCStudyInterfaceRef sc, SignalBusWriter& bus, const int barIndex, const float signal,
+                   const std::initializer_list<float> values) {
+    SignalRecord record{};
+    record.publishedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    record.barDateTime = sc.BaseDateTimeIn[barIndex].GetAsDouble();
+    record.barIndex = barIndex;
+    record.signal = static_cast<int32_t>(signal);
+    int k = 0;
+    for (const float value : values) {
+        if (k == 4) {break;}
+        record.values[k++] = value;
+    }
+    bus.publish(record);
+}
+
+void logTradeEvent(SCStudyInterfaceRef sc, const TradeEventType type, const int barIndex, const int64_t internalOrderId,
+                   const double price, const int64_t parentOrderId, const uint16_t detail) {
+    TradeEventRecord record;
+    record.timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    record.barDateTime = sc.BaseDateTimeIn[barIndex].GetAsDouble();
+    record.internalOrderId = internalOrderId;
+    record.parentOrderId = parentOrderId;
+    record.price = price;
+    record.barIndex = barIndex;
+    record.type = type;
+    record.detail = detail;
+    getTradeEventLog(sc).push(record);
+}
 
 bool IsCleanTick(const float priceOfInterest, SCStudyInterfaceRef sc, const int minVolume, const int offset) {
-    const int priceOfInterestInTicks = sc.PriceValueToTicks(priceOfInterest);
-    const s_VolumeAtPriceV2 elem = sc.VolumeAtPriceForBars->GetVAPElementAtPrice(sc.Index - offset, priceOfInterestInTicks);
+    LATENCY_PROBE("IsCleanTick");
+    return IsCleanTickAtBar(sc, sc.Index - offset, toTicks(sc, priceOfInterest), minVolume);
+}
 
-    const bool res = elem.BidVolume > minVolume & elem.AskVolume > minVolume;
-    return res;
+bool IsCleanTickAtBar(SCStudyInterfaceRef sc, const int barIndex, const PriceTicks priceOfInterestInTicks, const int minVolume) {
+    CleanTickIndex& index = getCleanTickIndex(sc, minVolume);
+    index.refresh(sc, barIndex);
+    return index.isClean(sc, barIndex, priceOfInterestInTicks);
 }
 
 bool tradingAllowedCash(SCStudyInterfaceRef sc) {
-    const int BarTime = sc.BaseDateTimeIn[sc.Index].GetTime();
-    const bool TradingAllowed = BarTime >= HMS_TIME(9,  30, 0) && BarTime  < HMS_TIME(15,  30, 0);
-    return TradingAllowed;
+    SessionCalendar& calendar = getSessionCalendar(sc);
+    calendar.extend(sc);
+    return (calendar.getState(sc.Index) & SessionCalendar::IN_SESSION) != 0;
 }
 
 void flattenAllAfterCash(SCStudyInterfaceRef sc) {
-    const int BarTime = sc.BaseDateTimeIn[sc.Index].GetTime();
-    const bool OutOfSession = BarTime < HMS_TIME(9,  30, 0) | BarTime  >= HMS_TIME(15,  30, 0);
-    if (OutOfSession) {
+    SessionCalendar& calendar = getSessionCalendar(sc);
+    calendar.extend(sc);
+    if (calendar.claimClose(sc.Index)) {
         sc.FlattenAndCancelAllOrders();
     }
 }
 
-void orderToLogs(SCStudyInterfaceRef sc, s_SCTradeOrder order, int mode) {
-    std::string message = "";
+void orderToLogs(SCStudyInterfaceRef sc, s_SCTradeOrder order) {
+    logTradeEvent(sc, TradeEventType::OrderState, sc.Index, order.InternalOrderID, order.Price1, order.ParentInternalOrderID,
+                  static_cast<uint16_t>(order.OrderStatusCode));
 }
 
 void highLowCleanPricesInBar(SCStudyInterfaceRef sc, double &minPrice, double &maxPrice, const int offset) {
-
-    // These will be the default values in case the bar has only unclean ticks
-    int L, H;
-    sc.VolumeAtPriceForStudy->GetHighAndLowPriceTicksForBarIndex(sc.Index, H, L);
-
-    const s_VolumeAtPriceV2* pVAP = nullptr; // pVAP points to a constant s_VolumeAtPriceV2
-    const int vapCount = static_cast<int>(sc.VolumeAtPriceForBars->GetSizeAtBarIndex(sc.Index - offset));
-
-    std::optional<int> tmpMin, tmpMax;
-    for (int i = 0; i < vapCount; ++i) {
-        if (sc.VolumeAtPriceForBars->GetVAPElementAtIndex(sc.Index, i, &pVAP)) {
-            if (!tmpMin.has_value() && !tmpMax.has_value() && pVAP->BidVolume > 0 and pVAP->AskVolume > 0) {
-                tmpMin = pVAP->PriceInTicks;
-                tmpMax = pVAP->PriceInTicks;
-            } else {
-                if (pVAP->BidVolume > 0 and pVAP->AskVolume > 0) {
-                    tmpMin = std::min<int>(tmpMin.value(), pVAP->PriceInTicks);
-                    tmpMax = std::max<int>(tmpMin.value(), pVAP->PriceInTicks);
-                }
-            }
-        }
-    }
-    if (!tmpMin.has_value() && !tmpMax.has_value()) {
-        tmpMin = L; tmpMax = H;
-    }
-    minPrice = sc.TicksToPriceValue(tmpMin.value());
-    maxPrice = sc.TicksToPriceValue(tmpMax.value());
+    PriceTicks L, H;
+    highLowCleanTicksInBar(sc, L, H, offset);
+    minPrice = toPrice(sc, L);
+    maxPrice = toPrice(sc, H);
 }
 
-void BidAskDiffBelowLowestPeak(SCStudyInterfaceRef sc, const int StudyId) {
-    float PeakValleyLinePrice= 0;
-    int PeakValleyType = 0;
-    int StartIndex = sc.Index;
-    int PeakValleyExtensionChartColumnEndIndex = 0;
-    int keep_going = 1;
-    int peakValleyIndex = 0;
-    float maxPeakValley = 0;
+void highLowCleanTicksInBar(SCStudyInterfaceRef sc, PriceTicks &minTicks, PriceTicks &maxTicks, const int offset) {
+    LATENCY_PROBE("highLowCleanPricesInBar");
+    const int barIndex = sc.Index - offset;
 
-    // get the first Peak/Valley line from the last volume by price profile
-    while (keep_going == 1) {
-        keep_going = sc.GetStudyPeakValleyLine(
-            sc.ChartNumber,
-            StudyId,
-            PeakValleyLinePrice,
-            PeakValleyType,
-            StartIndex,
-            PeakValleyExtensionChartColumnEndIndex,
-            sc.Index,
-            peakValleyIndex);
-        peakValleyIndex ++;
-        maxPeakValley = std::max<float>(maxPeakValley, PeakValleyLinePrice);
+    // Clean range kept up to date from the ladder ends, the bar range is the default when no level is clean
+    CleanRangeTracker& tracker = getCleanRangeTracker(sc);
+    tracker.refresh(sc, barIndex);
+    if (!tracker.getCleanRange(barIndex, minTicks, maxTicks)) {
+        sc.VolumeAtPriceForBars->GetHighAndLowPriceTicksForBarIndex(barIndex, maxTicks, minTicks);
     }
 }
 
+bool BidAskDiffBelowLowestPeak(SCStudyInterfaceRef sc, const int studyId, PriceTicks& lowestPeak) {
+    PeakValleyLine line{};
+    if (!getPeakValleyIndex(sc, studyId).lowest(PEAKVALLEYTYPE_PEAK, line)) {return false;}
+    lowestPeak = line.price;
+    return true;
+}
+
 void LogAttachedStop(int64_t parentKey, SCStudyInterfaceRef sc) {
     if (s_SCTradeOrder ParentOrder, StopOrder; sc.GetOrderByOrderID(parentKey, ParentOrder) == 1) {
         const int stopOrderSuccess = sc.GetOrderByOrderID(ParentOrder.StopChildInternalOrderID, StopOrder);
@@ -107,18 +439,14 @@ void ModifyAttachedStop(int64_t parentKey, double newStop, SCStudyInterfaceRef s
 }
 
 bool lowestOfNBars(SCStudyInterfaceRef sc, const int nBars, const int index) {
-    int target = 0;
-    for (int i = 0; i < nBars; i++) {
-        target += sc.Low[index] <= sc.Low[index - i] ? 1 : 0;
-    }
-    return target == nBars;
+    BarExtremaRuns* runs = getBarExtremaRuns(sc);
+    runs->update(sc, index);
+    return runs->isLowestOf(index, nBars);
 }
 
 
 bool highestOfNBars(SCStudyInterfaceRef sc, const int nBars, const int index) {
-    int target = 0;
-    for (int i = 0; i < nBars; i++) {
-        target += sc.High[index] >= sc.High[index - i] ? 1 : 0;
-    }
-    return target == nBars;
-}
\ No newline at end of file
+    BarExtremaRuns* runs = getBarExtremaRuns(sc);
+    runs->update(sc, index);
+    return runs->isHighestOf(index, nBars);
+}
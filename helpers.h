@@ -1,22 +1,159 @@
 #ifndef INC_999_LEARN_HELPERS_H
 #define INC_999_LEARN_HELPERS_H
 
-#endif //INC_999_LEARN_HELPERS_H
-
+#include "PriceTicks.h"
 #include "sierrachart.h"
 
+#include <algorithm>
+#include <initializer_list>
+
+class CleanTickIndex;
+class CleanRangeTracker;
+class BarExtremaRuns;
+class StudyArrayBindings;
+class OrderStateCache;
+class OrderModifyQueue;
+class TradeManager;
+class TradeEventLog;
+class SessionCalendar;
+class BarChangeTracker;
+class PeakValleyIndex;
+class VapStore;
+class MacdKernel;
+class SignalBusWriter;
+class SignalBusSubscriber;
+class TradeJournalWriter;
+struct JournalRow;
+enum class TradeEventType : uint16_t;
+
+// Persistent pointer keys owned by the helpers, the studies keep the low keys for their own state
+enum HelperPersistentPointer {
+    PP_CLEAN_TICK_INDEX = 100,
+    PP_CLEAN_RANGE_TRACKER = 101,
+    PP_BAR_EXTREMA_RUNS = 102,
+    PP_STUDY_ARRAY_BINDINGS = 103,
+    PP_ORDER_STATE_CACHE = 104,
+    PP_ORDER_MODIFY_QUEUE = 105,
+    PP_TRADE_MANAGER = 106,
+    PP_TRADE_EVENT_LOG = 107,
+    PP_SESSION_CALENDAR = 108,
+    PP_BAR_CHANGE_TRACKER = 109,
+    PP_PEAK_VALLEY_INDEX = 110,
+    PP_VAP_STORE = 111,
+    PP_MACD_KERNEL = 112,
+    PP_SIGNAL_BUS_WRITER = 113,
+    PP_SIGNAL_BUS_SUBSCRIBER = 114,
+    PP_TRADE_JOURNAL = 115,
+};
+
+// Frees what the helpers allocated for the calling study, to be called on sc.LastCallToFunction
+void releaseHelperState(SCStudyInterfaceRef sc);
+
+// The first call of a full recalculation, under AutoLoop a full recalculation is one call per bar
+bool isFullRecalculationStart(SCStudyInterfaceRef sc);
+
+// Drops the per-bar helper state when a full recalculation starts, to be called once per study call before any helper.
+// Studies that send orders also get their trade event log opened there
+void beginHelperUpdate(SCStudyInterfaceRef sc, bool sendsOrders = false);
+
+// Switches sc.AutoLoop to the study's input once a full recalculation has been over every bar, and has the study
+// recalculated in the new mode. To be called after the bar work, the mode never changes within a recalculation
+void applyAutoLoopInput(SCStudyInterfaceRef sc, bool autoLoop);
+
+// Runs barFunction(i) over the bars of this call: sc.Index under AutoLoop, [sc.UpdateStartIndex, sc.ArraySize) otherwise.
+// Bars before firstBar are skipped, e.g. those restored from a state snapshot
+template <typename BarFunction>
+void forEachBarToUpdate(SCStudyInterfaceRef sc, BarFunction&& barFunction, const int firstBar = 0) {
+    if (sc.AutoLoop) {
+        if (sc.Index >= firstBar) {barFunction(sc.Index);}
+        return;
+    }
+    for (int i = std::max(sc.UpdateStartIndex, firstBar); i < sc.ArraySize; ++i) {
+        barFunction(i);
+    }
+}
+
+// Clean tick index of the calling study for minVolume, one per threshold asked for
+CleanTickIndex& getCleanTickIndex(SCStudyInterfaceRef sc, int minVolume = 0);
+
+// Clean range tracker of the calling study, same lifetime rules as the clean tick index
+CleanRangeTracker& getCleanRangeTracker(SCStudyInterfaceRef sc, int minVolume = 0);
+
+// Lowest/highest of N links of the calling study, same lifetime rules as the clean tick index
+BarExtremaRuns* getBarExtremaRuns(SCStudyInterfaceRef sc);
+
+// Upstream array views of the calling study, rebound by beginHelperUpdate on a full recalculation
+StudyArrayBindings& getStudyArrayBindings(SCStudyInterfaceRef sc);
+
+// Order snapshots of the calling study, cleared by beginHelperUpdate on a full recalculation
+OrderStateCache& getOrderStateCache(SCStudyInterfaceRef sc);
+
+// Stop/target modifications of the calling study, cleared by beginHelperUpdate on a full recalculation
+OrderModifyQueue& getOrderModifyQueue(SCStudyInterfaceRef sc);
+
+// Open trades of the calling study, closed by beginHelperUpdate on a full recalculation
+TradeManager& getTradeManager(SCStudyInterfaceRef sc);
+
+// Binary event log of the calling study in the data files folder, kept across recalculations and closed on the last call.
+// Continues the file an earlier session left, and is opened by beginHelperUpdate for studies that send orders
+TradeEventLog& getTradeEventLog(SCStudyInterfaceRef sc);
+
+// Changes on the bar the calling study keeps updating, reset by beginHelperUpdate on a full recalculation
+BarChangeTracker& getBarChangeTracker(SCStudyInterfaceRef sc);
+
+// Peak/valley lines of a volume by price study's profile (0 is the most recent), re-read only once the chart traded.
+// Kept per study and profile asked for
+PeakValleyIndex& getPeakValleyIndex(SCStudyInterfaceRef sc, int studyId, int profileIndex = 0);
 
+// Dense bid/ask ladders of the calling study's bars, cleared by beginHelperUpdate on a full recalculation
+VapStore& getVapStore(SCStudyInterfaceRef sc);
 
+// EMA/MACD/ATR state per bar of the calling study, recomputed by beginHelperUpdate on a full recalculation
+MacdKernel& getMacdKernel(SCStudyInterfaceRef sc);
+
+// Session state per bar of the calling study, recomputed by beginHelperUpdate on a full recalculation
+SessionCalendar& getSessionCalendar(SCStudyInterfaceRef sc);
+
+// Applies the study's session and holiday inputs (see SessionCalendar), logs the entries it had to skip
+void configureSessionCalendar(SCStudyInterfaceRef sc, const char* sessions, const char* exceptions);
+
+// Queues one trade event for the calling study's log writer, never blocks the chart thread
+void logTradeEvent(SCStudyInterfaceRef sc, TradeEventType type, int barIndex, int64_t internalOrderId, double price,
+                   int64_t parentOrderId = 0, uint16_t detail = 0);
+
+// Trade journal of the calling study in the data files folder (see TradeJournal), appended to across sessions
+TradeJournalWriter& getTradeJournal(SCStudyInterfaceRef sc);
+
+// Appends row to the calling study's trade journal, stamped with the time and the start of row.barIndex
+void journalTradeRow(SCStudyInterfaceRef sc, const JournalRow& row);
+
+// Signal bus channel in the data files folder the calling study publishes to (see SignalBus), kept across
+// recalculations and closed on the last call. Naming another channel reopens it
+SignalBusWriter& getSignalBusWriter(SCStudyInterfaceRef sc, const char* channel);
+
+// Latest per-bar signals of a channel for the calling study, same lifetime as the writer
+SignalBusSubscriber& getSignalBusSubscriber(SCStudyInterfaceRef sc, const char* channel);
+
+// Publishes the signal of the bar and up to four values behind it
+void publishSignal(SCStudyInterfaceRef sc, SignalBusWriter& bus, int barIndex, float signal,
+                   std::initializer_list<float> values);
 
 bool IsCleanTick(float priceOfInterest, SCStudyInterfaceRef sc, int minVolume = 0, int offset = 0);
 
+// Tick domain form of IsCleanTick for callers that already hold the price of interest in ticks
+bool IsCleanTickAtBar(SCStudyInterfaceRef sc, int barIndex, PriceTicks priceOfInterest, int minVolume = 0);
+
+// Whether sc.Index starts inside a session of the study's calendar
 bool tradingAllowedCash(SCStudyInterfaceRef sc);
 
 void orderToLogs(SCStudyInterfaceRef sc, s_SCTradeOrder order);
 
 void highLowCleanPricesInBar(SCStudyInterfaceRef sc, double& minPrice, double& maxPrice, int offset = 0);
 
-void BidAskDiffBelowLowestPeak(SCStudyInterfaceRef sc);
+void highLowCleanTicksInBar(SCStudyInterfaceRef sc, PriceTicks& minTicks, PriceTicks& maxTicks, int offset = 0);
+
+// Lowest peak of the most recent profile of the volume by price study, false when it has none
+bool BidAskDiffBelowLowestPeak(SCStudyInterfaceRef sc, int studyId, PriceTicks& lowestPeak);
 
 
 template <typename... Args>
@@ -24,10 +161,10 @@ void colorAllSubGraphs(SCStudyInterfaceRef sc, const int i, Args&... args) {
     (
         [&] (SCSubgraphRef& arg) {
             if (arg[i] < 0) {
-                arg.DataColor[sc.Index] =
+                arg.DataColor[i] =
                     sc.CombinedForegroundBackgroundColorRef(COLOR_RED, COLOR_BLACK);
             } else {
-                arg.DataColor[sc.Index] =
+                arg.DataColor[i] =
                     sc.CombinedForegroundBackgroundColorRef(COLOR_LIGHTGREEN, COLOR_BLACK);
             }
         }(args), ...
@@ -37,8 +174,12 @@ void LogAttachedStop(int64_t parentKey, SCStudyInterfaceRef sc);
 
 void ModifyAttachedStop(int64_t parentKey, double newStop, SCStudyInterfaceRef sc);
 
+// Flattens and cancels everything once, on the first bar after a session of the study's calendar
 void flattenAllAfterCash(SCStudyInterfaceRef sc);
 
+// Whether the bar at index has the lowest low (highest high) of the nBars bars ending at it, ties included
 bool lowestOfNBars(SCStudyInterfaceRef sc, int nBars, int index);
 
 bool highestOfNBars(SCStudyInterfaceRef sc, int nBars, int index);
+
+#endif //INC_999_LEARN_HELPERS_H
@@ -0,0 +1,296 @@
+#include "BracketSimulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+
+BracketSimulator::BracketSimulator(const float tickSize) : tickSize(tickSize) {}
+
+double BracketSimulator::submit(const BuySellEnum side, s_SCNewOrder& order, const SCDateTime now) {
+    if (!priced) {return SCTRADING_ORDER_ERROR;}
+    const bool isMarket = order.OrderType == SCT_ORDERTYPE_MARKET;
+
+    SimOrder parent;
+    parent.side = side;
+    parent.type = order.OrderType;
+    parent.quantity = order.OrderQuantity;
+    parent.price = isMarket ? lastPrice : toTicks(order.Price1);
+    parent.status = SCT_OSC_OPEN;
+    parent.lastActivity = now;
+    const int64_t parentId = add(parent);
+    order.InternalOrderID = parentId;
+
+    const BuySellEnum childSide = side == BSE_BUY ? BSE_SELL : BSE_BUY;
+    const double direction = side == BSE_BUY ? 1.0 : -1.0;
+    const double parentPrice = toPrice(parent.price);
+    SimOrder child;
+    child.parentId = parentId;
+    child.side = childSide;
+    child.quantity = order.OrderQuantity;
+    child.status = SCT_OSC_PENDINGCHILD;
+    child.lastActivity = now;
+    if (order.Target1Price != 0.0 || order.Target1Offset != 0.0) {
+        child.type = SCT_ORDERTYPE_LIMIT;
+        child.price = toTicks(order.Target1Price != 0.0 ? order.Target1Price : parentPrice + direction * order.Target1Offset);
+        orders[parentId - 1].targetId = add(child);
+    }
+    if (order.Stop1Price != 0.0 || order.Stop1Offset != 0.0) {
+        child.type = SCT_ORDERTYPE_STOP;
+        child.price = toTicks(order.Stop1Price != 0.0 ? order.Stop1Price : parentPrice - direction * order.Stop1Offset);
+        orders[parentId - 1].stopId = add(child);
+    }
+
+    working.push_back(parentId);
+    if (isMarket) {
+        fill(parentId, lastPrice, now);
+    }
+    match(lastPrice, false, now);
+    return order.OrderQuantity;
+}
+
+int BracketSimulator::modify(const s_SCNewOrder& order, const SCDateTime now) {
+    SimOrder* target = find(order.InternalOrderID);
+    if (target == nullptr || (target->status != SCT_OSC_OPEN && target->status != SCT_OSC_PENDINGCHILD)) {
+        return SCTRADING_ORDER_ERROR;
+    }
+    if (order.Price1 != 0.0) {
+        target->price = toTicks(order.Price1);
+    }
+    target->lastActivity = now;
+    // A stop moved through the market goes off right away
+    if (target->status == SCT_OSC_OPEN) {
+        match(lastPrice, false, now);
+    }
+    return 1;
+}
+
+int BracketSimulator::cancel(const int64_t internalOrderId, const SCDateTime now) {
+    const SimOrder* order = find(internalOrderId);
+    if (order == nullptr) {return SCTRADING_ORDER_ERROR;}
+    const int64_t targetId = order->targetId;
+    const int64_t stopId = order->stopId;
+    if (order->status == SCT_OSC_FILLED) {
+        // A filled parent takes its working attached orders down with it
+        cancelWorking(targetId, now);
+        cancelWorking(stopId, now);
+        return 1;
+    }
+    if (order->status != SCT_OSC_OPEN && order->status != SCT_OSC_PENDINGCHILD) {
+        return SCTRADING_ORDER_ERROR;
+    }
+    cancelWorking(internalOrderId, now);
+    cancelWorking(targetId, now);
+    cancelWorking(stopId, now);
+    return 1;
+}
+
+void BracketSimulator::flattenAndCancelAll(const SCDateTime now) {
+    for (int64_t id = 1; id <= static_cast<int64_t>(orders.size()); ++id) {
+        cancelWorking(id, now);
+    }
+    if (positionQuantity != 0 && priced) {
+        SimOrder flatten;
+        flatten.side = positionQuantity > 0 ? BSE_SELL : BSE_BUY;
+        flatten.quantity = std::abs(positionQuantity);
+        flatten.price = lastPrice;
+        flatten.status = SCT_OSC_OPEN;
+        fill(add(flatten), lastPrice, now);
+    }
+}
+
+void BracketSimulator::trade(const PriceTicks price, const SCDateTime now) {
+    match(price, false, now);
+}
+
+void BracketSimulator::sweep(const PriceTicks to, const SCDateTime now) {
+    match(to, true, now);
+}
+
+void BracketSimulator::bar(const PriceTicks open, const PriceTicks high, const PriceTicks low, const PriceTicks close,
+                           const SCDateTime now) {
+    if (working.empty()) {
+        // Nothing can fill, only the position's excursion moves
+        if (positionQuantity != 0) {
+            highDuringPosition = std::max(highDuringPosition, high);
+            lowDuringPosition = std::min(lowDuringPosition, low);
+        }
+        lastPrice = close;
+        priced = true;
+        return;
+    }
+    trade(open, now);
+    const bool highFirst = high - open <= open - low;
+    sweep(highFirst ? high : low, now);
+    sweep(highFirst ? low : high, now);
+    sweep(close, now);
+}
+
+PriceTicks BracketSimulator::toTicks(const double price) const {
+    return static_cast<PriceTicks>(std::lround(price / tickSize));
+}
+
+double BracketSimulator::toPrice(const PriceTicks ticks) const {
+    return ticks * static_cast<double>(tickSize);
+}
+
+BracketSimulator::SimOrder* BracketSimulator::find(const int64_t internalOrderId) {
+    if (internalOrderId < 1 || internalOrderId > static_cast<int64_t>(orders.size())) {return nullptr;}
+    return &orders[internalOrderId - 1];
+}
+
+int64_t BracketSimulator::add(const SimOrder& order) {
+    orders.push_back(order);
+    return static_cast<int64_t>(orders.size());
+}
+
+bool BracketSimulator::triggeredAt(const SimOrder& order, const PriceTicks price) const {
+    const bool isBuy = order.side == BSE_BUY;
+    switch (order.type) {
+        case SCT_ORDERTYPE_LIMIT: return isBuy ? price <= order.price : price >= order.price;
+        case SCT_ORDERTYPE_STOP: return isBuy ? price >= order.price : price <= order.price;
+        default: return true;
+    }
+}
+
+void BracketSimulator::match(const PriceTicks to, const bool continuous, const SCDateTime now) {
+    PriceTicks cursor = continuous && priced ? lastPrice : to;
+    while (!working.empty()) {
+        int64_t bestId = 0;
+        PriceTicks bestAt = 0;
+        int bestDistance = 0;
+        bool bestIsStop = false;
+        for (const int64_t id : working) {
+            const SimOrder& order = orders[id - 1];
+            PriceTicks at;
+            if (triggeredAt(order, cursor)) {
+                at = cursor;
+            } else if (to != cursor && triggeredAt(order, to)) {
+                at = order.price;  // Strictly between cursor and to, the path gets there on the way
+            } else {
+                continue;
+            }
+            const int distance = std::abs(at - cursor);
+            const bool isStop = order.type == SCT_ORDERTYPE_STOP;
+            if (bestId == 0 || distance < bestDistance || (distance == bestDistance && isStop && !bestIsStop)) {
+                bestId = id;
+                bestAt = at;
+                bestDistance = distance;
+                bestIsStop = isStop;
+            }
+        }
+        if (bestId == 0) {break;}
+        cursor = bestAt;
+        const SimOrder& order = orders[bestId - 1];
+        fill(bestId, order.type == SCT_ORDERTYPE_LIMIT ? order.price : cursor, now);
+    }
+    if (positionQuantity != 0) {
+        highDuringPosition = std::max(highDuringPosition, to);
+        lowDuringPosition = std::min(lowDuringPosition, to);
+    }
+    lastPrice = to;
+    priced = true;
+}
+
+void BracketSimulator::fill(const int64_t id, const PriceTicks price, const SCDateTime now) {
+    SimOrder& order = orders[id - 1];
+    order.status = SCT_OSC_FILLED;
+    order.fillPrice = price;
+    if (order.type == SCT_ORDERTYPE_MARKET) {order.price = price;}
+    order.lastActivity = now;
+    if (const auto it = std::find(working.begin(), working.end(), id); it != working.end()) {
+        working.erase(it);
+    }
+
+    s_SCOrderFillData fillData;
+    fillData.InternalOrderID = id;
+    fillData.BuySell = order.side;
+    fillData.FillPrice = toPrice(price);
+    fillData.Quantity = order.quantity;
+    fillData.FillDateTime = now;
+    fills.push_back(fillData);
+
+    const double signedQuantity = order.side == BSE_BUY ? order.quantity : -order.quantity;
+    const double newQuantity = positionQuantity + signedQuantity;
+    if (newQuantity == 0) {
+        averagePrice = 0;
+    } else if (positionQuantity == 0 || (positionQuantity > 0) != (newQuantity > 0)) {
+        averagePrice = price;
+        highDuringPosition = price;
+        lowDuringPosition = price;
+    } else if (std::abs(newQuantity) > std::abs(positionQuantity)) {
+        averagePrice = (averagePrice * positionQuantity + price * signedQuantity) / newQuantity;
+    }
+    positionQuantity = newQuantity;
+
+    // Attached orders go live with their parent and are one-cancels-other once live
+    if (order.parentId == 0) {
+        const int64_t targetId = order.targetId;
+        const int64_t stopId = order.stopId;
+        activate(targetId);
+        activate(stopId);
+    } else {
+        const SimOrder& parent = orders[order.parentId - 1];
+        const int64_t targetId = parent.targetId;
+        const int64_t stopId = parent.stopId;
+        cancelWorking(targetId, now);
+        cancelWorking(stopId, now);
+    }
+}
+
+void BracketSimulator::activate(const int64_t id) {
+    SimOrder* order = find(id);
+    if (order == nullptr || order->status != SCT_OSC_PENDINGCHILD) {return;}
+    order->status = SCT_OSC_OPEN;
+    working.insert(std::lower_bound(working.begin(), working.end(), id), id);
+}
+
+void BracketSimulator::cancelWorking(const int64_t id, const SCDateTime now) {
+    SimOrder* order = find(id);
+    if (order == nullptr) {return;}
+    if (order->status == SCT_OSC_OPEN) {
+        working.erase(std::find(working.begin(), working.end(), id));
+    } else if (order->status != SCT_OSC_PENDINGCHILD) {
+        return;
+    }
+    order->status = SCT_OSC_CANCELED;
+    order->lastActivity = now;
+}
+
+bool BracketSimulator::getOrder(const int64_t internalOrderId, s_SCTradeOrder& order) const {
+    if (internalOrderId < 1 || internalOrderId > static_cast<int64_t>(orders.size())) {return false;}
+    const SimOrder& stored = orders[internalOrderId - 1];
+    const bool filled = stored.status == SCT_OSC_FILLED;
+    order = s_SCTradeOrder();
+    order.InternalOrderID = internalOrderId;
+    order.ParentInternalOrderID = stored.parentId;
+    order.TargetChildInternalOrderID = stored.targetId;
+    order.StopChildInternalOrderID = stored.stopId;
+    order.OrderType = stored.type;
+    order.BuySell = stored.side;
+    order.Price1 = toPrice(stored.price);
+    order.OrderQuantity = stored.quantity;
+    order.FilledQuantity = filled ? stored.quantity : 0;
+    order.AvgFillPrice = filled ? toPrice(stored.fillPrice) : 0.0;
+    order.OrderStatusCode = stored.status;
+    order.LastActivityTime = stored.lastActivity;
+    return true;
+}
+
+const std::vector<s_SCOrderFillData>& BracketSimulator::getFills() const {return fills;}
+
+s_SCPositionData BracketSimulator::getPosition() const {
+    s_SCPositionData position;
+    if (positionQuantity == 0) {return position;}
+    position.PositionQuantity = positionQuantity;
+    position.AveragePrice = averagePrice * tickSize;
+    position.PriceHighDuringPosition = toPrice(highDuringPosition);
+    position.PriceLowDuringPosition = toPrice(lowDuringPosition);
+    return position;
+}
+
+bool BracketSimulator::hasLastPrice() const {return priced;}
+
+PriceTicks BracketSimulator::getLastPrice() const {return lastPrice;}
+
+size_t BracketSimulator::getWorkingCount() const {return working.size();}
@@ -0,0 +1,91 @@
+#ifndef BRACKETSIMULATOR_H
+#define BRACKETSIMULATOR_H
+
+/*
+ * Deterministic fill engine behind the replay host's order APIs, event driven and in whole ticks.
+ *   Orders   market and limit parents with an attached target (limit) and stop, by price or offset from the parent.
+ *            Attached orders wait as PENDINGCHILD until their parent fills and are one-cancels-other once live.
+ *            ModifyOrder moves an open or pending child order, CancelOrder on a filled parent takes its live children
+ *            down, on a working one the whole bracket.
+ *   Prices   trade() is one print, resting orders it crosses fill at once: limits at their price, stops at the print
+ *            (a gap slips). sweep() is a continuous move from the last price, orders fill one by one in the order
+ *            the path reaches them and at their own price. bar() walks open, the extreme nearer to the open, the
+ *            other extreme and close, for bars that come without their ticks.
+ * Children that go live on a fill are matched from the price they went live at. Orders reached at the same price
+ * fill stops first, then oldest first, so a bar touching both sides of a bracket resolves against us.
+ */
+
+#include "PriceTicks.h"
+#include "sierrachart.h"
+
+#include <cstdint>
+#include <vector>
+
+class BracketSimulator {
+
+public:
+    explicit BracketSimulator(float tickSize);
+
+    // Orders, Sierra return conventions (quantity or 1 on success, SCTRADING_ORDER_ERROR otherwise)
+    double submit(BuySellEnum side, s_SCNewOrder& order, SCDateTime now);
+    int modify(const s_SCNewOrder& order, SCDateTime now);
+    int cancel(int64_t internalOrderId, SCDateTime now);
+    void flattenAndCancelAll(SCDateTime now);
+
+    // Prices
+    void trade(PriceTicks price, SCDateTime now);
+    void sweep(PriceTicks to, SCDateTime now);
+    void bar(PriceTicks open, PriceTicks high, PriceTicks low, PriceTicks close, SCDateTime now);
+
+    [[nodiscard]] PriceTicks toTicks(double price) const;
+    [[nodiscard]] double toPrice(PriceTicks ticks) const;
+
+    // Getters
+    bool getOrder(int64_t internalOrderId, s_SCTradeOrder& order) const;
+    [[nodiscard]] const std::vector<s_SCOrderFillData>& getFills() const;
+    // Open profit is left to the caller, it knows the contract's currency value per tick
+    [[nodiscard]] s_SCPositionData getPosition() const;
+    [[nodiscard]] bool hasLastPrice() const;
+    [[nodiscard]] PriceTicks getLastPrice() const;
+    [[nodiscard]] size_t getWorkingCount() const;
+
+private:
+    struct SimOrder {
+        int64_t parentId = 0;
+        int64_t targetId = 0;
+        int64_t stopId = 0;
+        BuySellEnum side = BSE_UNDEFINED;
+        int type = SCT_ORDERTYPE_MARKET;
+        double quantity = 0;
+        PriceTicks price = 0;
+        PriceTicks fillPrice = 0;
+        SCOrderStatusCodeEnum status = SCT_OSC_UNSPECIFIED;
+        SCDateTime lastActivity;
+    };
+
+    // Order ids are 1 based positions in orders
+    SimOrder* find(int64_t internalOrderId);
+    int64_t add(const SimOrder& order);
+    [[nodiscard]] bool triggeredAt(const SimOrder& order, PriceTicks price) const;
+    // Fills every live order the move from cursor to `to` reaches, continuous or as one print
+    void match(PriceTicks to, bool continuous, SCDateTime now);
+    void fill(int64_t id, PriceTicks price, SCDateTime now);
+    void activate(int64_t id);
+    void cancelWorking(int64_t id, SCDateTime now);
+
+    const float tickSize;
+    std::vector<SimOrder> orders;
+    std::vector<int64_t> working;  // Live (OPEN) orders, in id order
+    std::vector<s_SCOrderFillData> fills;
+
+    // Position in ticks, converted when it is asked for
+    double positionQuantity = 0;
+    double averagePrice = 0;
+    PriceTicks highDuringPosition = 0;
+    PriceTicks lowDuringPosition = 0;
+
+    bool priced = false;
+    PriceTicks lastPrice = 0;
+};
+
+#endif //BRACKETSIMULATOR_H
@@ -0,0 +1,137 @@
+#include "ReplayBars.h"
+
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+
+
+int daysFromCivil(int year, const int month, const int day) {
+    // Howard Hinnant's days_from_civil, shifted from the Unix epoch to 1899-12-30
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const int yoe = year - era * 400;
+    const int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468 + 25569;
+}
+
+std::vector<RecordedBar> loadSierraBarCsv(const std::string& path, const float tickSize) {
+    std::vector<RecordedBar> recorded;
+    std::ifstream in(path);
+    if (!in) {return recorded;}
+
+    std::string line;
+    std::getline(in, line);  // Header
+    while (std::getline(in, line)) {
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::replace(line.begin(), line.end(), '/', ' ');
+        std::replace(line.begin(), line.end(), '-', ' ');
+        std::replace(line.begin(), line.end(), ':', ' ');
+        std::istringstream fields(line);
+        int year, month, day, hour, minute;
+        double second;
+        RecordedBar r;
+        ReplayBar& bar = r.bar;
+        if (!(fields >> year >> month >> day >> hour >> minute >> second
+              >> bar.open >> bar.high >> bar.low >> bar.close >> bar.volume >> bar.numTrades
+              >> bar.bidVolume >> bar.askVolume)) {
+            continue;
+        }
+        bar.dateTime = SCDateTime::FromDateTime(daysFromCivil(year, month, day),
+                                                static_cast<int>(hour * 3600 + minute * 60 + second));
+        const float askShare = bar.volume > 0 ? bar.askVolume / bar.volume : 0.5f;
+        bar.askTrades = bar.numTrades * askShare;
+        bar.bidTrades = bar.numTrades - bar.askTrades;
+        const float direction = bar.close > bar.open ? 1.0f : bar.close < bar.open ? -1.0f : 0.0f;
+        bar.upTickVolume = bar.volume * 0.5f * (1.0f + direction * 0.2f);
+        bar.downTickVolume = bar.volume - bar.upTickVolume;
+        bar.maxDelta = std::max(0.0f, bar.askVolume - bar.bidVolume);
+        bar.minDelta = std::min(0.0f, bar.askVolume - bar.bidVolume);
+
+        const int lowTicks = static_cast<int>(std::lround(bar.low / tickSize));
+        const int highTicks = static_cast<int>(std::lround(bar.high / tickSize));
+        const int levels = std::max(1, highTicks - lowTicks + 1);
+        const auto bidPerLevel = static_cast<unsigned int>(bar.bidVolume / static_cast<float>(levels));
+        const auto askPerLevel = static_cast<unsigned int>(bar.askVolume / static_cast<float>(levels));
+        const auto tradesPerLevel = static_cast<unsigned int>(bar.numTrades / static_cast<float>(levels));
+        for (int t = lowTicks; t <= highTicks; ++t) {
+            r.ladder.push_back({static_cast<float>(t * static_cast<double>(tickSize)), bidPerLevel, askPerLevel, tradesPerLevel});
+        }
+        recorded.push_back(std::move(r));
+    }
+    return recorded;
+}
+
+std::vector<RecordedBar> generateSyntheticBars(const int numberOfBars, const float tickSize, const unsigned int seed,
+                                               const int tradesPerBar, const int secondsPerBar) {
+    std::vector<RecordedBar> recorded;
+    recorded.reserve(numberOfBars);
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> step(-1, 1);
+    std::uniform_int_distribution<int> size(1, 10);
+    std::bernoulli_distribution atAsk(0.5);
+
+    const int barsPerDay = 8 * 3600 / secondsPerBar;  // 08:00 to 16:00
+    int priceTicks = static_cast<int>(std::lround(5000.0 / tickSize));
+    int previousTradeTicks = priceTicks;
+
+    for (int b = 0; b < numberOfBars; ++b) {
+        RecordedBar r;
+        ReplayBar& bar = r.bar;
+        const int day = daysFromCivil(2026, 1, 5) + b / barsPerDay;
+        bar.dateTime = SCDateTime::FromDateTime(day, 8 * 3600 + (b % barsPerDay) * secondsPerBar);
+
+        std::map<int, ReplayLevel> ladder;
+        int lowTicks = priceTicks, highTicks = priceTicks;
+        float delta = 0;
+        bar.open = static_cast<float>(priceTicks * static_cast<double>(tickSize));
+        for (int t = 0; t < tradesPerBar; ++t) {
+            priceTicks += step(rng);
+            const auto volume = static_cast<unsigned int>(size(rng));
+            const bool ask = priceTicks > previousTradeTicks || (priceTicks == previousTradeTicks && atAsk(rng));
+            ReplayLevel& level = ladder[priceTicks];
+            level.price = static_cast<float>(priceTicks * static_cast<double>(tickSize));
+            (ask ? level.askVolume : level.bidVolume) += volume;
+            ++level.trades;
+
+            const auto v = static_cast<float>(volume);
+            bar.volume += v;
+            bar.numTrades += 1;
+            (ask ? bar.askVolume : bar.bidVolume) += v;
+            (ask ? bar.askTrades : bar.bidTrades) += 1;
+            if (priceTicks > previousTradeTicks) {bar.upTickVolume += v;}
+            if (priceTicks < previousTradeTicks) {bar.downTickVolume += v;}
+            delta += ask ? v : -v;
+            bar.maxDelta = std::max(bar.maxDelta, delta);
+            bar.minDelta = std::min(bar.minDelta, delta);
+            lowTicks = std::min(lowTicks, priceTicks);
+            highTicks = std::max(highTicks, priceTicks);
+            previousTradeTicks = priceTicks;
+        }
+        bar.high = static_cast<float>(highTicks * static_cast<double>(tickSize));
+        bar.low = static_cast<float>(lowTicks * static_cast<double>(tickSize));
+        bar.close = static_cast<float>(priceTicks * static_cast<double>(tickSize));
+        for (const auto& [ticks, level] : ladder) {
+            r.ladder.push_back(level);
+        }
+        recorded.push_back(std::move(r));
+    }
+    return recorded;
+}
+
+void feedRecordedBar(ReplayChart& chart, const RecordedBar& recorded) {
+    chart.appendBar(recorded.bar);
+    const int index = chart.getArraySize() - 1;
+    for (const ReplayLevel& level : recorded.ladder) {
+        chart.addVolumeAtPrice(index, level.price, level.bidVolume, level.askVolume, level.trades);
+    }
+}
+
+void updateRecordedBar(ReplayChart& chart, const RecordedBar& recorded) {
+    chart.replaceLastBar(recorded.bar);
+    const int index = chart.getArraySize() - 1;
+    for (const ReplayLevel& level : recorded.ladder) {
+        chart.addVolumeAtPrice(index, level.price, level.bidVolume, level.askVolume, level.trades);
+    }
+}
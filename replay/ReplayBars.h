@@ -0,0 +1,39 @@
+#ifndef REPLAYBARS_H
+#define REPLAYBARS_H
+
+#include "ReplayChart.h"
+
+#include <string>
+#include <vector>
+
+struct ReplayLevel {
+    float price = 0;
+    unsigned int bidVolume = 0;
+    unsigned int askVolume = 0;
+    unsigned int trades = 0;
+};
+
+// A finished bar together with its volume at price ladder
+struct RecordedBar {
+    ReplayBar bar;
+    std::vector<ReplayLevel> ladder;
+};
+
+// Sierra Chart bar export: Date, Time, Open, High, Low, Last, Volume, NumberOfTrades, BidVolume, AskVolume.
+// Bar files carry no ladder, the bid/ask volume is spread evenly over the bar range so VAP based logic has input.
+std::vector<RecordedBar> loadSierraBarCsv(const std::string& path, float tickSize);
+
+// Reproducible random walk session made of individual trades, with a real per bar ladder
+std::vector<RecordedBar> generateSyntheticBars(int numberOfBars, float tickSize, unsigned int seed,
+                                               int tradesPerBar = 200, int secondsPerBar = 60);
+
+// Appends the bar and its ladder to the chart
+void feedRecordedBar(ReplayChart& chart, const RecordedBar& recorded);
+
+// Replaces the chart's last bar and its ladder with a newer state of the same bar
+void updateRecordedBar(ReplayChart& chart, const RecordedBar& recorded);
+
+// Days since 1899-12-30, the SCDateTime epoch
+int daysFromCivil(int year, int month, int day);
+
+#endif //REPLAYBARS_H
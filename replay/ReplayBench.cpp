@@ -0,0 +1,460 @@
+/*
+ * Microbenchmarks of the helpers and TradeWrapper hot paths, run against the replay stand-in on synthetic bars with real
+ * volume at price ladders. Each benchmark runs once to warm up, then --repetitions times; the report gives the median
+ * and best time per operation. --json writes the same results machine readable so two commits can be compared:
+ *
+ *   divergence_bench --json before.json --label $(git rev-parse --short HEAD)
+ *
+ * Cold variants drop the helpers' per-bar state before every run (what a full recalculation pays), warm ones reuse it
+ * (what a live update pays).
+ *
+ * Usage: divergence_bench [--bars N] [--trades-per-bar N[,N...]] [--repetitions N] [--filter text] [--json file]
+ *                         [--label text] [--tick-size 0.25]
+ */
+
+#include "BracketSimulator.h"
+#include "ReplayBars.h"
+#include "ReplayChart.h"
+#include "MacdKernel.h"
+#include "SignalBus.h"
+#include "helpers.h"
+#include "TradeWrapper.h"
+#include "VapStore.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct BenchOptions {
+    int bars = 20000;
+    std::vector<int> tradesPerBar = {200, 2000};
+    int repetitions = 7;
+    std::string filter;
+    std::string jsonPath;
+    std::string label;
+    float tickSize = 0.25f;
+};
+
+struct BenchResult {
+    std::string name;
+    std::string params;
+    int64_t operationsPerRun = 0;
+    double medianNsPerOp = 0;
+    double bestNsPerOp = 0;
+};
+
+// Keeps the benchmarked results alive
+volatile double benchSink = 0;
+
+std::vector<int> parseIntList(const char* text) {
+    std::vector<int> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (const int value = std::atoi(item.c_str()); value > 0) {values.push_back(value);}
+    }
+    return values;
+}
+
+bool parseOptions(const int argc, char** argv, BenchOptions& options) {
+    for (int a = 1; a < argc; ++a) {
+        const auto next = [&]() -> const char* {return a + 1 < argc ? argv[++a] : "";};
+        if (std::strcmp(argv[a], "--bars") == 0) {
+            options.bars = std::max(100, std::atoi(next()));
+        } else if (std::strcmp(argv[a], "--trades-per-bar") == 0) {
+            options.tradesPerBar = parseIntList(next());
+        } else if (std::strcmp(argv[a], "--repetitions") == 0) {
+            options.repetitions = std::max(1, std::atoi(next()));
+        } else if (std::strcmp(argv[a], "--filter") == 0) {
+            options.filter = next();
+        } else if (std::strcmp(argv[a], "--json") == 0) {
+            options.jsonPath = next();
+        } else if (std::strcmp(argv[a], "--label") == 0) {
+            options.label = next();
+        } else if (std::strcmp(argv[a], "--tick-size") == 0) {
+            options.tickSize = static_cast<float>(std::atof(next()));
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[a]);
+            return false;
+        }
+    }
+    return !options.tradesPerBar.empty();
+}
+
+void benchHostStudy(SCStudyInterfaceRef sc) {
+    if (sc.SetDefaults) {
+        sc.GraphName = "Benchmark host";
+        sc.AutoLoop = 0;
+    }
+}
+
+// Chart of synthetic bars and the study context the helpers run in
+class BenchFixture {
+
+public:
+    BenchFixture(const BenchOptions& options, const int tradesPerBar) : chart(options.tickSize) {
+        recordedBars = generateSyntheticBars(options.bars, options.tickSize, 7, tradesPerBar);
+        for (const RecordedBar& recorded : recordedBars) {
+            feedRecordedBar(chart, recorded);
+        }
+        study = &chart.addStudy(1, "Benchmark host", benchHostStudy);
+        chart.setDefaults();
+        chart.fullRecalculation();  // Binds the chart arrays to the study
+
+        int64_t levels = 0;
+        for (int bar = 0; bar < sc().ArraySize; ++bar) {
+            int high = 0, low = 0;
+            if (!sc().VolumeAtPriceForBars->GetHighAndLowPriceTicksForBarIndex(bar, high, low)) {continue;}
+            for (int ticks = low; ticks <= high; ++ticks) {
+                ladderPrices.push_back({bar, sc().TicksToPriceValue(ticks)});
+            }
+            levels += high - low + 1;
+        }
+        std::ostringstream description;
+        description << "bars=" << sc().ArraySize << " trades_per_bar=" << tradesPerBar << " ladder_ticks="
+                    << static_cast<double>(levels) / sc().ArraySize;
+        params = description.str();
+    }
+
+    s_sc& sc() {return *study->sc;}
+
+    // Drops the helpers' per-bar state the way a full recalculation does
+    void resetHelpers() {
+        s_sc& context = sc();
+        context.IsFullRecalculation = 1;
+        beginHelperUpdate(context);
+        context.IsFullRecalculation = 0;
+    }
+
+    ~BenchFixture() {releaseHelperState(sc());}
+
+    struct LadderPrice {
+        int bar;
+        float price;
+    };
+
+    ReplayChart chart;
+    ReplayStudy* study = nullptr;
+    std::vector<RecordedBar> recordedBars;
+    std::vector<LadderPrice> ladderPrices;
+    std::string params;
+};
+
+class BenchRunner {
+
+public:
+    explicit BenchRunner(const BenchOptions& options) : options(options) {}
+
+    template <typename Body>
+    void run(const std::string& name, const std::string& params, const int64_t operationsPerRun, Body&& body) {
+        if (!options.filter.empty() && name.find(options.filter) == std::string::npos) {return;}
+        body();
+        std::vector<double> samples;
+        for (int r = 0; r < options.repetitions; ++r) {
+            const auto start = std::chrono::steady_clock::now();
+            body();
+            const auto stop = std::chrono::steady_clock::now();
+            samples.push_back(std::chrono::duration<double, std::nano>(stop - start).count()
+                              / static_cast<double>(operationsPerRun));
+        }
+        std::sort(samples.begin(), samples.end());
+        BenchResult result;
+        result.name = name;
+        result.params = params;
+        result.operationsPerRun = operationsPerRun;
+        result.medianNsPerOp = samples[samples.size() / 2];
+        result.bestNsPerOp = samples.front();
+        std::printf("%-44s %12.2f %12.2f %12lld  %s\n", name.c_str(), result.medianNsPerOp, result.bestNsPerOp,
+                    static_cast<long long>(operationsPerRun), params.c_str());
+        results.push_back(result);
+    }
+
+    [[nodiscard]] const std::vector<BenchResult>& getResults() const {return results;}
+
+private:
+    const BenchOptions& options;
+    std::vector<BenchResult> results;
+};
+
+void benchCleanTicks(BenchRunner& runner, BenchFixture& fixture) {
+    s_sc& sc = fixture.sc();
+    const auto probeLadders = [&] {
+        int clean = 0;
+        for (const BenchFixture::LadderPrice& level : fixture.ladderPrices) {
+            sc.Index = level.bar;
+            clean += IsCleanTick(level.price, sc) ? 1 : 0;
+        }
+        benchSink = benchSink + clean;
+    };
+    const auto levels = static_cast<int64_t>(fixture.ladderPrices.size());
+    runner.run("IsCleanTick/cold", fixture.params, levels, [&] {
+        fixture.resetHelpers();
+        probeLadders();
+    });
+    runner.run("IsCleanTick/warm", fixture.params, levels, probeLadders);
+
+    const auto cleanRanges = [&] {
+        double sum = 0;
+        for (int i = 0; i < sc.ArraySize; ++i) {
+            double low, high;
+            sc.Index = i;
+            highLowCleanPricesInBar(sc, low, high);
+            sum += high - low;
+        }
+        benchSink = benchSink + sum;
+    };
+    runner.run("highLowCleanPricesInBar/cold", fixture.params, sc.ArraySize, [&] {
+        fixture.resetHelpers();
+        cleanRanges();
+    });
+    runner.run("highLowCleanPricesInBar/warm", fixture.params, sc.ArraySize, cleanRanges);
+}
+
+void benchVapStore(BenchRunner& runner, BenchFixture& fixture) {
+    s_sc& sc = fixture.sc();
+    VapStore store;
+    int64_t levels = 0;
+    for (const RecordedBar& recorded : fixture.recordedBars) {levels += static_cast<int64_t>(recorded.ladder.size());}
+    runner.run("VapStore::addTrade", fixture.params, 2 * levels, [&] {
+        store.reset();
+        for (int bar = 0; bar < static_cast<int>(fixture.recordedBars.size()); ++bar) {
+            for (const ReplayLevel& level : fixture.recordedBars[bar].ladder) {
+                const PriceTicks ticks = toTicks(sc, level.price);
+                store.addTrade(bar, ticks, level.bidVolume, false);
+                store.addTrade(bar, ticks, level.askVolume, true);
+            }
+        }
+        benchSink = benchSink + store.getBarCount();
+    });
+    runner.run("VapStore::syncBar", fixture.params, sc.ArraySize, [&] {
+        store.reset();
+        for (int i = 0; i < sc.ArraySize; ++i) {store.syncBar(sc, i);}
+        benchSink = benchSink + store.getBarCount();
+    });
+    runner.run("VapStore::cleanRange", fixture.params, sc.ArraySize, [&] {
+        int64_t sum = 0;
+        for (int i = 0; i < sc.ArraySize; ++i) {
+            PriceTicks low, high;
+            if (store.cleanRange(i, 0, low, high)) {sum += high - low;}
+        }
+        benchSink = benchSink + static_cast<double>(sum);
+    });
+    runner.run("VapStore::delta+imbalanceCounts", fixture.params, sc.ArraySize, [&] {
+        int64_t sum = 0;
+        for (int i = 0; i < sc.ArraySize; ++i) {
+            int buying, selling;
+            store.imbalanceCounts(i, 3.0f, buying, selling);
+            sum += store.delta(i) + buying - selling;
+        }
+        benchSink = benchSink + static_cast<double>(sum);
+    });
+    VapProfile profile;
+    runner.run("VapStore::aggregate/n=50", fixture.params, sc.ArraySize, [&] {
+        uint64_t sum = 0;
+        for (int i = 0; i < sc.ArraySize; ++i) {
+            store.aggregate(i - 49, i, profile);
+            sum += profile.bidVolume.size();
+        }
+        benchSink = benchSink + static_cast<double>(sum);
+    });
+}
+
+void benchBracketSimulator(BenchRunner& runner, BenchFixture& fixture) {
+    s_sc& sc = fixture.sc();
+    struct BarTicks {
+        PriceTicks open, high, low, close;
+    };
+    std::vector<BarTicks> path;
+    path.reserve(sc.ArraySize);
+    for (int i = 0; i < sc.ArraySize; ++i) {
+        path.push_back({toTicks(sc, sc.Open[i]), toTicks(sc, sc.High[i]), toTicks(sc, sc.Low[i]), toTicks(sc, sc.Close[i])});
+    }
+    // A 3 tick bracket reopened whenever flat, alternating sides, with its stop trailed a tick every bar
+    runner.run("BracketSimulator::bar/bracket", fixture.params, sc.ArraySize, [&] {
+        BracketSimulator simulator(sc.TickSize);
+        s_SCTradeOrder parent;
+        for (int i = 0; i < sc.ArraySize; ++i) {
+            const BarTicks& bar = path[i];
+            simulator.bar(bar.open, bar.high, bar.low, bar.close, sc.BaseDateTimeIn[i]);
+            if (simulator.getPosition().PositionQuantity == 0) {
+                s_SCNewOrder order;
+                order.OrderQuantity = 1;
+                order.Target1Offset = 3 * sc.TickSize;
+                order.Stop1Offset = 3 * sc.TickSize;
+                simulator.submit(i % 2 == 0 ? BSE_BUY : BSE_SELL, order, sc.BaseDateTimeIn[i]);
+                simulator.getOrder(order.InternalOrderID, parent);
+            } else if (s_SCTradeOrder stop; simulator.getOrder(parent.StopChildInternalOrderID, stop)) {
+                s_SCNewOrder trail;
+                trail.InternalOrderID = stop.InternalOrderID;
+                trail.Price1 = stop.Price1 + (parent.BuySell == BSE_BUY ? sc.TickSize : -sc.TickSize);
+                simulator.modify(trail, sc.BaseDateTimeIn[i]);
+            }
+        }
+        benchSink = benchSink + static_cast<double>(simulator.getFills().size());
+    });
+}
+
+void benchMacdKernel(BenchRunner& runner, BenchFixture& fixture) {
+    s_sc& sc = fixture.sc();
+    MacdKernel kernel;
+    runner.run("MacdKernel::update/batch", fixture.params, sc.ArraySize, [&] {
+        kernel.reset();
+        kernel.update(sc);
+        benchSink = benchSink + kernel.at(sc.ArraySize - 1).histogram;
+    });
+    // What every live update pays: the last bar again, from the one before it
+    runner.run("MacdKernel::update/step", fixture.params, sc.ArraySize, [&] {
+        for (int i = 0; i < sc.ArraySize; ++i) {kernel.update(sc);}
+        benchSink = benchSink + kernel.at(sc.ArraySize - 1).atr;
+    });
+}
+
+void benchSignalBus(BenchRunner& runner, BenchFixture& fixture) {
+    s_sc& sc = fixture.sc();
+    const std::string path = signalBusPath(std::filesystem::temp_directory_path().string(), "bench");
+    SignalBusWriter writer;
+    SignalBusReader reader;
+    if (!writer.open(path) || !reader.open(path, true)) {return;}
+    SignalRecord record{};
+    SignalRecord batch[256];
+    // One record per bar through the mapped ring, the reader draining behind the writer as an executor would
+    runner.run("SignalBus::publish+poll", fixture.params, sc.ArraySize, [&] {
+        int64_t received = 0;
+        for (int i = 0; i < sc.ArraySize; ++i) {
+            record.barIndex = i;
+            record.values[0] = sc.Close[i];
+            writer.publish(record);
+            if ((i & 63) == 63) {received += static_cast<int64_t>(reader.poll(batch, std::size(batch)));}
+        }
+        received += static_cast<int64_t>(reader.poll(batch, std::size(batch)));
+        benchSink = benchSink + static_cast<double>(received);
+    });
+    writer.close();
+    reader.close();
+    std::filesystem::remove(path);
+}
+
+void benchBarExtrema(BenchRunner& runner, BenchFixture& fixture) {
+    s_sc& sc = fixture.sc();
+    for (const int nBars : {5, 50}) {
+        const auto extrema = [&] {
+            int hits = 0;
+            for (int i = 0; i < sc.ArraySize; ++i) {
+                hits += lowestOfNBars(sc, nBars, i) ? 1 : 0;
+                hits += highestOfNBars(sc, nBars, i) ? 1 : 0;
+            }
+            benchSink = benchSink + hits;
+        };
+        const std::string name = "lowestOfNBars+highestOfNBars/n=" + std::to_string(nBars);
+        runner.run(name + "/cold", fixture.params, sc.ArraySize, [&] {
+            fixture.resetHelpers();
+            extrema();
+        });
+        runner.run(name + "/warm", fixture.params, sc.ArraySize, extrema);
+    }
+}
+
+void benchColoring(BenchRunner& runner, BenchFixture& fixture) {
+    s_sc& sc = fixture.sc();
+    SCSubgraphRef first = sc.Subgraph[0];
+    SCSubgraphRef second = sc.Subgraph[1];
+    SCSubgraphRef third = sc.Subgraph[2];
+    for (int i = 0; i < sc.ArraySize; ++i) {
+        first[i] = sc.Close[i] - sc.Open[i];
+        second[i] = sc.AskVolume[i] - sc.BidVolume[i];
+        third[i] = static_cast<float>(i % 3) - 1.0f;
+    }
+    runner.run("colorAllSubGraphs/3 subgraphs", fixture.params, sc.ArraySize, [&] {
+        for (int i = 0; i < sc.ArraySize; ++i) {
+            colorAllSubGraphs(sc, i, first, second, third);
+        }
+        benchSink = benchSink + static_cast<double>(third.DataColor[sc.ArraySize - 1]);
+    });
+}
+
+void benchTradeWrapper(BenchRunner& runner, BenchFixture& fixture) {
+    s_sc& sc = fixture.sc();
+    // A short whose attached orders are out of reach, so the bracket stays active over the whole chart
+    s_SCNewOrder order;
+    order.OrderQuantity = 1;
+    order.OrderType = SCT_ORDERTYPE_MARKET;
+    order.Target1Offset = 100000 * sc.TickSize;
+    order.Stop1Offset = 100000 * sc.TickSize;
+    if (sc.SellOrder(order) <= 0) {return;}
+    const int64_t parentId = order.InternalOrderID;
+
+    runner.run("TradeWrapper::updateAll", fixture.params, sc.ArraySize, [&] {
+        TradeWrapper trade(parentId, 0, TargetMode::Evolving, BSE_SELL, 2);
+        for (int i = 0; i < sc.ArraySize; ++i) {
+            trade.updateAll(sc, i);
+        }
+        benchSink = benchSink + trade.getMaxFavorablePriceDifference();
+    });
+
+    constexpr int64_t plateauCalls = 1 << 20;
+    runner.run("TradeWrapper::updatePlateau", fixture.params, plateauCalls, [&] {
+        TradeWrapper trade(parentId, 0, TargetMode::Evolving, BSE_SELL, 2);
+        for (int64_t k = 0; k < plateauCalls; ++k) {
+            trade.updatePlateau();
+        }
+        benchSink = benchSink + trade.getMaxFavorablePriceDifference();
+    });
+    sc.CancelOrder(parentId);
+}
+
+void writeJson(const BenchOptions& options, const std::vector<BenchResult>& results) {
+    std::FILE* file = std::fopen(options.jsonPath.c_str(), "w");
+    if (file == nullptr) {
+        std::fprintf(stderr, "Cannot write %s\n", options.jsonPath.c_str());
+        return;
+    }
+    const std::time_t now = std::time(nullptr);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    std::fprintf(file, "{\n  \"label\": \"%s\",\n  \"timestamp\": \"%s\",\n  \"repetitions\": %d,\n  \"benchmarks\": [\n",
+                 options.label.c_str(), stamp, options.repetitions);
+    for (size_t k = 0; k < results.size(); ++k) {
+        const BenchResult& r = results[k];
+        std::fprintf(file,
+                     "    {\"name\": \"%s\", \"params\": \"%s\", \"operations_per_run\": %lld, "
+                     "\"median_ns_per_op\": %.3f, \"best_ns_per_op\": %.3f}%s\n",
+                     r.name.c_str(), r.params.c_str(), static_cast<long long>(r.operationsPerRun), r.medianNsPerOp,
+                     r.bestNsPerOp, k + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(file, "  ]\n}\n");
+    std::fclose(file);
+}
+
+}
+
+int main(const int argc, char** argv) {
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {return 2;}
+
+    BenchRunner runner(options);
+    std::printf("%-44s %12s %12s %12s  %s\n", "benchmark", "median_ns", "best_ns", "ops/run", "params");
+    for (const int tradesPerBar : options.tradesPerBar) {
+        BenchFixture fixture(options, tradesPerBar);
+        benchCleanTicks(runner, fixture);
+        benchVapStore(runner, fixture);
+        benchBarExtrema(runner, fixture);
+        benchMacdKernel(runner, fixture);
+        benchSignalBus(runner, fixture);
+        benchColoring(runner, fixture);
+        benchTradeWrapper(runner, fixture);
+        benchBracketSimulator(runner, fixture);
+    }
+    if (!options.jsonPath.empty()) {
+        writeJson(options, runner.getResults());
+    }
+    return 0;
+}
@@ -0,0 +1,322 @@
+#include "ReplayChart.h"
+
+#include <cstdio>
+#include <utility>
+
+
+ReplayChart::ReplayChart(const float tickSize, std::string symbol)
+    : tickSize(tickSize),
+      symbol(std::move(symbol)),
+      orders(tickSize) {}
+
+ReplayStudy& ReplayChart::addStudy(const int id, const std::string& name, const StudyFunction function) {
+    auto study = std::make_unique<ReplayStudy>();
+    study->id = id;
+    study->name = name;
+    study->function = function;
+    study->sc = std::make_unique<s_sc>();
+    studies.push_back(std::move(study));
+    return *studies.back();
+}
+
+ReplayStudy& ReplayChart::addNativeStudy(const int id, const std::string& name, NativeStudyFunction native) {
+    auto study = std::make_unique<ReplayStudy>();
+    study->id = id;
+    study->name = name;
+    study->native = std::move(native);
+    study->sc = std::make_unique<s_sc>();
+    studies.push_back(std::move(study));
+    return *studies.back();
+}
+
+void ReplayChart::setDefaults() {
+    for (const auto& study : studies) {
+        s_sc& sc = *study->sc;
+        sc.Services = this;
+        sc.StudyGraphInstanceID = study->id;
+        sc.Symbol = symbol.c_str();
+        sc.TickSize = tickSize;
+        sc.VolumeAtPriceForBars = &vap;
+        sc.VolumeAtPriceForStudy = &vap;
+        bindChartArrays(sc);
+        sc.SetDefaults = 1;
+        if (study->function != nullptr) {
+            study->function(sc);
+        } else {
+            study->native(*this, sc, 0);
+        }
+        sc.SetDefaults = 0;
+    }
+}
+
+void ReplayChart::bindChartArrays(s_sc& sc) {
+    const int size = getArraySize();
+    sc.ArraySize = size;
+    sc.Open.Bind(open.data(), size);
+    sc.High.Bind(high.data(), size);
+    sc.Low.Bind(low.data(), size);
+    sc.Close.Bind(close.data(), size);
+    sc.Volume.Bind(volume.data(), size);
+    sc.NumberOfTrades.Bind(numTrades.data(), size);
+    sc.BidVolume.Bind(bidVolume.data(), size);
+    sc.AskVolume.Bind(askVolume.data(), size);
+    sc.AskNT.Bind(askTrades.data(), size);
+    sc.BidNT.Bind(bidTrades.data(), size);
+    sc.UpTickVolume.Bind(upTickVolume.data(), size);
+    sc.DownTickVolume.Bind(downTickVolume.data(), size);
+    sc.BaseDateTimeIn.Bind(dateTimes.data(), size);
+    for (auto& subgraph : sc.Subgraph) {
+        subgraph.Resize(size);
+    }
+    if (size > 0) {
+        sc.LastTradePrice = close[size - 1];
+        sc.CurrentSystemDateTime = dateTimes[size - 1];
+    }
+}
+
+void ReplayChart::appendBar(const ReplayBar& bar) {
+    bars.push_back(bar);
+    open.push_back(bar.open);
+    high.push_back(bar.high);
+    low.push_back(bar.low);
+    close.push_back(bar.close);
+    volume.push_back(bar.volume);
+    numTrades.push_back(bar.numTrades);
+    bidVolume.push_back(bar.bidVolume);
+    askVolume.push_back(bar.askVolume);
+    askTrades.push_back(bar.askTrades);
+    bidTrades.push_back(bar.bidTrades);
+    upTickVolume.push_back(bar.upTickVolume);
+    downTickVolume.push_back(bar.downTickVolume);
+    dateTimes.push_back(bar.dateTime);
+    vap.SetNumberOfBars(static_cast<unsigned int>(bars.size()));
+    if (!tradeDriven) {
+        orders.bar(orders.toTicks(bar.open), orders.toTicks(bar.high), orders.toTicks(bar.low), orders.toTicks(bar.close),
+                   bar.dateTime);
+    }
+}
+
+void ReplayChart::replaceLastBar(const ReplayBar& bar) {
+    if (bars.empty()) {
+        appendBar(bar);
+        return;
+    }
+    const size_t last = bars.size() - 1;
+    if (!tradeDriven) {
+        // Only what the update added is new: the extremes it pushed out, then its close
+        if (bar.high > bars[last].high) {orders.sweep(orders.toTicks(bar.high), bar.dateTime);}
+        if (bar.low < bars[last].low) {orders.sweep(orders.toTicks(bar.low), bar.dateTime);}
+        orders.sweep(orders.toTicks(bar.close), bar.dateTime);
+    }
+    bars[last] = bar;
+    open[last] = bar.open;
+    high[last] = bar.high;
+    low[last] = bar.low;
+    close[last] = bar.close;
+    volume[last] = bar.volume;
+    numTrades[last] = bar.numTrades;
+    bidVolume[last] = bar.bidVolume;
+    askVolume[last] = bar.askVolume;
+    askTrades[last] = bar.askTrades;
+    bidTrades[last] = bar.bidTrades;
+    upTickVolume[last] = bar.upTickVolume;
+    downTickVolume[last] = bar.downTickVolume;
+    dateTimes[last] = bar.dateTime;
+    vap.ClearBar(static_cast<unsigned int>(last));
+}
+
+void ReplayChart::addVolumeAtPrice(const int barIndex, const float price, const unsigned int bidVolume,
+                                   const unsigned int askVolume, const unsigned int trades) {
+    const int priceInTicks = static_cast<int>(std::lround(static_cast<double>(price) / tickSize));
+    vap.AddVolumeAtPrice(barIndex, priceInTicks, bidVolume, askVolume, trades);
+}
+
+void ReplayChart::trade(const float price, const SCDateTime dateTime) {
+    tradeDriven = true;
+    orders.trade(orders.toTicks(price), dateTime);
+}
+
+void ReplayChart::tradeRange(const float open, const float high, const float low, const float close,
+                             const SCDateTime dateTime) {
+    tradeDriven = true;
+    orders.bar(orders.toTicks(open), orders.toTicks(high), orders.toTicks(low), orders.toTicks(close), dateTime);
+}
+
+void ReplayChart::callStudy(ReplayStudy& study, const int updateStartIndex, const bool fullRecalculation) {
+    s_sc& sc = *study.sc;
+    bindChartArrays(sc);
+    sc.UpdateStartIndex = updateStartIndex;
+    sc.IsFullRecalculation = fullRecalculation ? 1 : 0;
+
+    const auto timed = [&](auto&& call) {
+        const auto start = std::chrono::steady_clock::now();
+        call();
+        const auto stop = std::chrono::steady_clock::now();
+        study.callLatenciesNs.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+    };
+
+    if (study.native) {
+        for (int i = updateStartIndex; i < sc.ArraySize; ++i) {
+            sc.Index = i;
+            study.native(*this, sc, i);
+        }
+        return;
+    }
+    if (sc.AutoLoop == 0) {
+        sc.Index = sc.ArraySize - 1;
+        timed([&] {study.function(sc);});
+    } else {
+        for (int i = updateStartIndex; i < sc.ArraySize; ++i) {
+            sc.Index = i;
+            timed([&] {study.function(sc);});
+        }
+    }
+}
+
+void ReplayChart::fullRecalculation() {
+    for (const auto& study : studies) {
+        callStudy(*study, 0, true);
+    }
+    recalculateIfFlagged();
+}
+
+void ReplayChart::updateFrom(const int updateStartIndex) {
+    for (const auto& study : studies) {
+        callStudy(*study, updateStartIndex, false);
+    }
+    recalculateIfFlagged();
+}
+
+void ReplayChart::recalculateIfFlagged() {
+    // As Sierra does, a study setting sc.FlagFullRecalculate has the whole chart recalculated after the update
+    bool flagged = false;
+    for (const auto& study : studies) {
+        flagged |= study->sc->FlagFullRecalculate != 0;
+        study->sc->FlagFullRecalculate = 0;
+    }
+    if (flagged) {
+        fullRecalculation();
+    }
+}
+
+void ReplayChart::lastCall() {
+    for (const auto& study : studies) {
+        if (study->function == nullptr) {continue;}
+        s_sc& sc = *study->sc;
+        bindChartArrays(sc);
+        sc.LastCallToFunction = 1;
+        study->function(sc);
+        sc.LastCallToFunction = 0;
+    }
+}
+
+int ReplayChart::getArraySize() const {return static_cast<int>(bars.size());}
+
+const ReplayBar& ReplayChart::getBar(const int index) const {return bars[index];}
+
+float ReplayChart::getTickSize() const {return tickSize;}
+
+size_t ReplayChart::getMessageCount() const {return messageCount;}
+
+void ReplayChart::setVerbose(const bool verbose) {this->verbose = verbose;}
+
+void ReplayChart::setDataFilesFolder(std::string folder) {dataFilesFolder = std::move(folder);}
+
+int ReplayChart::getFilledOrderCount() const {return static_cast<int>(orders.getFills().size());}
+
+const std::vector<std::unique_ptr<ReplayStudy>>& ReplayChart::getStudies() const {return studies;}
+
+std::vector<ReplayLatencySummary> ReplayChart::getLatencySummaries() const {
+    std::vector<ReplayLatencySummary> summaries;
+    for (const auto& study : studies) {
+        if (study->callLatenciesNs.empty()) {continue;}
+        std::vector<int64_t> sorted = study->callLatenciesNs;
+        std::sort(sorted.begin(), sorted.end());
+        const auto percentile = [&sorted](const double p) {
+            const auto rank = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1));
+            return static_cast<double>(sorted[rank]);
+        };
+        double total = 0;
+        for (const int64_t ns : sorted) {total += static_cast<double>(ns);}
+
+        ReplayLatencySummary summary;
+        summary.name = study->name;
+        summary.calls = sorted.size();
+        summary.meanNs = total / static_cast<double>(sorted.size());
+        summary.p50Ns = percentile(0.50);
+        summary.p99Ns = percentile(0.99);
+        summary.maxNs = static_cast<double>(sorted.back());
+        summaries.push_back(summary);
+    }
+    return summaries;
+}
+
+// Services
+
+int ReplayChart::GetStudyArrayUsingID(const int studyId, const int subgraphIndex, SCFloatArrayRef out) {
+    if (subgraphIndex < 0 || subgraphIndex >= SC_SUBGRAPHS_AVAILABLE) {return 0;}
+    for (const auto& study : studies) {
+        if (study->id == studyId) {
+            out = study->sc->Subgraph[subgraphIndex].Data;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int ReplayChart::GetStudyPeakValleyLine(int, int, float&, int&, int&, int&, int, int) {
+    return 0;  // No volume by price profiles on the replay chart
+}
+
+void ReplayChart::AddMessageToLog(const char* message, int) {
+    ++messageCount;
+    if (verbose) {
+        std::fprintf(stderr, "[log] %s\n", message);
+    }
+}
+
+SCString ReplayChart::DataFilesFolder() {return {dataFilesFolder};}
+
+SCDateTime ReplayChart::orderTime() const {
+    return bars.empty() ? SCDateTime() : bars.back().dateTime;
+}
+
+double ReplayChart::SubmitOrder(const BuySellEnum side, s_SCNewOrder& order) {
+    if (bars.empty()) {return SCTRADING_ORDER_ERROR;}
+    return orders.submit(side, order, orderTime());
+}
+
+int ReplayChart::ModifyOrder(s_SCNewOrder& order) {
+    return orders.modify(order, orderTime());
+}
+
+int ReplayChart::CancelOrder(const int64_t internalOrderId) {
+    return orders.cancel(internalOrderId, orderTime());
+}
+
+int ReplayChart::FlattenAndCancelAllOrders() {
+    orders.flattenAndCancelAll(orderTime());
+    return 1;
+}
+
+int ReplayChart::GetOrderByOrderID(const int64_t internalOrderId, s_SCTradeOrder& order) {
+    return orders.getOrder(internalOrderId, order) ? 1 : SCTRADING_ORDER_ERROR;
+}
+
+int ReplayChart::GetTradePosition(s_SCPositionData& position) {
+    position = orders.getPosition();
+    if (position.PositionQuantity != 0) {
+        const double ticks = orders.getLastPrice() - position.AveragePrice / tickSize;
+        position.OpenProfitLoss = ticks * position.PositionQuantity * studies.front()->sc->CurrencyValuePerTick;
+    }
+    return 1;
+}
+
+int ReplayChart::GetOrderFillArraySize() {return static_cast<int>(orders.getFills().size());}
+
+int ReplayChart::GetOrderFillEntry(const int fillIndex, s_SCOrderFillData& fill) {
+    const std::vector<s_SCOrderFillData>& fills = orders.getFills();
+    if (fillIndex < 0 || fillIndex >= static_cast<int>(fills.size())) {return 0;}
+    fill = fills[fillIndex];
+    return 1;
+}
@@ -0,0 +1,126 @@
+#ifndef REPLAYCHART_H
+#define REPLAYCHART_H
+
+/*
+ * Headless chart used by the Linux replay host.
+ * It owns the bar arrays and the VAP container, hosts the studies (ours through their exported scsf_ function, the
+ * Sierra native ones they depend on as small native stand-ins) and answers the order APIs through a BracketSimulator.
+ * Studies are called exactly like Sierra does: once with SetDefaults, then per bar in AutoLoop order (or once per
+ * update when AutoLoop is 0), and a last time with LastCallToFunction.
+ * Orders fill against each appended or updated bar's price path, unless trades are fed: from the first trade() on,
+ * the trades alone move the orders and bars are only data.
+ */
+
+#include "BracketSimulator.h"
+#include "sierrachart.h"
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+using StudyFunction = void (*)(SCStudyInterfaceRef);
+
+struct ReplayBar {
+    SCDateTime dateTime;
+    float open = 0, high = 0, low = 0, close = 0;
+    float volume = 0, numTrades = 0, bidVolume = 0, askVolume = 0;
+    float askTrades = 0, bidTrades = 0, upTickVolume = 0, downTickVolume = 0;
+    float maxDelta = 0, minDelta = 0;  // Intrabar extremes of AskV - BidV
+};
+
+class ReplayChart;
+
+// Sierra built-in studies our studies read through GetStudyArrayUsingID
+using NativeStudyFunction = std::function<void(const ReplayChart&, s_sc&, int)>;
+
+struct ReplayStudy {
+    int id = 0;
+    std::string name;
+    StudyFunction function = nullptr;
+    NativeStudyFunction native;
+    std::unique_ptr<s_sc> sc;
+    std::vector<int64_t> callLatenciesNs;
+};
+
+struct ReplayLatencySummary {
+    std::string name;
+    size_t calls = 0;
+    double meanNs = 0, p50Ns = 0, p99Ns = 0, maxNs = 0;
+};
+
+class ReplayChart final : public c_ReplayServices {
+
+public:
+    explicit ReplayChart(float tickSize, std::string symbol = "REPLAY");
+
+    // Setup
+    ReplayStudy& addStudy(int id, const std::string& name, StudyFunction function);
+    ReplayStudy& addNativeStudy(int id, const std::string& name, NativeStudyFunction native);
+    void setDefaults();
+
+    // Data
+    void appendBar(const ReplayBar& bar);
+    void replaceLastBar(const ReplayBar& bar);  // Intrabar update of the bar in progress, its ladder is cleared
+    void addVolumeAtPrice(int barIndex, float price, unsigned int bidVolume, unsigned int askVolume, unsigned int trades);
+    // One print, or the range of a print aggregated over several (open, high, low, close)
+    void trade(float price, SCDateTime dateTime);
+    void tradeRange(float open, float high, float low, float close, SCDateTime dateTime);
+
+    // Calls
+    void fullRecalculation();
+    void updateFrom(int updateStartIndex);
+    void lastCall();
+
+    // Getters
+    [[nodiscard]] int getArraySize() const;
+    [[nodiscard]] const ReplayBar& getBar(int index) const;
+    [[nodiscard]] float getTickSize() const;
+    [[nodiscard]] std::vector<ReplayLatencySummary> getLatencySummaries() const;
+    [[nodiscard]] size_t getMessageCount() const;
+    [[nodiscard]] int getFilledOrderCount() const;
+    [[nodiscard]] const std::vector<std::unique_ptr<ReplayStudy>>& getStudies() const;
+
+    void setVerbose(bool verbose);
+    void setDataFilesFolder(std::string folder);
+
+    // Services
+    int GetStudyArrayUsingID(int studyId, int subgraphIndex, SCFloatArrayRef out) override;
+    int GetStudyPeakValleyLine(int chartNumber, int studyId, float& price, int& type, int& startIndex,
+                               int& extensionEndIndex, int profileIndex, int peakValleyIndex) override;
+    double SubmitOrder(BuySellEnum side, s_SCNewOrder& order) override;
+    int ModifyOrder(s_SCNewOrder& order) override;
+    int CancelOrder(int64_t internalOrderId) override;
+    int FlattenAndCancelAllOrders() override;
+    int GetOrderByOrderID(int64_t internalOrderId, s_SCTradeOrder& order) override;
+    int GetTradePosition(s_SCPositionData& position) override;
+    int GetOrderFillArraySize() override;
+    int GetOrderFillEntry(int fillIndex, s_SCOrderFillData& fill) override;
+    void AddMessageToLog(const char* message, int showLog) override;
+    SCString DataFilesFolder() override;
+
+private:
+    void bindChartArrays(s_sc& sc);
+    void callStudy(ReplayStudy& study, int updateStartIndex, bool fullRecalculation);
+    void recalculateIfFlagged();
+    [[nodiscard]] SCDateTime orderTime() const;
+
+    float tickSize;
+    std::string symbol;
+    bool verbose = false;
+    std::string dataFilesFolder = ".";
+    size_t messageCount = 0;
+
+    std::vector<ReplayBar> bars;
+    std::vector<float> open, high, low, close, volume, numTrades, bidVolume, askVolume;
+    std::vector<float> askTrades, bidTrades, upTickVolume, downTickVolume;
+    std::vector<SCDateTime> dateTimes;
+    c_VAPContainer vap;
+
+    std::vector<std::unique_ptr<ReplayStudy>> studies;
+
+    BracketSimulator orders;
+    bool tradeDriven = false;
+};
+
+#endif //REPLAYCHART_H
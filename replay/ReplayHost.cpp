@@ -0,0 +1,293 @@
+/*
+ * Linux replay host: drives the exported scsf_ studies over recorded (or synthetic) bars without Sierra Chart and
+ * reports bar throughput and per-call latency.
+ *
+ * Chart layout, study IDs as the studies' inputs expect them:
+ *   1 Numbers Bars stand-in        -> read by StrategyBasicFlag
+ *   2 ATR stand-in                 -> read by the MACD executor
+ *   3 Range bar predictor stand-in -> read by the PeakTypeVolume executor
+ *   4 scsf_StrategyBasicFlag
+ *   5 scsf_StrategyBasicPeakTypeVolumeExec
+ *   6 Price EMA stand-in           -> read by the MACD executor
+ *   7 MACD stand-in                -> read by the MACD executor
+ *   8 scsf_StrategyMACDShortFromManager
+ *
+ * Usage: divergence_replay [--bars file.csv | --scid file.scid | --synthetic N] [--mode stream|full]
+ *                          [--tick-size 0.25] [--bar-seconds 60] [--intrabar N] [--scan-only] [--verbose]
+ *                          [--data-folder dir] [--publish-channel name] [--signal-channel name]
+ *                          [--snapshots] [--checksums] [--built-in-indicators]
+ *
+ * With --scid the ticks are aggregated on the fly and every record moves the orders in file order; --intrabar N
+ * additionally updates the bar in progress every N records like live ticks would, and --scan-only just measures the
+ * aggregation rate. Bar files and synthetic bars fill orders along each bar's open, high/low, close path. The studies'
+ * own files (trade event logs, signal bus channels) go to --data-folder, the system temporary directory by default.
+ * --publish-channel makes StrategyBasicFlag publish its signal on that bus channel, --signal-channel makes the
+ * PeakTypeVolume executor read its signal from one instead of study 4 (divergence_bus_probe reads or feeds them from
+ * another process).
+ * --snapshots turns on the studies' state snapshots: the chart closing at the end of the run saves them to
+ * --data-folder, and the next run over the same leading bars only computes the bars past them. --checksums prints a
+ * hash of every study output, e.g. to check a resumed run against one computed from scratch.
+ * --built-in-indicators makes the MACD executor compute its EMWA/MACD/ATR itself instead of reading studies 2, 6 and 7.
+ */
+
+#include "ReplayBars.h"
+#include "ReplayChart.h"
+#include "ReplayNativeStudies.h"
+#include "ScidReader.h"
+
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+SCSFExport scsf_StrategyBasicFlag(SCStudyInterfaceRef sc);
+SCSFExport scsf_StrategyBasicPeakTypeVolumeExec(SCStudyInterfaceRef sc);
+SCSFExport scsf_StrategyMACDShortFromManager(SCStudyInterfaceRef sc);
+
+namespace {
+
+struct HostOptions {
+    std::string barsPath;
+    std::string scidPath;
+    int syntheticBars = 100000;
+    int barSeconds = 60;
+    int intrabarRecords = 0;
+    bool scanOnly = false;
+    bool fullRecalculation = false;
+    float tickSize = 0.25f;
+    bool verbose = false;
+    std::string dataFolder = std::filesystem::temp_directory_path().string();
+    std::string publishChannel;
+    std::string signalChannel;
+    bool snapshots = false;
+    bool checksums = false;
+    bool builtInIndicators = false;
+};
+
+bool parseOptions(const int argc, char** argv, HostOptions& options) {
+    for (int a = 1; a < argc; ++a) {
+        const auto next = [&]() -> const char* {return a + 1 < argc ? argv[++a] : "";};
+        if (std::strcmp(argv[a], "--bars") == 0) {
+            options.barsPath = next();
+        } else if (std::strcmp(argv[a], "--scid") == 0) {
+            options.scidPath = next();
+        } else if (std::strcmp(argv[a], "--bar-seconds") == 0) {
+            options.barSeconds = std::max(1, std::atoi(next()));
+        } else if (std::strcmp(argv[a], "--intrabar") == 0) {
+            options.intrabarRecords = std::max(0, std::atoi(next()));
+        } else if (std::strcmp(argv[a], "--scan-only") == 0) {
+            options.scanOnly = true;
+        } else if (std::strcmp(argv[a], "--synthetic") == 0) {
+            options.syntheticBars = std::atoi(next());
+        } else if (std::strcmp(argv[a], "--mode") == 0) {
+            options.fullRecalculation = std::strcmp(next(), "full") == 0;
+        } else if (std::strcmp(argv[a], "--tick-size") == 0) {
+            options.tickSize = static_cast<float>(std::atof(next()));
+        } else if (std::strcmp(argv[a], "--verbose") == 0) {
+            options.verbose = true;
+        } else if (std::strcmp(argv[a], "--data-folder") == 0) {
+            options.dataFolder = next();
+        } else if (std::strcmp(argv[a], "--publish-channel") == 0) {
+            options.publishChannel = next();
+        } else if (std::strcmp(argv[a], "--signal-channel") == 0) {
+            options.signalChannel = next();
+        } else if (std::strcmp(argv[a], "--snapshots") == 0) {
+            options.snapshots = true;
+        } else if (std::strcmp(argv[a], "--checksums") == 0) {
+            options.checksums = true;
+        } else if (std::strcmp(argv[a], "--built-in-indicators") == 0) {
+            options.builtInIndicators = true;
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[a]);
+            return false;
+        }
+    }
+    return true;
+}
+
+void printReport(const char* mode, const size_t bars, const double seconds, const ReplayChart& chart) {
+    std::printf("mode=%s bars=%zu seconds=%.3f bars_per_second=%.0f fills=%d log_messages=%zu\n", mode, bars, seconds,
+                static_cast<double>(bars) / seconds, chart.getFilledOrderCount(), chart.getMessageCount());
+    std::printf("%-40s %10s %10s %10s %10s %10s\n", "study", "calls", "mean_ns", "p50_ns", "p99_ns", "max_ns");
+    for (const ReplayLatencySummary& s : chart.getLatencySummaries()) {
+        std::printf("%-40s %10zu %10.0f %10.0f %10.0f %10.0f\n", s.name.c_str(), s.calls, s.meanNs, s.p50Ns, s.p99Ns, s.maxNs);
+    }
+}
+
+// FNV-1a of each named subgraph's values and first extra array, to compare two runs bar for bar
+void printChecksums(const ReplayChart& chart) {
+    const auto hashOf = [&](const SCFloatArray& values) {
+        uint64_t hash = 14695981039346656037ull;
+        for (int i = 0; i < values.GetArraySize(); ++i) {
+            uint32_t bits;
+            std::memcpy(&bits, &values[i], sizeof(bits));
+            hash = (hash ^ bits) * 1099511628211ull;
+        }
+        return hash;
+    };
+    for (const auto& study : chart.getStudies()) {
+        if (study->function == nullptr) {continue;}
+        for (int k = 0; k < SC_SUBGRAPHS_AVAILABLE; ++k) {
+            s_SCSubgraph& subgraph = study->sc->Subgraph[k];
+            if (subgraph.Name.GetLength() == 0) {continue;}
+            std::printf("checksum study=%s subgraph=%d values=%016" PRIx64 " array0=%016" PRIx64 "\n",
+                        study->name.c_str(), k, hashOf(subgraph.Data), hashOf(subgraph.Arrays[0]));
+        }
+    }
+}
+
+void buildChart(ReplayChart& chart, const HostOptions& options) {
+    chart.addNativeStudy(1, "Numbers Bars (stand-in)", numbersBarsStandIn());
+    chart.addNativeStudy(2, "ATR (stand-in)", atrStandIn(14));
+    chart.addNativeStudy(3, "Range bar predictor (stand-in)", rangeBarPredictorStandIn());
+    ReplayStudy& flag = chart.addStudy(4, "scsf_StrategyBasicFlag", scsf_StrategyBasicFlag);
+    ReplayStudy& peakExec = chart.addStudy(5, "scsf_StrategyBasicPeakTypeVolumeExec", scsf_StrategyBasicPeakTypeVolumeExec);
+    chart.addNativeStudy(6, "Price EMA (stand-in)", priceEmaStandIn(20));
+    chart.addNativeStudy(7, "MACD (stand-in)", macdStandIn(12, 26, 9));
+    ReplayStudy& macdExec = chart.addStudy(8, "scsf_StrategyMACDShortFromManager", scsf_StrategyMACDShortFromManager);
+
+    chart.setDefaults();
+
+    flag.sc->Input[0].SetStudyID(1);
+    flag.sc->Input[9].SetString(options.publishChannel.c_str());
+    peakExec.sc->Input[0].SetStudyID(4);
+    peakExec.sc->Input[1].SetStudyID(3);
+    peakExec.sc->Input[3].SetYesNo(1);
+    peakExec.sc->Input[6].SetString(options.signalChannel.c_str());
+    macdExec.sc->Input[0].SetStudyID(6);
+    macdExec.sc->Input[1].SetStudyID(7);
+    macdExec.sc->Input[2].SetStudyID(2);
+    macdExec.sc->Input[10].SetYesNo(1);
+    macdExec.sc->Input[15].SetYesNo(options.builtInIndicators ? 1 : 0);
+    if (options.snapshots) {
+        flag.sc->Input[10].SetYesNo(1);
+        peakExec.sc->Input[7].SetYesNo(1);
+        macdExec.sc->Input[21].SetYesNo(1);
+    }
+}
+
+// Streams the file through the aggregator in chunks, releasing the pages already consumed
+constexpr size_t SCID_CHUNK_RECORDS = 1 << 20;
+
+int scanScid(const HostOptions& options) {
+    ScidFile file;
+    if (!file.open(options.scidPath)) {
+        std::fprintf(stderr, "Cannot open %s as an intraday file\n", options.scidPath.c_str());
+        return 1;
+    }
+    ScidBarAggregator aggregator(options.tickSize, options.barSeconds);
+    size_t bars = 0;
+    double volume = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t first = 0; first < file.getRecordCount(); first += SCID_CHUNK_RECORDS) {
+        const size_t count = std::min(SCID_CHUNK_RECORDS, file.getRecordCount() - first);
+        aggregator.consume(file.getRecords() + first, count, [&](const RecordedBar& r) {
+            ++bars;
+            volume += r.bar.volume;
+        });
+        file.releaseBefore(first + count);
+    }
+    RecordedBar last;
+    if (aggregator.flush(last)) {++bars;}
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("records=%zu bars=%zu volume=%.0f seconds=%.3f records_per_second=%.0f\n", file.getRecordCount(), bars,
+                volume, seconds, static_cast<double>(file.getRecordCount()) / seconds);
+    return 0;
+}
+
+void replayScid(const HostOptions& options, ReplayChart& chart, size_t& barCount) {
+    ScidFile file;
+    if (!file.open(options.scidPath)) {return;}
+    ScidBarAggregator aggregator(options.tickSize, options.barSeconds);
+
+    // The bar in progress is on the chart once an intrabar update has pushed it there
+    bool partialOnChart = false;
+    const auto closeBar = [&](const RecordedBar& r) {
+        partialOnChart ? updateRecordedBar(chart, r) : feedRecordedBar(chart, r);
+        partialOnChart = false;
+        ++barCount;
+        chart.getArraySize() == 1 ? chart.fullRecalculation() : chart.updateFrom(chart.getArraySize() - 1);
+    };
+
+    // Orders fill print by print, in file order
+    const auto trade = [&](const s_IntradayRecord& record) {
+        const SCDateTime dateTime(static_cast<double>(record.DateTime) / static_cast<double>(SCID_MICROSECONDS_PER_DAY));
+        if (record.Open <= 0.0f) {
+            chart.trade(record.Close, dateTime);
+        } else {
+            chart.tradeRange(record.Open, record.High, record.Low, record.Close, dateTime);
+        }
+    };
+
+    const size_t step = options.intrabarRecords > 0 ? static_cast<size_t>(options.intrabarRecords) : SCID_CHUNK_RECORDS;
+    RecordedBar partial;
+    for (size_t first = 0; first < file.getRecordCount(); first += step) {
+        const size_t count = std::min(step, file.getRecordCount() - first);
+        aggregator.consume(file.getRecords() + first, count, closeBar, trade);
+        if (options.intrabarRecords > 0 && aggregator.snapshotPartial(partial)) {
+            partialOnChart ? updateRecordedBar(chart, partial) : feedRecordedBar(chart, partial);
+            partialOnChart = true;
+            chart.getArraySize() == 1 ? chart.fullRecalculation() : chart.updateFrom(chart.getArraySize() - 1);
+        }
+        if (first % SCID_CHUNK_RECORDS + count >= SCID_CHUNK_RECORDS) {
+            file.releaseBefore(first + count);
+        }
+    }
+    if (aggregator.flush(partial)) {
+        closeBar(partial);
+    }
+}
+
+}
+
+int main(const int argc, char** argv) {
+    HostOptions options;
+    if (!parseOptions(argc, argv, options)) {return 2;}
+
+    if (!options.scidPath.empty()) {
+        if (options.scanOnly) {return scanScid(options);}
+        ReplayChart chart(options.tickSize);
+        chart.setVerbose(options.verbose);
+        chart.setDataFilesFolder(options.dataFolder);
+        buildChart(chart, options);
+        size_t barCount = 0;
+        const auto start = std::chrono::steady_clock::now();
+        replayScid(options, chart, barCount);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        chart.lastCall();
+        printReport("scid", barCount, seconds, chart);
+        if (options.checksums) {printChecksums(chart);}
+        return barCount > 0 ? 0 : 1;
+    }
+
+    const std::vector<RecordedBar> recorded = options.barsPath.empty()
+        ? generateSyntheticBars(options.syntheticBars, options.tickSize, 42)
+        : loadSierraBarCsv(options.barsPath, options.tickSize);
+    if (recorded.empty()) {
+        std::fprintf(stderr, "No bars to replay\n");
+        return 1;
+    }
+
+    ReplayChart chart(options.tickSize);
+    chart.setVerbose(options.verbose);
+    chart.setDataFilesFolder(options.dataFolder);
+    buildChart(chart, options);
+
+    const auto start = std::chrono::steady_clock::now();
+    if (options.fullRecalculation) {
+        for (const RecordedBar& r : recorded) {feedRecordedBar(chart, r);}
+        chart.fullRecalculation();
+    } else {
+        feedRecordedBar(chart, recorded.front());
+        chart.fullRecalculation();
+        for (size_t b = 1; b < recorded.size(); ++b) {
+            feedRecordedBar(chart, recorded[b]);
+            chart.updateFrom(chart.getArraySize() - 1);
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    chart.lastCall();
+    printReport(options.fullRecalculation ? "full" : "stream", recorded.size(), seconds, chart);
+    if (options.checksums) {printChecksums(chart);}
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include "ReplayNativeStudies.h"
+
+
+NativeStudyFunction numbersBarsStandIn() {
+    return [](const ReplayChart& chart, s_sc& sc, const int i) {
+        if (sc.SetDefaults) {
+            sc.GraphName = "Numbers Bars Calculated Values";
+            for (const int subgraph : {0, 7, 8, 12, 23, 49}) {sc.Subgraph[subgraph].Name = "Value";}
+            return;
+        }
+        const ReplayBar& bar = chart.getBar(i);
+        sc.Subgraph[0][i] = bar.askVolume - bar.bidVolume;
+        sc.Subgraph[7][i] = bar.maxDelta;
+        sc.Subgraph[8][i] = bar.minDelta;
+        sc.Subgraph[12][i] = bar.volume;
+        sc.Subgraph[23][i] = bar.askTrades - bar.bidTrades;
+        sc.Subgraph[49][i] = bar.upTickVolume - bar.downTickVolume;
+    };
+}
+
+NativeStudyFunction priceEmaStandIn(const int length) {
+    return [length](const ReplayChart&, s_sc& sc, const int i) {
+        if (sc.SetDefaults) {
+            sc.GraphName = "Moving Average - Exponential";
+            sc.Subgraph[0].Name = "MA";
+            return;
+        }
+        sc.ExponentialMovAvg(sc.Close, sc.Subgraph[0].Data, i, length);
+    };
+}
+
+NativeStudyFunction macdStandIn(const int fastLength, const int slowLength, const int signalLength) {
+    return [=](const ReplayChart&, s_sc& sc, const int i) {
+        if (sc.SetDefaults) {
+            sc.GraphName = "MACD";
+            sc.Subgraph[0].Name = "MACD";
+            sc.Subgraph[1].Name = "MA of MACD";
+            sc.Subgraph[2].Name = "MACD Diff";
+            return;
+        }
+        SCFloatArray& fast = sc.Subgraph[0].Arrays[0];
+        SCFloatArray& slow = sc.Subgraph[0].Arrays[1];
+        sc.ExponentialMovAvg(sc.Close, fast, i, fastLength);
+        sc.ExponentialMovAvg(sc.Close, slow, i, slowLength);
+        sc.Subgraph[0][i] = fast[i] - slow[i];
+        sc.ExponentialMovAvg(sc.Subgraph[0].Data, sc.Subgraph[1].Data, i, signalLength);
+        sc.Subgraph[2][i] = sc.Subgraph[0][i] - sc.Subgraph[1][i];
+    };
+}
+
+NativeStudyFunction atrStandIn(const int length) {
+    return [length](const ReplayChart&, s_sc& sc, const int i) {
+        if (sc.SetDefaults) {
+            sc.GraphName = "Average True Range";
+            sc.Subgraph[0].Name = "ATR";
+            return;
+        }
+        const float trueRange = i == 0
+            ? sc.High[i] - sc.Low[i]
+            : std::max({sc.High[i] - sc.Low[i], std::abs(sc.High[i] - sc.Close[i - 1]), std::abs(sc.Low[i] - sc.Close[i - 1])});
+        sc.Subgraph[0][i] = i == 0
+            ? trueRange
+            : sc.Subgraph[0][i - 1] + (trueRange - sc.Subgraph[0][i - 1]) / static_cast<float>(length);
+    };
+}
+
+NativeStudyFunction rangeBarPredictorStandIn() {
+    return [](const ReplayChart&, s_sc& sc, const int i) {
+        if (sc.SetDefaults) {
+            sc.GraphName = "Range Bar Predictor";
+            sc.Subgraph[0].Name = "Top";
+            sc.Subgraph[1].Name = "Bottom";
+            return;
+        }
+        const float previousRange = i == 0 ? 0.0f : sc.High[i - 1] - sc.Low[i - 1];
+        sc.Subgraph[0][i] = sc.Open[i] + previousRange;
+        sc.Subgraph[1][i] = sc.Open[i] - previousRange;
+    };
+}
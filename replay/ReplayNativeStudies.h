@@ -0,0 +1,27 @@
+#ifndef REPLAYNATIVESTUDIES_H
+#define REPLAYNATIVESTUDIES_H
+
+/*
+ * Stand-ins for the Sierra built-in studies our studies read through GetStudyArrayUsingID.
+ * Only the subgraphs actually consumed are produced, at the same subgraph indexes as the Sierra originals.
+ */
+
+#include "ReplayChart.h"
+
+// Numbers Bars Calculated Values: 0 AskV - BidV, 7/8 intrabar max/min of AskV - BidV, 12 total V, 23 AskT - BidT,
+// 49 up tick minus down tick volume
+NativeStudyFunction numbersBarsStandIn();
+
+// Exponential moving average of the close on subgraph 0
+NativeStudyFunction priceEmaStandIn(int length);
+
+// MACD: 0 MACD, 1 MACD moving average, 2 MACD difference
+NativeStudyFunction macdStandIn(int fastLength, int slowLength, int signalLength);
+
+// Average true range with Wilder smoothing on subgraph 0
+NativeStudyFunction atrStandIn(int length);
+
+// Range bar predictor: 0 projected top, 1 projected bottom of the current bar
+NativeStudyFunction rangeBarPredictorStandIn();
+
+#endif //REPLAYNATIVESTUDIES_H
@@ -0,0 +1,153 @@
+#include "ScidReader.h"
+
+#include <cstring>
+
+
+bool ScidFile::open(const std::string& path) {
+    if (!file.open(path, MapMode::ReadOnly)) {return false;}
+    if (file.getSize() < sizeof(s_IntradayFileHeader)) {return false;}
+
+    const auto* header = reinterpret_cast<const s_IntradayFileHeader*>(file.getData());
+    if (std::memcmp(header->FileTypeUniqueHeaderID, "SCID", 4) != 0
+        || header->RecordSize != sizeof(s_IntradayRecord)
+        || header->HeaderSize < sizeof(s_IntradayFileHeader)
+        || header->HeaderSize > file.getSize()) {
+        file.close();
+        return false;
+    }
+    headerSize = header->HeaderSize;
+    records = reinterpret_cast<const s_IntradayRecord*>(file.getData() + headerSize);
+    recordCount = (file.getSize() - headerSize) / sizeof(s_IntradayRecord);
+    file.adviseSequential();
+    return true;
+}
+
+void ScidFile::releaseBefore(const size_t recordIndex) const {
+    file.release(0, headerSize + recordIndex * sizeof(s_IntradayRecord));
+}
+
+const s_IntradayRecord* ScidFile::getRecords() const {return records;}
+
+size_t ScidFile::getRecordCount() const {return recordCount;}
+
+
+ScidBarAggregator::ScidBarAggregator(const float tickSize, const int barSeconds)
+    : tickSize(tickSize),
+      inverseTickSize(1.0f / tickSize),
+      barMicroseconds(static_cast<int64_t>(barSeconds) * 1000000LL) {}
+
+void ScidBarAggregator::startBar(const int64_t dateTime) {
+    // Clear only the part of the ladder the previous bar used
+    if (lowTicks <= highTicks) {
+        const int from = lowTicks - ladderBase;
+        const int count = highTicks - lowTicks + 1;
+        std::fill_n(bidColumn.begin() + from, count, 0u);
+        std::fill_n(askColumn.begin() + from, count, 0u);
+        std::fill_n(tradeColumn.begin() + from, count, 0u);
+    }
+    barStart = dateTime - dateTime % barMicroseconds;
+    barEnd = barStart + barMicroseconds;
+    bar = ReplayBar();
+    bar.dateTime = SCDateTime(static_cast<double>(barStart) / static_cast<double>(SCID_MICROSECONDS_PER_DAY));
+    delta = 0;
+    hasBar = true;
+    lowTicks = INT32_MAX;
+    highTicks = INT32_MIN;
+}
+
+void ScidBarAggregator::growLadder(const int priceInTicks) {
+    // Recentre on the new price with room on both sides, keeps the columns small and contiguous
+    const int usedLow = lowTicks <= highTicks ? std::min(lowTicks, priceInTicks) : priceInTicks;
+    const int usedHigh = lowTicks <= highTicks ? std::max(highTicks, priceInTicks) : priceInTicks;
+    const int width = std::max<int>(static_cast<int>(bidColumn.size()), 2 * (usedHigh - usedLow + 1) + 256);
+    const int newBase = usedLow - (width - (usedHigh - usedLow + 1)) / 2;
+
+    std::vector<uint32_t> bid(width, 0u), ask(width, 0u), trades(width, 0u);
+    if (lowTicks <= highTicks) {
+        for (int t = lowTicks; t <= highTicks; ++t) {
+            bid[t - newBase] = bidColumn[t - ladderBase];
+            ask[t - newBase] = askColumn[t - ladderBase];
+            trades[t - newBase] = tradeColumn[t - ladderBase];
+        }
+    }
+    bidColumn.swap(bid);
+    askColumn.swap(ask);
+    tradeColumn.swap(trades);
+    ladderBase = newBase;
+}
+
+void ScidBarAggregator::addRecord(const s_IntradayRecord& record) {
+    const float price = record.Close;
+    const int priceInTicks = static_cast<int>(price * inverseTickSize + 0.5f);
+    if (previousTradeTicks == 0) {previousTradeTicks = priceInTicks;}
+    const int offset = priceInTicks - ladderBase;
+    if (offset < 0 || offset >= static_cast<int>(bidColumn.size())) {
+        growLadder(priceInTicks);
+    }
+    const int slot = priceInTicks - ladderBase;
+    bidColumn[slot] += record.BidVolume;
+    askColumn[slot] += record.AskVolume;
+    tradeColumn[slot] += record.NumTrades;
+
+    // Tick records (Open == 0 or a sub-trade marker) only carry a trade price, bar records their own range
+    const bool isTick = record.Open <= 0.0f;
+    const bool firstRecord = lowTicks > highTicks;
+    const float recordHigh = isTick ? price : record.High;
+    const float recordLow = isTick ? price : record.Low;
+    if (firstRecord) {
+        bar.open = isTick ? price : record.Open;
+        bar.high = recordHigh;
+        bar.low = recordLow;
+    } else {
+        bar.high = std::max(bar.high, recordHigh);
+        bar.low = std::min(bar.low, recordLow);
+    }
+    bar.close = price;
+    lowTicks = std::min(lowTicks, priceInTicks);
+    highTicks = std::max(highTicks, priceInTicks);
+
+    const auto volume = static_cast<float>(record.TotalVolume);
+    const auto bidVolume = static_cast<float>(record.BidVolume);
+    const auto askVolume = static_cast<float>(record.AskVolume);
+    bar.volume += volume;
+    bar.numTrades += static_cast<float>(record.NumTrades);
+    bar.bidVolume += bidVolume;
+    bar.askVolume += askVolume;
+    bar.askTrades += askVolume > 0 ? static_cast<float>(record.NumTrades) : 0.0f;
+    bar.bidTrades += bidVolume > 0 ? static_cast<float>(record.NumTrades) : 0.0f;
+    bar.upTickVolume += priceInTicks > previousTradeTicks ? volume : 0.0f;
+    bar.downTickVolume += priceInTicks < previousTradeTicks ? volume : 0.0f;
+    previousTradeTicks = priceInTicks;
+
+    delta += askVolume - bidVolume;
+    bar.maxDelta = std::max(bar.maxDelta, delta);
+    bar.minDelta = std::min(bar.minDelta, delta);
+}
+
+void ScidBarAggregator::fillRecordedBar(RecordedBar& out) const {
+    out.bar = bar;
+    out.ladder.clear();
+    for (int t = lowTicks; t <= highTicks; ++t) {
+        const int slot = t - ladderBase;
+        if (bidColumn[slot] == 0 && askColumn[slot] == 0 && tradeColumn[slot] == 0) {continue;}
+        out.ladder.push_back({static_cast<float>(t * static_cast<double>(tickSize)), bidColumn[slot], askColumn[slot], tradeColumn[slot]});
+    }
+}
+
+const RecordedBar& ScidBarAggregator::closeBar() {
+    fillRecordedBar(closed);
+    return closed;
+}
+
+bool ScidBarAggregator::snapshotPartial(RecordedBar& out) const {
+    if (!hasBar || lowTicks > highTicks) {return false;}
+    fillRecordedBar(out);
+    return true;
+}
+
+bool ScidBarAggregator::flush(RecordedBar& out) {
+    if (!snapshotPartial(out)) {return false;}
+    hasBar = false;
+    barEnd = INT64_MIN;
+    return true;
+}
@@ -0,0 +1,129 @@
+#ifndef SCIDREADER_H
+#define SCIDREADER_H
+
+/*
+ * Zero-copy reader for Sierra Chart intraday (.scid) files and a streaming aggregator turning the tick records into
+ * OHLCV bars, bid/ask volume and per bar volume at price ladders.
+ * The file is memory mapped and walked front to back; pages behind the cursor can be released so a year of ticks is
+ * never fully resident.
+ */
+
+#include "MappedFile.h"
+#include "ReplayBars.h"
+
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#pragma pack(push, 1)
+struct s_IntradayFileHeader {
+    char FileTypeUniqueHeaderID[4];  // "SCID"
+    uint32_t HeaderSize;
+    uint32_t RecordSize;
+    uint16_t Version;
+    uint16_t Unused1;
+    uint32_t UTCStartIndex;
+    char Reserve[36];
+};
+
+struct s_IntradayRecord {
+    int64_t DateTime;  // Microseconds since 1899-12-30
+    float Open;        // 0 or a sub-trade marker for tick records
+    float High;        // Ask for tick records
+    float Low;         // Bid for tick records
+    float Close;       // Trade price
+    uint32_t NumTrades;
+    uint32_t TotalVolume;
+    uint32_t BidVolume;
+    uint32_t AskVolume;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(s_IntradayFileHeader) == 56, "scid header is 56 bytes");
+static_assert(sizeof(s_IntradayRecord) == 40, "scid record is 40 bytes");
+
+constexpr int64_t SCID_MICROSECONDS_PER_DAY = 86400LL * 1000000LL;
+
+class ScidFile {
+
+public:
+    bool open(const std::string& path);
+
+    // Drops the pages holding records [0, recordIndex) from memory
+    void releaseBefore(size_t recordIndex) const;
+
+    // Getters
+    [[nodiscard]] const s_IntradayRecord* getRecords() const;
+    [[nodiscard]] size_t getRecordCount() const;
+
+private:
+    MappedFile file;
+    const s_IntradayRecord* records = nullptr;
+    size_t recordCount = 0;
+    size_t headerSize = 0;
+};
+
+class ScidBarAggregator {
+
+public:
+    ScidBarAggregator(float tickSize, int barSeconds);
+
+    // Folds records into the current bar, calls onBarClosed(const RecordedBar&) for every bar completed on the way
+    // and onRecord(const s_IntradayRecord&) after each record is in
+    template <typename OnBarClosed, typename OnRecord>
+    void consume(const s_IntradayRecord* records, size_t count, OnBarClosed&& onBarClosed, OnRecord&& onRecord) {
+        for (size_t r = 0; r < count; ++r) {
+            const s_IntradayRecord& record = records[r];
+            if (record.DateTime >= barEnd) {
+                if (hasBar) {
+                    onBarClosed(closeBar());
+                }
+                startBar(record.DateTime);
+            }
+            addRecord(record);
+            onRecord(record);
+        }
+    }
+
+    template <typename OnBarClosed>
+    void consume(const s_IntradayRecord* records, const size_t count, OnBarClosed&& onBarClosed) {
+        consume(records, count, onBarClosed, [](const s_IntradayRecord&) {});
+    }
+
+    // Materialises the bar in progress, returns false when no record has been seen since the last close
+    bool snapshotPartial(RecordedBar& out) const;
+
+    // Closes the bar in progress, if any
+    bool flush(RecordedBar& out);
+
+private:
+    void startBar(int64_t dateTime);
+    void addRecord(const s_IntradayRecord& record);
+    const RecordedBar& closeBar();
+    void fillRecordedBar(RecordedBar& out) const;
+    void growLadder(int priceInTicks);
+
+    const float tickSize;
+    const float inverseTickSize;
+    const int64_t barMicroseconds;
+
+    bool hasBar = false;
+    int64_t barStart = 0;
+    int64_t barEnd = INT64_MIN;
+    ReplayBar bar;
+    float delta = 0;
+    int previousTradeTicks = 0;
+
+    // Dense ladder indexed by tick offset from ladderBase, only [lowTicks, highTicks] is in use
+    int ladderBase = 0;
+    int lowTicks = INT32_MAX;
+    int highTicks = INT32_MIN;
+    std::vector<uint32_t> bidColumn;
+    std::vector<uint32_t> askColumn;
+    std::vector<uint32_t> tradeColumn;
+
+    RecordedBar closed;
+};
+
+#endif //SCIDREADER_H
@@ -0,0 +1,506 @@
+#ifndef REPLAY_SIERRACHART_H
+#define REPLAY_SIERRACHART_H
+
+/*
+ * Local stand-in for the subset of the Sierra Chart ACSIL interface used by the studies in this repository.
+ * It is ONLY put on the include path of the Linux replay host (see ReplayChart.h), the Windows DLL keeps building
+ * against the real ACS_Source/sierrachart.h.
+ * Names, signatures and return conventions follow ACSIL so that Studies.cpp, MACDTradingStudies.cpp, helpers.cpp
+ * and TradeWrapper.cpp compile unchanged. Anything the studies do not touch is deliberately left out.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define SCSFExport extern "C" void
+#define SCDLLName(Name) extern "C" const char* scdll_DLLName() { return Name; }
+
+#define HMS_TIME(h, m, s) ((h) * 3600 + (m) * 60 + (s))
+
+constexpr int SC_SUBGRAPHS_AVAILABLE = 60;
+constexpr int SC_SUBGRAPH_EXTRA_ARRAYS = 12;
+constexpr int SC_INPUTS_AVAILABLE = 128;
+constexpr int NUMERIC_INFORMATION_GRAPH_DRAW_TYPE_VALUE_FORMATS = SC_SUBGRAPHS_AVAILABLE;
+
+// Colors
+using COLORREF = uint32_t;
+#define RGB(r, g, b) (static_cast<COLORREF>((r) | ((g) << 8) | ((b) << 16)))
+constexpr COLORREF COLOR_BLACK = RGB(0, 0, 0);
+constexpr COLORREF COLOR_WHITE = RGB(255, 255, 255);
+constexpr COLORREF COLOR_RED = RGB(255, 0, 0);
+constexpr COLORREF COLOR_GREEN = RGB(0, 255, 0);
+constexpr COLORREF COLOR_LIGHTGREEN = RGB(128, 255, 128);
+
+enum SubgraphDrawStyles { DRAWSTYLE_IGNORE = 0, DRAWSTYLE_LINE = 1, DRAWSTYLE_BAR = 2, DRAWSTYLE_HIDDEN = 3 };
+
+enum GraphDrawTypeEnum { GDT_CUSTOM = 0, GDT_OHLCBAR = 1, GDT_NUMERIC_INFORMATION = 2 };
+
+enum CrossOverEnum { NO_CROSS = 0, CROSS_FROM_TOP = 1, CROSS_FROM_BOTTOM = 2 };
+
+// Trading
+enum BuySellEnum { BSE_UNDEFINED = 0, BSE_BUY = 1, BSE_SELL = 2 };
+
+enum SCOrderTypeEnum {
+    SCT_ORDERTYPE_MARKET = 0,
+    SCT_ORDERTYPE_LIMIT = 1,
+    SCT_ORDERTYPE_STOP = 2,
+    SCT_ORDERTYPE_STOP_LIMIT = 3
+};
+
+enum SCTimeInForceEnum { SCT_TIF_DAY = 0, SCT_TIF_GOOD_TILL_CANCELED = 1, SCT_TIF_IMMEDIATE_OR_CANCEL = 3 };
+
+enum SCOrderStatusCodeEnum {
+    SCT_OSC_UNSPECIFIED = 0,
+    SCT_OSC_ORDERSENT = 1,
+    SCT_OSC_PENDINGOPEN = 2,
+    SCT_OSC_PENDINGCHILD = 3,
+    SCT_OSC_OPEN = 4,
+    SCT_OSC_PENDINGMODIFY = 5,
+    SCT_OSC_PENDINGCANCEL = 6,
+    SCT_OSC_FILLED = 7,
+    SCT_OSC_CANCELED = 8,
+    SCT_OSC_ERROR = 9,
+    SCT_OSC_PENDING_CANCEL_FOR_REPLACE = 10
+};
+
+constexpr int SCTRADING_ORDER_ERROR = -1;
+
+enum PeakValleyTypeEnum { PEAKVALLEYTYPE_NONE = 0, PEAKVALLEYTYPE_PEAK = 1, PEAKVALLEYTYPE_VALLEY = 2 };
+
+// Strings
+class SCString {
+public:
+    SCString() = default;
+    SCString(const char* s) : m_Value(s ? s : "") {}
+    SCString(std::string s) : m_Value(std::move(s)) {}
+
+    SCString& Format(const char* format, ...) {
+        va_list args;
+        va_start(args, format);
+        char buffer[1024];
+        std::vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+        m_Value = buffer;
+        return *this;
+    }
+
+    [[nodiscard]] const char* GetChars() const {return m_Value.c_str();}
+    [[nodiscard]] int GetLength() const {return static_cast<int>(m_Value.size());}
+    operator const char*() const {return m_Value.c_str();}
+
+private:
+    std::string m_Value;
+};
+
+// Date and time, days since 1899-12-30 as in SCDateTime
+constexpr int SECONDS_PER_DAY = 86400;
+
+class SCDateTime {
+public:
+    SCDateTime() = default;
+    SCDateTime(const double days) : m_Days(days) {}
+
+    [[nodiscard]] int GetDate() const {return static_cast<int>(std::floor(m_Days + 0.5 / SECONDS_PER_DAY));}
+    [[nodiscard]] int GetTime() const {
+        const double secs = (m_Days - std::floor(m_Days)) * SECONDS_PER_DAY;
+        return static_cast<int>(secs + 0.5) % SECONDS_PER_DAY;
+    }
+    [[nodiscard]] double GetAsDouble() const {return m_Days;}
+    operator double() const {return m_Days;}
+
+    static SCDateTime FromDateTime(const int date, const int timeInSeconds) {
+        return {date + static_cast<double>(timeInSeconds) / SECONDS_PER_DAY};
+    }
+
+private:
+    double m_Days = 0.0;
+};
+
+// Arrays. Like ACSIL, an out of range index never faults: it hands out a scratch element.
+template <typename T>
+class c_ArrayWrapper {
+public:
+    c_ArrayWrapper() = default;
+    c_ArrayWrapper(T* data, const int size) : m_Data(data), m_Size(size) {}
+
+    T& operator[](const int index) {
+        if (index < 0 || index >= m_Size) {
+            static thread_local T scratch{};
+            scratch = T{};
+            return scratch;
+        }
+        return m_Data[index];
+    }
+    const T& operator[](const int index) const {return const_cast<c_ArrayWrapper&>(*this)[index];}
+
+    [[nodiscard]] int GetArraySize() const {return m_Size;}
+    [[nodiscard]] T* GetPointer() const {return m_Data;}
+    void Bind(T* data, const int size) {m_Data = data; m_Size = size;}
+
+private:
+    T* m_Data = nullptr;
+    int m_Size = 0;
+};
+
+using SCFloatArray = c_ArrayWrapper<float>;
+using SCFloatArrayRef = SCFloatArray&;
+using SCColorArray = c_ArrayWrapper<COLORREF>;
+using SCDateTimeArray = c_ArrayWrapper<SCDateTime>;
+
+// Extra subgraph arrays are allocated on first use, most studies never touch them
+class s_SubgraphExtraArrays {
+public:
+    SCFloatArray& operator[](const int k) {
+        if (k < 0 || k >= SC_SUBGRAPH_EXTRA_ARRAYS) {
+            static thread_local SCFloatArray empty;
+            return empty;
+        }
+        if (m_Storage[k].empty() && m_Size > 0) {
+            m_Storage[k].resize(m_Size, 0.0f);
+            m_Views[k].Bind(m_Storage[k].data(), m_Size);
+        }
+        return m_Views[k];
+    }
+
+    // Also restores views a study re-pointed with GetStudyArrayUsingID during its previous call
+    void Resize(const int size) {
+        m_Size = size;
+        for (int k = 0; k < SC_SUBGRAPH_EXTRA_ARRAYS; ++k) {
+            if (!m_Storage[k].empty()) {
+                m_Storage[k].resize(size, 0.0f);
+                m_Views[k].Bind(m_Storage[k].data(), size);
+            }
+        }
+    }
+
+private:
+    int m_Size = 0;
+    std::vector<float> m_Storage[SC_SUBGRAPH_EXTRA_ARRAYS];
+    SCFloatArray m_Views[SC_SUBGRAPH_EXTRA_ARRAYS];
+};
+
+struct s_SCSubgraph {
+    SCString Name;
+    int DrawStyle = DRAWSTYLE_LINE;
+    COLORREF PrimaryColor = COLOR_WHITE;
+    SCFloatArray Data;
+    SCColorArray DataColor;
+    s_SubgraphExtraArrays Arrays;
+
+    float& operator[](const int index) {return Data[index];}
+    operator SCFloatArrayRef() {return Data;}
+
+    // Only subgraphs a study named in SetDefaults get storage, like unused subgraphs in Sierra cost nothing
+    void Resize(const int size) {
+        if (Name.GetLength() == 0) {return;}
+        m_Values.resize(size, 0.0f);
+        m_Colors.resize(size, COLOR_WHITE);
+        Data.Bind(m_Values.data(), size);
+        DataColor.Bind(m_Colors.data(), size);
+        Arrays.Resize(size);
+    }
+
+private:
+    std::vector<float> m_Values;
+    std::vector<COLORREF> m_Colors;
+};
+using SCSubgraphRef = s_SCSubgraph&;
+
+struct s_SCInput {
+    SCString Name;
+
+    void SetStudyID(const int id) {m_Int = id;}
+    [[nodiscard]] int GetStudyID() const {return m_Int;}
+
+    void SetInt(const int value) {m_Int = value; m_Float = static_cast<float>(value);}
+    [[nodiscard]] int GetInt() const {return m_Int;}
+    void SetIntLimits(const int min, const int max) {m_Min = min; m_Max = max;}
+
+    void SetFloat(const float value) {m_Float = value; m_Int = static_cast<int>(value);}
+    [[nodiscard]] float GetFloat() const {return m_Float;}
+    void SetFloatLimits(const float min, const float max) {m_Min = min; m_Max = max;}
+
+    void SetYesNo(const int value) {SetInt(value != 0 ? 1 : 0);}
+    [[nodiscard]] int GetYesNo() const {return m_Int != 0 ? 1 : 0;}
+
+    void SetString(const char* value) {m_String = value;}
+    [[nodiscard]] const char* GetString() const {return m_String.GetChars();}
+
+private:
+    int m_Int = 0;
+    float m_Float = 0.0f;
+    double m_Min = 0.0;
+    double m_Max = 0.0;
+    SCString m_String;
+};
+using SCInputRef = s_SCInput&;
+
+struct s_NumericInformationGraphDrawTypeConfig {
+    bool TransparentTextBackground = true;
+    bool ShowPullback = false;
+    int GridlineStyleSubgraphIndex = -1;
+    int ValueFormat[NUMERIC_INFORMATION_GRAPH_DRAW_TYPE_VALUE_FORMATS] = {};
+};
+
+// Volume at price
+struct s_VolumeAtPriceV2 {
+    int PriceInTicks = 0;
+    unsigned int Volume = 0;
+    unsigned int BidVolume = 0;
+    unsigned int AskVolume = 0;
+    unsigned int NumberOfTrades = 0;
+};
+
+class c_VAPContainer {
+public:
+    [[nodiscard]] unsigned int GetNumberOfBars() const {return static_cast<unsigned int>(m_Bars.size());}
+
+    [[nodiscard]] unsigned int GetSizeAtBarIndex(const unsigned int barIndex) const {
+        return barIndex < m_Bars.size() ? static_cast<unsigned int>(m_Bars[barIndex].size()) : 0;
+    }
+
+    bool GetVAPElementAtIndex(const unsigned int barIndex, const int elementIndex, const s_VolumeAtPriceV2** p_VAP) const {
+        if (barIndex >= m_Bars.size() || elementIndex < 0 || elementIndex >= static_cast<int>(m_Bars[barIndex].size())) {
+            return false;
+        }
+        *p_VAP = &m_Bars[barIndex][elementIndex];
+        return true;
+    }
+
+    [[nodiscard]] const s_VolumeAtPriceV2& GetVAPElementAtPrice(const unsigned int barIndex, const int priceInTicks) const {
+        static const s_VolumeAtPriceV2 empty{};
+        if (barIndex >= m_Bars.size()) {return empty;}
+        const auto& ladder = m_Bars[barIndex];
+        const auto it = std::lower_bound(ladder.begin(), ladder.end(), priceInTicks,
+            [](const s_VolumeAtPriceV2& e, const int p) {return e.PriceInTicks < p;});
+        return it != ladder.end() && it->PriceInTicks == priceInTicks ? *it : empty;
+    }
+
+    bool GetHighAndLowPriceTicksForBarIndex(const unsigned int barIndex, int& highTicks, int& lowTicks) const {
+        if (barIndex >= m_Bars.size() || m_Bars[barIndex].empty()) {return false;}
+        lowTicks = m_Bars[barIndex].front().PriceInTicks;
+        highTicks = m_Bars[barIndex].back().PriceInTicks;
+        return true;
+    }
+
+    // Host side, not part of ACSIL
+    void SetNumberOfBars(const unsigned int numberOfBars) {m_Bars.resize(numberOfBars);}
+
+    void AddVolumeAtPrice(const unsigned int barIndex, const int priceInTicks, const unsigned int bidVolume,
+                          const unsigned int askVolume, const unsigned int numberOfTrades) {
+        if (barIndex >= m_Bars.size()) {m_Bars.resize(barIndex + 1);}
+        auto& ladder = m_Bars[barIndex];
+        auto it = std::lower_bound(ladder.begin(), ladder.end(), priceInTicks,
+            [](const s_VolumeAtPriceV2& e, const int p) {return e.PriceInTicks < p;});
+        if (it == ladder.end() || it->PriceInTicks != priceInTicks) {
+            s_VolumeAtPriceV2 elem;
+            elem.PriceInTicks = priceInTicks;
+            it = ladder.insert(it, elem);
+        }
+        it->BidVolume += bidVolume;
+        it->AskVolume += askVolume;
+        it->Volume += bidVolume + askVolume;
+        it->NumberOfTrades += numberOfTrades;
+    }
+
+    void ClearBar(const unsigned int barIndex) {if (barIndex < m_Bars.size()) {m_Bars[barIndex].clear();}}
+
+private:
+    std::vector<std::vector<s_VolumeAtPriceV2>> m_Bars;
+};
+
+// Orders and positions
+struct s_SCNewOrder {
+    int64_t InternalOrderID = 0;
+    int64_t InternalOrderID2 = 0;
+    int64_t InternalOrderID3 = 0;
+    double OrderQuantity = 0;
+    int OrderType = SCT_ORDERTYPE_MARKET;
+    int TimeInForce = SCT_TIF_DAY;
+    double Price1 = 0.0;
+    double Price2 = 0.0;
+    double Target1Price = 0.0;
+    double Target1Offset = 0.0;
+    double Stop1Price = 0.0;
+    double Stop1Offset = 0.0;
+    SCString TextTag;
+};
+
+struct s_SCTradeOrder {
+    int64_t InternalOrderID = 0;
+    int64_t ParentInternalOrderID = 0;
+    int64_t TargetChildInternalOrderID = 0;
+    int64_t StopChildInternalOrderID = 0;
+    int OrderType = SCT_ORDERTYPE_MARKET;
+    BuySellEnum BuySell = BSE_UNDEFINED;
+    double Price1 = 0.0;
+    double Price2 = 0.0;
+    double OrderQuantity = 0;
+    double FilledQuantity = 0;
+    double AvgFillPrice = 0.0;
+    SCOrderStatusCodeEnum OrderStatusCode = SCT_OSC_UNSPECIFIED;
+    SCDateTime LastActivityTime;
+};
+
+struct s_SCPositionData {
+    double PositionQuantity = 0;
+    double AveragePrice = 0.0;
+    double OpenProfitLoss = 0.0;
+    double PriceHighDuringPosition = 0.0;
+    double PriceLowDuringPosition = 0.0;
+};
+
+struct s_SCOrderFillData {
+    int64_t InternalOrderID = 0;
+    BuySellEnum BuySell = BSE_UNDEFINED;
+    double FillPrice = 0.0;
+    double Quantity = 0;
+    SCDateTime FillDateTime;
+};
+
+/*
+ * Everything the host owns behind the study interface: charts, other studies, orders, the message log.
+ * Implemented by ReplayChart on the host side.
+ */
+class c_ReplayServices {
+public:
+    virtual ~c_ReplayServices() = default;
+    virtual int GetStudyArrayUsingID(int studyId, int subgraphIndex, SCFloatArrayRef out) = 0;
+    virtual int GetStudyPeakValleyLine(int chartNumber, int studyId, float& price, int& type, int& startIndex,
+                                       int& extensionEndIndex, int profileIndex, int peakValleyIndex) = 0;
+    virtual double SubmitOrder(BuySellEnum side, s_SCNewOrder& order) = 0;
+    virtual int ModifyOrder(s_SCNewOrder& order) = 0;
+    virtual int CancelOrder(int64_t internalOrderId) = 0;
+    virtual int FlattenAndCancelAllOrders() = 0;
+    virtual int GetOrderByOrderID(int64_t internalOrderId, s_SCTradeOrder& order) = 0;
+    virtual int GetTradePosition(s_SCPositionData& position) = 0;
+    virtual int GetOrderFillArraySize() = 0;
+    virtual int GetOrderFillEntry(int fillIndex, s_SCOrderFillData& fill) = 0;
+    virtual void AddMessageToLog(const char* message, int showLog) = 0;
+    virtual SCString DataFilesFolder() = 0;
+};
+
+struct s_sc {
+    // Call state
+    int SetDefaults = 0;
+    int AutoLoop = 0;
+    int Index = 0;
+    int ArraySize = 0;
+    int UpdateStartIndex = 0;
+    int IsFullRecalculation = 0;
+    int FlagFullRecalculate = 0;  // Set by a study to have the chart recalculated after this update
+    int LastCallToFunction = 0;
+
+    // Study description
+    SCString GraphName;
+    int GraphDrawType = GDT_CUSTOM;
+    int StudyGraphInstanceID = 0;
+    s_SCInput Input[SC_INPUTS_AVAILABLE];
+    s_SCSubgraph Subgraph[SC_SUBGRAPHS_AVAILABLE];
+
+    // Chart
+    int ChartNumber = 1;
+    SCString Symbol;
+    int SecondsPerBar = 60;
+    float TickSize = 0.25f;
+    float CurrencyValuePerTick = 12.5f;
+    float LastTradePrice = 0.0f;
+    SCDateTime CurrentSystemDateTime;
+    SCFloatArray Open, High, Low, Close, Volume, NumberOfTrades, BidVolume, AskVolume;
+    SCFloatArray AskNT, BidNT, UpTickVolume, DownTickVolume;
+    SCDateTimeArray BaseDateTimeIn;
+    c_VAPContainer* VolumeAtPriceForBars = nullptr;
+    c_VAPContainer* VolumeAtPriceForStudy = nullptr;
+
+    c_ReplayServices* Services = nullptr;
+
+    // Prices
+    [[nodiscard]] int PriceValueToTicks(const float price) const {
+        return static_cast<int>(std::lround(static_cast<double>(price) / TickSize));
+    }
+    [[nodiscard]] float TicksToPriceValue(const int ticks) const {return static_cast<float>(ticks * static_cast<double>(TickSize));}
+
+    // Persistent storage, references stay valid for the lifetime of the study
+    int& GetPersistentInt(const int key) {return m_PersistentInts[key];}
+    int64_t& GetPersistentInt64(const int key) {return m_PersistentInt64s[key];}
+    float& GetPersistentFloat(const int key) {return m_PersistentFloats[key];}
+    double& GetPersistentDouble(const int key) {return m_PersistentDoubles[key];}
+    void* GetPersistentPointer(const int key) {
+        const auto it = m_PersistentPointers.find(key);
+        return it == m_PersistentPointers.end() ? nullptr : it->second;
+    }
+    void SetPersistentPointer(const int key, void* pointer) {m_PersistentPointers[key] = pointer;}
+
+    // Studies
+    int GetStudyArrayUsingID(const int studyId, const int subgraphIndex, SCFloatArrayRef out) const {
+        return Services->GetStudyArrayUsingID(studyId, subgraphIndex, out);
+    }
+    int GetStudyPeakValleyLine(const int chartNumber, const int studyId, float& price, int& type, int& startIndex,
+                               int& extensionEndIndex, const int profileIndex, const int peakValleyIndex) const {
+        return Services->GetStudyPeakValleyLine(chartNumber, studyId, price, type, startIndex, extensionEndIndex,
+                                                profileIndex, peakValleyIndex);
+    }
+
+    void ExponentialMovAvg(SCFloatArrayRef in, SCFloatArrayRef out, const int index, const int length) const {
+        if (index <= 0) {
+            out[0] = in[0];
+            return;
+        }
+        const float alpha = 2.0f / (static_cast<float>(length) + 1.0f);
+        out[index] = out[index - 1] + alpha * (in[index] - out[index - 1]);
+    }
+    void ExponentialMovAvg(SCFloatArrayRef in, SCFloatArrayRef out, const int length) const {
+        ExponentialMovAvg(in, out, Index, length);
+    }
+
+    [[nodiscard]] int CrossOver(SCFloatArrayRef first, SCFloatArrayRef second, const int index) const {
+        const float current = first[index] - second[index];
+        int j = index - 1;
+        while (j >= 0 && first[j] == second[j]) {--j;}
+        if (j < 0) {return NO_CROSS;}
+        const float previous = first[j] - second[j];
+        if (current < 0 && previous > 0) {return CROSS_FROM_TOP;}
+        if (current > 0 && previous < 0) {return CROSS_FROM_BOTTOM;}
+        return NO_CROSS;
+    }
+    [[nodiscard]] int CrossOver(SCFloatArrayRef first, SCFloatArrayRef second) const {return CrossOver(first, second, Index);}
+
+    // Display
+    [[nodiscard]] static COLORREF CombinedForegroundBackgroundColorRef(const COLORREF foreground, const COLORREF) {return foreground;}
+    void SetNumericInformationGraphDrawTypeConfig(const s_NumericInformationGraphDrawTypeConfig& config) {m_NumericConfig = config;}
+    void AddMessageToLog(const char* message, const int showLog) const {Services->AddMessageToLog(message, showLog);}
+    [[nodiscard]] SCString DataFilesFolder() const {return Services->DataFilesFolder();}
+
+    // Trading
+    double BuyOrder(s_SCNewOrder& order) const {return Services->SubmitOrder(BSE_BUY, order);}
+    double SellOrder(s_SCNewOrder& order) const {return Services->SubmitOrder(BSE_SELL, order);}
+    int ModifyOrder(s_SCNewOrder& order) const {return Services->ModifyOrder(order);}
+    int CancelOrder(const int64_t internalOrderId) const {return Services->CancelOrder(internalOrderId);}
+    int FlattenAndCancelAllOrders() const {return Services->FlattenAndCancelAllOrders();}
+    int GetOrderByOrderID(const int64_t internalOrderId, s_SCTradeOrder& order) const {
+        return Services->GetOrderByOrderID(internalOrderId, order);
+    }
+    int GetTradePosition(s_SCPositionData& position) const {return Services->GetTradePosition(position);}
+    [[nodiscard]] int GetOrderFillArraySize() const {return Services->GetOrderFillArraySize();}
+    int GetOrderFillEntry(const int fillIndex, s_SCOrderFillData& fill) const {return Services->GetOrderFillEntry(fillIndex, fill);}
+
+private:
+    std::unordered_map<int, int> m_PersistentInts;
+    std::unordered_map<int, int64_t> m_PersistentInt64s;
+    std::unordered_map<int, float> m_PersistentFloats;
+    std::unordered_map<int, double> m_PersistentDoubles;
+    std::unordered_map<int, void*> m_PersistentPointers;
+    s_NumericInformationGraphDrawTypeConfig m_NumericConfig;
+};
+using SCStudyInterfaceRef = s_sc&;
+
+#endif //REPLAY_SIERRACHART_H